@@ -0,0 +1,59 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 10:12:36
+ * @last_edit_time: 2026-10-19 15:02:40
+ * @file_path: /Thread-Pool/include/Affinity.h
+ * @description: CPU 亲和性与 NUMA 拓扑头文件
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/**
+ * @description: 工作线程绑定 CPU 的方式
+ * @description: NONE 表示不绑定，由操作系统调度
+ * @description: COMPACT 表示按节点依次填满，线程尽量集中在同一个 NUMA 节点，共享缓存
+ * @description: SCATTER 表示在各节点之间轮流分配，线程均匀分布，充分利用每个节点的内存带宽
+ * @description: LIST 表示按 cpu_list 中给出的 CPU 依次绑定
+ */
+enum class AffinityPolicy : char {
+	NONE,
+	COMPACT,
+	SCATTER,
+	LIST
+};
+
+
+/**
+ * @description: NUMA 拓扑，从 /sys/devices/system/node 读取每个节点上的 CPU
+ * @description: 读取失败 (非 Linux 或没有 NUMA 信息) 时视为只有一个节点，包含所有可用的 CPU
+ */
+class CpuTopology {
+private:
+	std::vector<std::vector<int>> m_nodes;  // 每个节点上的 CPU，按编号升序
+	std::vector<int> m_cpu_nodes;  // CPU 编号到节点下标的映射，不存在的 CPU 为 -1
+
+	void restrict(const std::vector<int> &);  // 只保留给定的 CPU，去掉没有 CPU 的节点
+	void index();  // 重建 CPU 到节点的映射
+
+public:
+	explicit CpuTopology(const std::string &root = "/sys/devices/system/node");  // 读取 root 下的 node* 目录
+	static const CpuTopology &system();  // 本机拓扑，只包含当前进程允许使用的 CPU，第一次调用时读取
+
+	/* 成员函数 */
+	size_t nodes() const;  // 节点数量
+	const std::vector<int> &cpus(size_t) const;  // 节点上的 CPU
+	int nodeOf(int) const;  // CPU 所在节点，未知时返回 -1
+	std::vector<int> placement(AffinityPolicy, size_t, const std::vector<int> &) const;  // 计算每个槽位绑定的 CPU
+
+	/* 工具函数 */
+	static std::vector<int> parseCpuList(const std::string &);  // 解析 "0-3,8,10-11" 格式的 CPU 列表
+	static bool bindCurrentThread(const std::vector<int> &);  // 将当前线程绑定到给定的 CPU
+	static void setCurrentNode(int);  // 记录当前线程绑定的节点
+	static int currentNode();  // 当前线程所在节点
+};
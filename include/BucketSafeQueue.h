@@ -0,0 +1,78 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 17:32:08
+ * @last_edit_time: 2026-10-17 23:16:42
+ * @file_path: /Thread-Pool/include/BucketSafeQueue.h
+ * @description: 基于分桶与位图的优先级队列头文件
+ */
+
+#pragma once
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "TaskQueue.h"
+
+
+/**
+ * @description: 分桶优先级队列，适用于优先级范围有限的场景
+ * @description: 每个优先级对应一个先进先出的桶，位图记录非空的桶，出队时通过 ctz 找到优先级最高（数值最小）的非空桶
+ * @description: 入队、出队均为 O(1)，同一优先级内严格按提交顺序执行；超出范围的优先级归入最后一个桶
+ */
+class BucketSafeQueue : public TaskQueue {
+private:
+	/* 先进先出的桶，可扩容的环形数组，稳定运行后不再分配内存 */
+	struct Bucket {
+		std::vector<Task> m_tasks;  // 环形数组
+		size_t m_head = 0;  // 队首下标
+		size_t m_size = 0;  // 任务数量
+
+		void push(Task &);  // 队尾添加任务
+		void pop(Task &);  // 队首取出任务
+		void popBack(Task &);  // 队尾取出任务
+	};
+
+	std::vector<Bucket> m_buckets;  // 桶，下标即优先级
+	std::vector<uint64_t> m_bitmap;  // 非空桶位图
+	std::atomic<size_t> m_size;  // 任务总数
+	std::mutex m_mutex;  // 任务队列互斥锁
+
+	size_t bucketIndex(size_t);  // 优先级对应的桶下标
+	int firstNonEmpty();  // 优先级最高的非空桶，没有时返回 -1
+	int lastNonEmpty();  // 优先级最低的非空桶，没有时返回 -1
+
+public:
+	explicit BucketSafeQueue(size_t);
+	~BucketSafeQueue() = default;
+	BucketSafeQueue(const BucketSafeQueue &) = delete;
+	BucketSafeQueue &operator=(const BucketSafeQueue &) = delete;
+
+	/* 成员函数 */
+	inline bool empty() override;  // 队列是否为空
+	inline size_t size() override;  // 任务队列大小
+
+	bool taskEnqueue(Task &, size_t, size_t) override;  // 添加任务
+	bool taskDequeue(Task &) override;  // 取出任务
+	size_t taskEnqueueBatch(Task *, size_t, size_t, size_t) override;  // 批量添加任务
+	bool taskReplaceLowest(Task &, size_t, Task &) override;  // 用新任务替换优先级最低的任务
+};
+
+
+/**
+ * @description: 判断任务队列是否为空
+ * @return {bool} true/false
+ */
+bool BucketSafeQueue::empty() {
+	return m_size.load(std::memory_order_relaxed) == 0;
+}
+
+
+/**
+ * @description: 获取任务队列大小
+ * @return {size_t} m_size
+ */
+size_t BucketSafeQueue::size() {
+	return m_size.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,348 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 17:30:06
+ * @last_edit_time: 2026-10-18 17:30:06
+ * @file_path: /Thread-Pool/include/CoTask.h
+ * @description: C++20 协程支持头文件，只有包含本文件的代码需要以 C++20 编译，线程池本身仍为 C++11
+ */
+
+#pragma once
+#if !defined(__cpp_impl_coroutine)
+#error "CoTask.h requires C++20 coroutines (compile with -std=c++20)"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include "ThreadPool.h"
+
+
+/**
+ * @description: 协程帧从 TaskArena 分配，promise 类型继承它即可
+ */
+struct CoFrameAllocation {
+	static void* operator new(size_t size) { return TaskArena::allocate(size); }
+	static void operator delete(void* frame) noexcept { TaskArena::deallocate(frame); }
+};
+
+
+/**
+ * @description: co_await pool.schedule(priority) 的等待对象，挂起当前协程，把恢复操作作为任务提交到线程池，由工作线程继续执行
+ * @description: 在本线程池的工作线程中不等待任务队列空出位置，其他线程最多等待 timeout；仍未入队时在当前线程继续执行，与 CALLER_RUNS 相同，协程不会丢失
+ * @description: 线程池已关闭时在当前线程恢复并抛出 std::runtime_error
+ */
+class ScheduleAwaiter {
+private:
+	ThreadPool* m_pool;  // 恢复协程的线程池
+	size_t m_priority;  // 恢复任务的优先级
+	bool m_closed;  // 挂起时线程池已关闭
+
+public:
+	ScheduleAwaiter(ThreadPool* pool, size_t priority) noexcept : m_pool(pool), m_priority(priority), m_closed(false) { }
+
+	bool await_ready() const noexcept { return false; }
+	bool await_suspend(std::coroutine_handle<> handle);  // 返回 false 时在当前线程继续执行
+	void await_resume() const;
+};
+
+
+/**
+ * @description: 把恢复协程的任务提交到线程池
+ * @param {std::coroutine_handle<>} handle: 当前协程
+ * @return {bool} 已提交返回 true；线程池已关闭或任务队列已满时返回 false，协程在当前线程继续执行
+ */
+inline bool ScheduleAwaiter::await_suspend(std::coroutine_handle<> handle) {
+	if (!m_pool->m_start) {
+		m_closed = true;
+		return false;
+	}
+
+	Task task([handle]() { handle.resume(); });
+	std::chrono::steady_clock::time_point deadline = ThreadPool::m_local_pool == m_pool
+		? std::chrono::steady_clock::time_point::min()
+		: std::chrono::steady_clock::now() + m_pool->m_config->m_timeout;
+
+	try {
+		return m_pool->enqueueUntil(task, m_priority, deadline);
+	}
+	catch (const std::runtime_error &) {
+		// 线程池恰好关闭
+		m_closed = true;
+		return false;
+	}
+}
+
+
+/**
+ * @description: 恢复后检查挂起时线程池是否已关闭
+ */
+inline void ScheduleAwaiter::await_resume() const {
+	if (m_closed) {
+		throw std::runtime_error("ThreadPool is already colsed");
+	}
+}
+
+
+/**
+ * @description: 以默认优先级切换到线程池
+ * @return {ScheduleAwaiter} 等待对象
+ */
+inline ScheduleAwaiter ThreadPool::schedule() {
+	return ScheduleAwaiter(this, getTaskPriority());
+}
+
+
+/**
+ * @description: 切换到线程池，co_await 返回时当前协程运行在工作线程上 (任务队列已满时除外)
+ * @param {size_t} priority: 恢复任务的优先级
+ * @return {ScheduleAwaiter} 等待对象
+ */
+inline ScheduleAwaiter ThreadPool::schedule(size_t priority) {
+	return ScheduleAwaiter(this, priority);
+}
+
+
+template <typename T = void>
+class CoTask;
+
+
+/**
+ * @description: CoTask 的 promise 中与结果类型无关的部分：惰性启动，结束时通过对称转移恢复等待者，不占用额外的栈
+ */
+class CoPromiseBase : public CoFrameAllocation {
+private:
+	std::coroutine_handle<> m_continuation;  // co_await 本协程的协程
+	std::exception_ptr m_exception;  // 协程抛出的异常
+
+public:
+	/* 结束时转移到等待者，没有等待者时停在结束点，由 CoTask 销毁 */
+	struct FinalAwaiter {
+		bool await_ready() const noexcept { return false; }
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+			std::coroutine_handle<> continuation = handle.promise().m_continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+		void await_resume() const noexcept { }
+	};
+
+	std::suspend_always initial_suspend() const noexcept { return { }; }
+	FinalAwaiter final_suspend() const noexcept { return { }; }
+	void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+	void setContinuation(std::coroutine_handle<> continuation) noexcept { m_continuation = continuation; }
+	void rethrow() const {
+		if (m_exception) {
+			std::rethrow_exception(m_exception);
+		}
+	}
+};
+
+
+template <typename T>
+class CoPromise : public CoPromiseBase {
+private:
+	std::optional<T> m_value;  // co_return 的结果
+
+public:
+	CoTask<T> get_return_object() noexcept;
+	template <typename U>
+	void return_value(U &&value) { m_value.emplace(std::forward<U>(value)); }
+	T take() {
+		rethrow();
+		return std::move(*m_value);
+	}
+};
+
+
+template <>
+class CoPromise<void> : public CoPromiseBase {
+public:
+	CoTask<void> get_return_object() noexcept;
+	void return_void() const noexcept { }
+	void take() const { rethrow(); }
+};
+
+
+/**
+ * @description: 线程池的协程任务类型，协程帧从 TaskArena 分配
+ * @description: 惰性启动：co_await 时才开始执行，在等待者所在的线程上运行，直到其中 co_await pool.schedule() 等切换线程；结束时直接恢复等待者
+ * @description: 普通函数中通过 start() 启动并得到 TaskFuture，或通过 get() 等待结果；CoTask 只能被 co_await (或启动) 一次
+ */
+template <typename T>
+class CoTask {
+public:
+	using promise_type = CoPromise<T>;
+
+private:
+	std::coroutine_handle<promise_type> m_handle;  // 协程，由 CoTask 负责销毁
+
+public:
+	/* co_await 的等待对象：记录等待者后转移到本协程 */
+	class Awaiter {
+	private:
+		std::coroutine_handle<promise_type> m_handle;
+
+	public:
+		explicit Awaiter(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) { }
+
+		bool await_ready() const noexcept { return m_handle.done(); }
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			m_handle.promise().setContinuation(awaiting);
+			return m_handle;
+		}
+		T await_resume() { return m_handle.promise().take(); }
+	};
+
+	explicit CoTask(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) { }
+	CoTask(CoTask &&other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+	CoTask &operator=(CoTask &&other) noexcept {
+		if (this != &other) {
+			if (m_handle) {
+				m_handle.destroy();
+			}
+			m_handle = other.m_handle;
+			other.m_handle = nullptr;
+		}
+		return *this;
+	}
+	CoTask(const CoTask &) = delete;
+	CoTask &operator=(const CoTask &) = delete;
+	~CoTask() {
+		if (m_handle) {
+			m_handle.destroy();
+		}
+	}
+
+	bool valid() const noexcept { return static_cast<bool>(m_handle); }  // 是否持有协程
+	Awaiter operator co_await() const;  // 启动并等待结果，协程抛出的异常在这里重新抛出
+
+	TaskFuture<T> start(ThreadPool* pool = nullptr) &&;  // 在当前线程启动，结果写入返回的 TaskFuture
+	T get(ThreadPool* pool = nullptr) &&;  // 在当前线程启动并等待结果
+};
+
+
+template <typename T>
+inline CoTask<T> CoPromise<T>::get_return_object() noexcept {
+	return CoTask<T>(std::coroutine_handle<CoPromise<T>>::from_promise(*this));
+}
+
+
+inline CoTask<void> CoPromise<void>::get_return_object() noexcept {
+	return CoTask<void>(std::coroutine_handle<CoPromise<void>>::from_promise(*this));
+}
+
+
+/**
+ * @description: 启动并等待结果
+ * @return {Awaiter} 等待对象
+ */
+template <typename T>
+inline typename CoTask<T>::Awaiter CoTask<T>::operator co_await() const {
+	if (!m_handle) {
+		throw std::runtime_error("CoTask is empty");
+	}
+	return Awaiter(m_handle);
+}
+
+
+/**
+ * @description: 启动后立即完成的协程，自行销毁协程帧，用于在普通函数中驱动 CoTask
+ */
+struct CoDetached {
+	struct promise_type : CoFrameAllocation {
+		CoDetached get_return_object() const noexcept { return { }; }
+		std::suspend_never initial_suspend() const noexcept { return { }; }
+		std::suspend_never final_suspend() const noexcept { return { }; }
+		void return_void() const noexcept { }
+		void unhandled_exception() const noexcept { std::terminate(); }
+	};
+};
+
+
+/**
+ * @description: 等待 task 完成，把结果或异常写入 promise
+ * @param {CoTask<T>} task: 被驱动的协程
+ * @param {TaskPromise<T>} promise: 保存结果
+ */
+template <typename T>
+CoDetached coDrive(CoTask<T> task, TaskPromise<T> promise) {
+	try {
+		if constexpr (std::is_void_v<T>) {
+			co_await task;
+			promise.setValue();
+		}
+		else {
+			promise.setValue(co_await task);
+		}
+	}
+	catch (...) {
+		promise.setException(std::current_exception());
+	}
+}
+
+
+/**
+ * @description: 在当前线程启动，执行到第一次切换线程 (或结束) 时返回
+ * @param {ThreadPool*} pool: 结果所属的线程池；在该线程池的工作线程中 get() 时，等待期间帮助执行任务
+ * @return {TaskFuture<T>} 协程结束时就绪
+ */
+template <typename T>
+inline TaskFuture<T> CoTask<T>::start(ThreadPool* pool) && {
+	if (!m_handle) {
+		throw std::runtime_error("CoTask is empty");
+	}
+
+	TaskPromise<T> promise = pool ? TaskPromise<T>(pool, pool->getTaskPriority()) : TaskPromise<T>();
+	TaskFuture<T> future = promise.getFuture();
+	coDrive(std::move(*this), std::move(promise));
+	return future;
+}
+
+
+/**
+ * @description: 在当前线程启动并等待结果
+ * @param {ThreadPool*} pool: 在工作线程中调用时传入所属的线程池，等待期间帮助执行任务，避免工作线程都在等待时死锁
+ * @return {T} 协程的结果，协程抛出的异常在这里重新抛出
+ */
+template <typename T>
+inline T CoTask<T>::get(ThreadPool* pool) && {
+	return std::move(*this).start(pool).get();
+}
+
+
+/**
+ * @description: co_await TaskFuture 的等待对象：结果就绪后恢复协程的任务以 future 的优先级提交到其线程池，等待期间不阻塞任何线程
+ */
+template <typename T>
+class FutureAwaiter {
+private:
+	TaskFuture<T> m_future;  // 等待的 future，就绪后重新放回
+
+public:
+	explicit FutureAwaiter(TaskFuture<T> &&future) noexcept : m_future(std::move(future)) { }
+
+	bool await_ready() const noexcept { return !m_future.valid() || m_future.isReady(); }
+	void await_suspend(std::coroutine_handle<> handle) {
+		m_future.onComplete([this, handle](TaskFuture<T> ready) {
+			m_future = std::move(ready);
+			handle.resume();
+		});
+	}
+	T await_resume() { return m_future.get(); }
+};
+
+
+/**
+ * @description: 在协程中等待 submitAsync 等返回的 TaskFuture，不阻塞线程
+ * @param {TaskFuture<T>&&} future: 被等待的 future，之后失效
+ * @return {FutureAwaiter<T>} 等待对象
+ */
+template <typename T>
+inline FutureAwaiter<T> operator co_await(TaskFuture<T> &&future) noexcept {
+	return FutureAwaiter<T>(std::move(future));
+}
@@ -3,7 +3,7 @@
  * @github: https://github.com/yuyuyuj1e
  * @csdn: https://blog.csdn.net/yuyuyuj1e
  * @date: 2023-03-13 09:45:56
- * @last_edit_time: 2023-03-31 20:23:01
+ * @last_edit_time: 2026-10-18 09:41:07
  * @file_path: /Thread-Pool/include/CppLog.h
  * @description: 日志模块头文件
  */
@@ -16,6 +16,7 @@
 #include <fstream>
 #include <queue>
 #include <thread>
+#include <atomic>
 
 /*
 ***************************日志文件写入模式***************************
@@ -59,7 +60,9 @@ private:
     LogConfig* m_config;
     
     
-    bool m_start = false;  // 判断日志类是否已经启动
+    std::atomic_bool m_start{false};  // 判断日志类是否已经启动
+    int m_users = 0;  // 调用 run() 且尚未 close() 的使用者数量，例如每个线程池各占一个
+    std::mutex m_run_mutex;  // 保护 m_users 与日志线程的启动、停止
     
     std::mutex m_mutex;  // 互斥锁
     std::queue<std::pair<std::string, int>> m_taskQ;  // 任务队列
@@ -97,7 +100,7 @@ public:
     /* 接口 */
     inline void setOpenMode(LogMode);  // 设置文件打开模式
     inline void setTimeFormat(TimeFormat);  // 设置时间格式
-    inline void close();  // 关闭日志
+    inline void close();  // 释放一次 run() 的引用，最后一个使用者释放时关闭日志
     inline static CppLog* getInstance();  // 获取日志实例
     void addTask(std::string, int flag = 1);  // 向任务队列添加任务
 
@@ -123,9 +126,19 @@ inline void CppLog::setTimeFormat(TimeFormat ft) {
 }
 
 
+/**
+ * @description: 释放一次 run() 的引用，最后一个使用者释放时才停止日志线程，写完剩余日志后返回
+ */
 inline void CppLog::close() {
+    std::lock_guard<std::mutex> lock(m_run_mutex);
+    if (m_users == 0 || --m_users > 0) {
+        return;
+    }
+
     m_start = false;
     m_thread->join();
+    delete m_thread;
+    m_thread = nullptr;
 }
 
 
@@ -0,0 +1,71 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 18:35:40
+ * @last_edit_time: 2026-10-17 23:16:42
+ * @file_path: /Thread-Pool/include/DaryHeapSafeQueue.h
+ * @description: 基于任务槽位与间接 4 叉堆的优先级队列头文件
+ */
+
+#pragma once
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "TaskQueue.h"
+
+
+/**
+ * @description: 间接 4 叉堆优先级队列，适用于优先级范围不受限的场景
+ * @description: 任务保存在按最大任务量预分配的槽位中，堆中只保存 8 字节的键（高 32 位为优先级，低 32 位为槽位下标）
+ * @description: 调整堆时只移动键，不移动任务；4 叉堆高度更低，一个节点的子节点位于同一缓存行
+ */
+class DaryHeapSafeQueue : public TaskQueue {
+private:
+	static const size_t ARITY = 4;  // 堆的叉数
+
+	std::vector<Task> m_slots;  // 任务槽位
+	std::vector<uint32_t> m_free_slots;  // 空闲槽位
+	std::vector<uint64_t> m_heap;  // 最小堆，保存 (优先级, 槽位) 键
+	std::atomic<size_t> m_size;  // 任务数量
+	std::mutex m_mutex;  // 任务队列互斥锁
+
+	void reserveSlots(size_t);  // 槽位不足时扩容
+	void push(Task &, size_t);  // 放入槽位并插入堆，需持有 m_mutex
+	void siftUp(size_t);  // 向上调整
+	void siftDown(size_t);  // 向下调整
+
+public:
+	explicit DaryHeapSafeQueue(size_t);
+	~DaryHeapSafeQueue() = default;
+	DaryHeapSafeQueue(const DaryHeapSafeQueue &) = delete;
+	DaryHeapSafeQueue &operator=(const DaryHeapSafeQueue &) = delete;
+
+	/* 成员函数 */
+	inline bool empty() override;  // 队列是否为空
+	inline size_t size() override;  // 任务队列大小
+
+	bool taskEnqueue(Task &, size_t, size_t) override;  // 添加任务
+	bool taskDequeue(Task &) override;  // 取出任务
+	size_t taskEnqueueBatch(Task *, size_t, size_t, size_t) override;  // 批量添加任务
+	bool taskReplaceLowest(Task &, size_t, Task &) override;  // 用新任务替换优先级最低的任务
+};
+
+
+/**
+ * @description: 判断任务队列是否为空
+ * @return {bool} true/false
+ */
+bool DaryHeapSafeQueue::empty() {
+	return m_size.load(std::memory_order_relaxed) == 0;
+}
+
+
+/**
+ * @description: 获取任务队列大小
+ * @return {size_t} m_size
+ */
+size_t DaryHeapSafeQueue::size() {
+	return m_size.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,160 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 16:48:30
+ * @last_edit_time: 2026-10-18 16:48:30
+ * @file_path: /Thread-Pool/include/GroupTable.h
+ * @description: parallelGroupBy 使用的开放寻址哈希表头文件，每个参与者每个分区一张，不加锁
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/* 分组的键与值的类型：key_of(*first) 与 value_of(*first) 的结果去掉引用与 const */
+template <typename Iterator, typename KeyOf>
+using GroupKey = typename std::decay<decltype(std::declval<KeyOf &>()(*std::declval<Iterator>()))>::type;
+template <typename Iterator, typename ValueOf>
+using GroupValue = typename std::decay<decltype(std::declval<ValueOf &>()(*std::declval<Iterator>()))>::type;
+
+
+/**
+ * @description: 打散哈希值 (MurmurHash3 的 fmix64)；std::hash 对整数通常是恒等映射，高位用于选择分区，低位用于选择槽位，都需要足够随机
+ * @param {size_t} hash: 原始哈希值
+ * @return {size_t} 打散后的哈希值
+ */
+inline size_t mixGroupHash(size_t hash) {
+	uint64_t value = static_cast<uint64_t>(hash);
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+	return static_cast<size_t>(value);
+}
+
+
+/**
+ * @description: 线性探测的开放寻址哈希表，只支持插入 (相同的键合并值) 与整表合并
+ * @description: 槽位数组只保存打散后的哈希值与条目下标，条目按插入顺序连续存放，探测时很少访问条目；扩容时不需要重新计算哈希值，也不移动条目
+ * @description: 负载因子不超过 1/2，键与值不需要可以默认构造
+ */
+template <typename Key, typename Value>
+class GroupTable {
+private:
+	static const size_t INITIAL_SLOTS = 16;  // 第一次插入时的槽位数量
+
+	/* 槽位 */
+	struct Slot {
+		size_t m_hash;  // 打散后的哈希值
+		size_t m_entry;  // 条目下标加一，0 表示空槽位
+	};
+
+	std::vector<Slot> m_slots;  // 槽位，数量为 2 的幂
+	std::vector<std::pair<Key, Value>> m_entries;  // 条目
+
+	void grow();  // 槽位数量翻倍
+
+public:
+	template <typename K, typename V, typename Combine, typename Equal>
+	void insert(size_t hash, K &&key, V &&value, Combine &combine, Equal &equal);  // 插入，键已存在时 combine 原有的值
+	template <typename Combine, typename Equal>
+	void merge(GroupTable &other, Combine &combine, Equal &equal);  // 合并另一张表的所有条目，之后清空 other
+
+	size_t size() const { return m_entries.size(); }  // 条目数量
+	std::vector<std::pair<Key, Value>> &entries() { return m_entries; }  // 所有条目，顺序不确定
+	void clear();  // 清空并释放内存
+};
+
+
+/**
+ * @description: 槽位数量翻倍 (第一次为 INITIAL_SLOTS)，按保存的哈希值重新放置条目下标
+ */
+template <typename Key, typename Value>
+inline void GroupTable<Key, Value>::grow() {
+	size_t capacity = m_slots.empty() ? INITIAL_SLOTS : m_slots.size() * 2;
+	std::vector<Slot> slots(capacity, Slot{ 0, 0 });
+	size_t mask = capacity - 1;
+
+	for (const Slot &slot : m_slots) {
+		if (slot.m_entry == 0) {
+			continue;
+		}
+		size_t index = slot.m_hash & mask;
+		while (slots[index].m_entry != 0) {
+			index = (index + 1) & mask;
+		}
+		slots[index] = slot;
+	}
+	m_slots.swap(slots);
+}
+
+
+/**
+ * @description: 插入一个值，键已存在时与原有的值合并
+ * @param {size_t} hash: 打散后的哈希值
+ * @param {K} &&key: 键，只在键不存在时被移动进表中
+ * @param {V} &&value: 值
+ * @param {Combine&} combine: 合并函数，combine(原有的值, value) 返回新的值
+ * @param {Equal&} equal: 键的相等比较
+ */
+template <typename Key, typename Value>
+template <typename K, typename V, typename Combine, typename Equal>
+inline void GroupTable<Key, Value>::insert(size_t hash, K &&key, V &&value, Combine &combine, Equal &equal) {
+	if ((m_entries.size() + 1) * 2 > m_slots.size()) {
+		grow();
+	}
+
+	size_t mask = m_slots.size() - 1;
+	size_t index = hash & mask;
+	while (m_slots[index].m_entry != 0) {
+		Slot &slot = m_slots[index];
+		if (slot.m_hash == hash) {
+			std::pair<Key, Value> &entry = m_entries[slot.m_entry - 1];
+			if (equal(entry.first, key)) {
+				entry.second = combine(std::move(entry.second), std::forward<V>(value));
+				return;
+			}
+		}
+		index = (index + 1) & mask;
+	}
+
+	m_entries.emplace_back(std::forward<K>(key), std::forward<V>(value));
+	m_slots[index].m_hash = hash;
+	m_slots[index].m_entry = m_entries.size();
+}
+
+
+/**
+ * @description: 合并另一张表的所有条目，使用其中保存的哈希值，不重新计算
+ * @param {GroupTable&} other: 另一张表，合并后被清空
+ * @param {Combine&} combine: 合并函数，combine(Value, Value) 返回 Value
+ * @param {Equal&} equal: 键的相等比较
+ */
+template <typename Key, typename Value>
+template <typename Combine, typename Equal>
+inline void GroupTable<Key, Value>::merge(GroupTable &other, Combine &combine, Equal &equal) {
+	for (const Slot &slot : other.m_slots) {
+		if (slot.m_entry != 0) {
+			std::pair<Key, Value> &entry = other.m_entries[slot.m_entry - 1];
+			insert(slot.m_hash, std::move(entry.first), std::move(entry.second), combine, equal);
+		}
+	}
+	other.clear();
+}
+
+
+/**
+ * @description: 清空并释放内存
+ */
+template <typename Key, typename Value>
+inline void GroupTable<Key, Value>::clear() {
+	std::vector<Slot>().swap(m_slots);
+	std::vector<std::pair<Key, Value>>().swap(m_entries);
+}
@@ -3,7 +3,7 @@
  * @github: https://github.com/yuyuyuj1e
  * @csdn: https://blog.csdn.net/yuyuyuj1e
  * @date: 2023-04-05 14:52:59
- * @last_edit_time: 2023-04-05 15:22:14
+ * @last_edit_time: 2026-10-17 23:16:42
  * @file_path: /Thread-Pool/include/HeapSafeQueue.h
  * @description: 基于堆结构的优先级队列头文件
  */
@@ -11,12 +11,11 @@
 #pragma once
 #include <vector>
 #include <mutex>
-#include <functional>
-#include <iostream>
+#include "TaskQueue.h"
 
-class HeapSafeQueue {
+class HeapSafeQueue : public TaskQueue {
 private:
-	std::vector<std::pair<std::function<void()>, int>> m_queue;  // 任务队列
+	std::vector<std::pair<Task, int>> m_queue;  // 任务队列
 	std::mutex m_mutex;  // 任务队列互斥锁
 
     void siftUp(int);  // 向上调整
@@ -28,11 +27,14 @@ public:
 	~HeapSafeQueue() = default;
 
 	/* 成员函数 */
-	inline bool empty();  // 队列是否为空
-	inline size_t size();  // 任务队列大小
+	inline bool empty() override;  // 队列是否为空
+	inline size_t size() override;  // 任务队列大小
     
-	void taskEnqueue(std::function<void()> &, size_t);  // 添加任务
-	bool taskDequeue(std::function<void()> &);  // 取出任务
+	void taskEnqueue(Task &, size_t);  // 添加任务
+	bool taskEnqueue(Task &, size_t, size_t) override;  // 添加任务，队列已达上限时返回 false
+	bool taskDequeue(Task &) override;  // 取出任务
+	size_t taskEnqueueBatch(Task *, size_t, size_t, size_t) override;  // 批量添加任务
+	bool taskReplaceLowest(Task &, size_t, Task &) override;  // 用新任务替换优先级最低的任务
 };
 
 
@@ -0,0 +1,84 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 10:31:54
+ * @last_edit_time: 2026-10-18 10:31:54
+ * @file_path: /Thread-Pool/include/NumaSafeQueue.h
+ * @description: 按 NUMA 节点划分的任务队列头文件
+ */
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "TaskQueue.h"
+
+
+/**
+ * @description: 按 NUMA 节点划分的任务队列，每个节点持有一个由 task_queue 选择的子队列
+ * @description: 提交者放入自己所在节点的子队列；工作线程先从自己节点的子队列取任务，取不到时才跨节点获取
+ * @description: 任务上限对所有节点的任务总数生效；优先级只在同一节点内保证，跨节点时先取本节点的任务
+ */
+class NumaSafeQueue : public TaskQueue {
+private:
+	std::vector<std::unique_ptr<TaskQueue>> m_queues;  // 每个节点的子队列，下标即节点
+	std::atomic<size_t> m_size;  // 所有子队列的任务总数，入队前预留，因此不会小于实际数量
+
+	size_t reserve(size_t, size_t);  // 在任务上限内预留位置
+	size_t localQueue();  // 当前线程所在节点的子队列下标
+
+public:
+	explicit NumaSafeQueue(std::vector<std::unique_ptr<TaskQueue>>);
+	~NumaSafeQueue() = default;
+	NumaSafeQueue(const NumaSafeQueue &) = delete;
+	NumaSafeQueue &operator=(const NumaSafeQueue &) = delete;
+
+	/* 成员函数 */
+	inline bool empty() override;  // 队列是否为空
+	inline size_t size() override;  // 任务队列大小
+	inline size_t nodes();  // 节点数量
+	inline size_t size(size_t);  // 节点子队列大小
+
+	bool taskEnqueue(Task &, size_t, size_t) override;  // 添加任务到本节点子队列
+	bool taskDequeue(Task &) override;  // 优先从本节点子队列取出任务
+	size_t taskEnqueueBatch(Task *, size_t, size_t, size_t) override;  // 批量添加任务到本节点子队列
+	bool taskReplaceLowest(Task &, size_t, Task &) override;  // 用新任务替换优先级最低的任务，优先替换本节点的任务
+};
+
+
+/**
+ * @description: 判断任务队列是否为空
+ * @return {bool} true/false
+ */
+bool NumaSafeQueue::empty() {
+	return m_size.load(std::memory_order_relaxed) == 0;
+}
+
+
+/**
+ * @description: 获取任务队列大小
+ * @return {size_t} m_size
+ */
+size_t NumaSafeQueue::size() {
+	return m_size.load(std::memory_order_relaxed);
+}
+
+
+/**
+ * @description: 获取节点数量
+ * @return {size_t} m_queues.size()
+ */
+size_t NumaSafeQueue::nodes() {
+	return m_queues.size();
+}
+
+
+/**
+ * @description: 获取节点子队列大小
+ * @param {size_t} node: 节点下标
+ * @return {size_t} 子队列大小
+ */
+size_t NumaSafeQueue::size(size_t node) {
+	return m_queues[node]->size();
+}
@@ -0,0 +1,248 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 13:47:25
+ * @last_edit_time: 2026-10-18 15:02:33
+ * @file_path: /Thread-Pool/include/ParallelLoop.h
+ * @description: 并行循环的分块调度头文件，parallelFor 等并行算法共用
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <utility>
+#include "TaskArena.h"
+#include "TaskFuture.h"
+
+
+/**
+ * @description: 并行循环的分块方式
+ * @description: STATIC 表示按参与线程数量平均分成几大块，调度开销最小，适合每次迭代耗时相近的循环
+ * @description: DYNAMIC 表示每次领取 grain 个迭代，负载最均衡，适合迭代耗时差别较大的循环
+ * @description: GUIDED 表示每次领取剩余迭代的一部分，块由大到小，不小于 grain，兼顾调度开销与尾部的负载均衡
+ */
+enum class LoopSchedule : char {
+	STATIC,
+	DYNAMIC,
+	GUIDED
+};
+
+
+/**
+ * @description: 每个参与者的部分结果，后面填充一个缓存行，相邻参与者的部分结果不会位于同一缓存行 (C++11 的分配器不保证超过 max_align_t 的对齐，因此用填充代替 alignas)
+ */
+template <typename T>
+struct LoopPartial {
+	static const size_t CACHE_LINE = 64;  // 缓存行大小
+
+	T m_value;  // 部分结果
+	char m_pad[CACHE_LINE];  // 填充
+
+	explicit LoopPartial(const T &value) : m_value(value) { }
+};
+
+
+/**
+ * @description: 不做变换，parallelReduce 直接归约元素
+ */
+struct LoopIdentity {
+	template <typename U>
+	U &&operator()(U &&value) const { return std::forward<U>(value); }
+};
+
+
+/**
+ * @description: 归并两个有序区间时，按输出位置切分：求输出的前 diagonal 个元素中有多少个来自 first
+ * @description: 相等的元素先取 first 中的，与 std::merge 一致，因此按切分点分段归并的结果是稳定的
+ * @param {Iterator} first: 第一个有序区间
+ * @param {size_t} first_size: 第一个区间的长度
+ * @param {Iterator} second: 第二个有序区间
+ * @param {size_t} second_size: 第二个区间的长度
+ * @param {size_t} diagonal: 输出位置，不超过两个区间长度之和
+ * @param {Compare&} comp: 比较函数
+ * @return {size_t} 来自 first 的元素数量，其余 diagonal - 返回值 个来自 second
+ */
+template <typename Iterator, typename Compare>
+inline size_t mergeSplit(Iterator first, size_t first_size, Iterator second, size_t second_size, size_t diagonal, Compare &comp) {
+	size_t low = diagonal > second_size ? diagonal - second_size : 0;
+	size_t high = std::min(diagonal, first_size);
+
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+		if (comp(second[diagonal - middle - 1], first[middle])) {
+			high = middle;
+		}
+		else {
+			low = middle + 1;
+		}
+	}
+	return low;
+}
+
+
+/**
+ * @description: 一次并行循环的共享状态，由调用线程与提交到线程池的帮助任务共同持有
+ * @description: 所有参与者通过一个原子游标领取 [first, last) 区间，领取不到时退出；迭代全部完成时写入 promise，调用线程通过 future 等待
+ * @description: 帮助任务可能在循环结束后才开始执行，因此状态带引用计数，从 TaskArena 分配；循环体只在领取到区间时访问，循环结束后不再使用
+ * @description: Body 的调用形式为 body(first, last, participant)，participant 为参与者编号，调用线程为 0
+ */
+template <typename Body>
+class LoopRegion {
+private:
+	static const size_t CACHE_LINE = 64;  // 缓存行大小
+
+	Body &m_body;  // 循环体，位于调用线程的栈上
+	size_t m_size;  // 迭代数量
+	size_t m_grain;  // DYNAMIC 的块大小，GUIDED 的最小块
+	size_t m_participants;  // 参与者数量
+	LoopSchedule m_schedule;  // 分块方式
+	std::atomic<unsigned> m_references;  // 引用计数
+	std::atomic_bool m_failed;  // 是否有迭代抛出异常，之后领取的区间不再执行
+	std::exception_ptr m_exception;  // 第一个异常
+	TaskPromise<void> m_promise;  // 全部迭代完成时写入
+
+	char m_pad0[CACHE_LINE];  // 填充，领取游标与完成计数各占一个缓存行
+	std::atomic<size_t> m_cursor;  // 下一个未领取的迭代
+	char m_pad1[CACHE_LINE];
+	std::atomic<size_t> m_done;  // 已完成 (或跳过) 的迭代数量
+	char m_pad2[CACHE_LINE];
+
+	LoopRegion(Body &body, size_t size, size_t grain, size_t participants, LoopSchedule schedule, ThreadPool* pool, size_t priority)
+		: m_body(body)
+		, m_size(size)
+		, m_grain(std::max<size_t>(grain, 1))
+		, m_participants(participants)
+		, m_schedule(schedule)
+		, m_references(1)
+		, m_failed(false)
+		, m_promise(pool, priority)
+		, m_cursor(0)
+		, m_done(0)
+	{ }
+
+	bool claim(size_t &first, size_t &last);  // 领取一个区间
+	void finish(size_t);  // 记录完成的迭代，全部完成时写入结果
+
+public:
+	LoopRegion(const LoopRegion &) = delete;
+	LoopRegion &operator=(const LoopRegion &) = delete;
+
+	static LoopRegion* create(Body &body, size_t size, size_t grain, size_t participants, LoopSchedule schedule, ThreadPool* pool, size_t priority) {
+		return ::new (TaskArena::allocate(sizeof(LoopRegion))) LoopRegion(body, size, grain, participants, schedule, pool, priority);
+	}
+
+	TaskFuture<void> getFuture() { return m_promise.getFuture(); }  // 调用线程等待全部迭代完成
+	void work(size_t participant);  // 不断领取区间并执行，直到全部领取完
+	void retain() noexcept { m_references.fetch_add(1, std::memory_order_relaxed); }
+	void release() noexcept;  // 最后一个引用释放时销毁
+
+	/* 帮助任务持有的引用，任务被丢弃 (例如 shutdownNow 返回后析构) 时同样释放 */
+	class Handle {
+	private:
+		LoopRegion* m_region;
+		size_t m_participant;
+
+	public:
+		Handle(LoopRegion* region, size_t participant) noexcept : m_region(region), m_participant(participant) { region->retain(); }
+		Handle(Handle &&other) noexcept : m_region(other.m_region), m_participant(other.m_participant) { other.m_region = nullptr; }
+		Handle(const Handle &) = delete;
+		Handle &operator=(const Handle &) = delete;
+		~Handle() { if (m_region) m_region->release(); }
+
+		void operator()() { m_region->work(m_participant); }
+	};
+};
+
+
+/**
+ * @description: 领取一个区间
+ * @param {size_t&} first: 区间起点
+ * @param {size_t&} last: 区间终点 (不含)
+ * @return {bool} 还有未领取的迭代时返回 true
+ */
+template <typename Body>
+inline bool LoopRegion<Body>::claim(size_t &first, size_t &last) {
+	if (m_schedule == LoopSchedule::GUIDED) {
+		first = m_cursor.load(std::memory_order_relaxed);
+		do {
+			if (first >= m_size) {
+				return false;
+			}
+			size_t chunk = std::max(m_grain, (m_size - first) / (2 * m_participants));
+			last = std::min(m_size, first + chunk);
+		} while (!m_cursor.compare_exchange_weak(first, last, std::memory_order_relaxed));
+		return true;
+	}
+
+	// STATIC 每个参与者一块，提前开始的参与者可以领取迟到者的块
+	size_t chunk = m_schedule == LoopSchedule::STATIC ? (m_size + m_participants - 1) / m_participants : m_grain;
+	if (m_cursor.load(std::memory_order_relaxed) >= m_size) {
+		return false;
+	}
+	first = m_cursor.fetch_add(chunk, std::memory_order_relaxed);
+	if (first >= m_size) {
+		return false;
+	}
+	last = std::min(m_size, first + chunk);
+	return true;
+}
+
+
+/**
+ * @description: 不断领取区间并执行循环体；已有迭代抛出异常时只领取不执行，尽快结束循环
+ * @param {size_t} participant: 参与者编号
+ */
+template <typename Body>
+inline void LoopRegion<Body>::work(size_t participant) {
+	size_t first = 0;
+	size_t last = 0;
+
+	while (claim(first, last)) {
+		if (!m_failed.load(std::memory_order_relaxed)) {
+			try {
+				m_body(first, last, participant);
+			}
+			catch (...) {
+				if (!m_failed.exchange(true, std::memory_order_relaxed)) {
+					m_exception = std::current_exception();
+				}
+			}
+		}
+		finish(last - first);
+	}
+}
+
+
+/**
+ * @description: 记录完成的迭代，最后完成的参与者写入结果，调用线程随后返回
+ * @param {size_t} count: 完成的迭代数量
+ */
+template <typename Body>
+inline void LoopRegion<Body>::finish(size_t count) {
+	if (m_done.fetch_add(count, std::memory_order_acq_rel) + count != m_size) {
+		return;
+	}
+
+	if (m_exception) {
+		m_promise.setException(m_exception);
+	}
+	else {
+		m_promise.setValue();
+	}
+}
+
+
+/**
+ * @description: 减少引用，最后一个引用释放时析构并归还内存
+ */
+template <typename Body>
+inline void LoopRegion<Body>::release() noexcept {
+	if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		this->~LoopRegion();
+		TaskArena::deallocate(this);
+	}
+}
@@ -0,0 +1,84 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 11:05:51
+ * @last_edit_time: 2026-10-17 13:41:09
+ * @file_path: /Thread-Pool/include/RingSafeQueue.h
+ * @description: 无锁有界多生产者多消费者环形队列头文件
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "TaskQueue.h"
+
+
+/**
+ * @description: 无锁有界 MPMC 环形队列（Vyukov 序号槽位算法）
+ * @description: 每个槽位带有一个序号，生产者和消费者各自通过一次 CAS 抢占位置，不需要互斥锁
+ * @description: 容量在构造时确定（向上取整为 2 的幂），不区分任务优先级，按提交顺序执行
+ */
+class RingSafeQueue : public TaskQueue {
+private:
+	static const size_t CACHE_LINE = 64;  // 缓存行大小
+
+	/* 槽位 */
+	struct Cell {
+		std::atomic<size_t> m_sequence;  // 槽位序号
+		Task m_task;  // 任务
+	};
+
+	std::vector<Cell> m_buffer;  // 环形缓冲区
+	size_t m_mask;  // 下标掩码
+
+	char m_pad0[CACHE_LINE];  // 填充，避免生产者和消费者位置共享缓存行
+	std::atomic<size_t> m_enqueue_pos;  // 生产者位置
+	char m_pad1[CACHE_LINE];
+	std::atomic<size_t> m_dequeue_pos;  // 消费者位置
+	char m_pad2[CACHE_LINE];
+
+public:
+	explicit RingSafeQueue(size_t);
+	~RingSafeQueue() = default;
+	RingSafeQueue(const RingSafeQueue &) = delete;
+	RingSafeQueue &operator=(const RingSafeQueue &) = delete;
+
+	/* 成员函数 */
+	inline bool empty() override;  // 队列是否为空
+	inline size_t size() override;  // 任务队列大小（并发时只是近似值）
+	inline size_t capacity();  // 队列容量
+
+	bool taskEnqueue(Task &, size_t, size_t) override;  // 添加任务，忽略优先级
+	bool taskDequeue(Task &) override;  // 取出任务
+};
+
+
+/**
+ * @description: 判断任务队列是否为空
+ * @return {bool} true/false
+ */
+bool RingSafeQueue::empty() {
+	return size() == 0;
+}
+
+
+/**
+ * @description: 获取任务队列大小
+ * @return {size_t} 已占用的槽位数量
+ */
+size_t RingSafeQueue::size() {
+	size_t dequeue_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+	size_t enqueue_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+	return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+}
+
+
+/**
+ * @description: 获取任务队列容量
+ * @return {size_t} m_buffer.size()
+ */
+size_t RingSafeQueue::capacity() {
+	return m_buffer.size();
+}
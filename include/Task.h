@@ -0,0 +1,396 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 13:08:26
+ * @last_edit_time: 2026-10-19 15:31:08
+ * @file_path: /Thread-Pool/include/Task.h
+ * @description: 只可移动、带小对象优化的任务类型
+ */
+
+#pragma once
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <tuple>
+#include <future>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include "TaskArena.h"
+
+
+/**
+ * @description: 无参无返回值的任务，用于替代 std::function<void()>
+ * @description: 只可移动，因此可以保存 packaged_task、unique_ptr 等只可移动的对象
+ * @description: 不超过 INLINE_SIZE 且移动构造不抛异常的可调用对象直接保存在内部缓冲区中，不分配堆内存；否则从当前线程的 TaskArena 分配
+ */
+class Task {
+public:
+	static const size_t INLINE_SIZE = 48;  // 内部缓冲区大小
+
+private:
+	/* 类型擦除后的操作表 */
+	struct Operations {
+		void (*m_invoke)(void*);  // 执行
+		void (*m_move)(void*, void*);  // 移动到目标缓冲区，并析构源对象
+		void (*m_destroy)(void*);  // 析构
+		bool m_inline;  // 是否保存在内部缓冲区中
+	};
+
+	/* 保存在内部缓冲区中的可调用对象 */
+	template <typename F>
+	struct InlineOperations {
+		static void invoke(void* storage) { (*static_cast<F*>(storage))(); }
+		static void move(void* dst, void* src) {
+			::new (dst) F(std::move(*static_cast<F*>(src)));
+			static_cast<F*>(src)->~F();
+		}
+		static void destroy(void* storage) { static_cast<F*>(storage)->~F(); }
+		static const Operations m_operations;
+	};
+
+	/* 保存在堆上的可调用对象，内部缓冲区只保存指针；超过 max_align_t 对齐要求的对象改用 new 分配 */
+	template <typename F>
+	struct HeapOperations {
+		static const bool ARENA = alignof(F) <= alignof(std::max_align_t);
+		static void invoke(void* storage) { (**static_cast<F**>(storage))(); }
+		static void move(void* dst, void* src) { *static_cast<F**>(dst) = *static_cast<F**>(src); }
+		static void destroy(void* storage) {
+			F* f = *static_cast<F**>(storage);
+			if (ARENA) {
+				f->~F();
+				TaskArena::deallocate(f);
+			}
+			else {
+				delete f;
+			}
+		}
+		static const Operations m_operations;
+	};
+
+	template <typename F>
+	using StoredInline = std::integral_constant<bool,
+		sizeof(F) <= INLINE_SIZE
+		&& alignof(std::max_align_t) % alignof(F) == 0
+		&& std::is_nothrow_move_constructible<F>::value>;
+
+	typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type m_storage;  // 内部缓冲区
+	const Operations* m_operations;  // 为 nullptr 表示空任务
+
+	template <typename F>
+	void construct(F &&, std::true_type);  // 在内部缓冲区构造
+	template <typename F>
+	void construct(F &&, std::false_type);  // 在 TaskArena 上构造
+	void reset();  // 析构保存的可调用对象
+
+public:
+	/* 构造函数与析构函数 */
+	Task() noexcept : m_operations(nullptr) { }
+	Task(std::nullptr_t) noexcept : m_operations(nullptr) { }
+	template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+	Task(F &&);  // 由任意无参可调用对象构造
+	Task(Task &&) noexcept;  // 移动构造函数
+	Task &operator=(Task &&) noexcept;  // 移动赋值运算符
+	Task &operator=(std::nullptr_t) noexcept;  // 置空
+	Task(const Task &) = delete;  // 删除拷贝构造函数
+	Task &operator=(const Task &) = delete;  // 删除拷贝赋值运算符
+	~Task() { reset(); }
+
+	/* 成员函数 */
+	explicit operator bool() const noexcept { return m_operations != nullptr; }  // 是否保存了可调用对象
+	void operator()() { m_operations->m_invoke(&m_storage); }  // 执行任务
+	bool storedInline() const noexcept;  // 可调用对象是否保存在内部缓冲区中
+};
+
+
+template <typename F>
+const Task::Operations Task::InlineOperations<F>::m_operations = {
+	&Task::InlineOperations<F>::invoke,
+	&Task::InlineOperations<F>::move,
+	&Task::InlineOperations<F>::destroy,
+	true
+};
+
+
+template <typename F>
+const Task::Operations Task::HeapOperations<F>::m_operations = {
+	&Task::HeapOperations<F>::invoke,
+	&Task::HeapOperations<F>::move,
+	&Task::HeapOperations<F>::destroy,
+	false
+};
+
+
+/**
+ * @description: 由任意无参可调用对象构造
+ * @param {F} &&f: 可调用对象，会被移动（或拷贝）进任务
+ */
+template <typename F, typename>
+Task::Task(F &&f) : m_operations(nullptr) {
+	using stored_type = typename std::decay<F>::type;
+	construct(std::forward<F>(f), StoredInline<stored_type>());
+}
+
+
+/**
+ * @description: 在内部缓冲区构造可调用对象
+ * @param {F} &&f: 可调用对象
+ */
+template <typename F>
+void Task::construct(F &&f, std::true_type) {
+	using stored_type = typename std::decay<F>::type;
+	::new (static_cast<void*>(&m_storage)) stored_type(std::forward<F>(f));
+	m_operations = &InlineOperations<stored_type>::m_operations;
+}
+
+
+/**
+ * @description: 在当前线程的 TaskArena 上构造可调用对象，执行任务的线程释放时经跨线程空闲链表归还
+ * @param {F} &&f: 可调用对象
+ */
+template <typename F>
+void Task::construct(F &&f, std::false_type) {
+	using stored_type = typename std::decay<F>::type;
+	stored_type* stored = nullptr;
+
+	if (HeapOperations<stored_type>::ARENA) {
+		void* memory = TaskArena::allocate(sizeof(stored_type));
+		try {
+			stored = ::new (memory) stored_type(std::forward<F>(f));
+		}
+		catch (...) {
+			TaskArena::deallocate(memory);
+			throw;
+		}
+	}
+	else {
+		stored = new stored_type(std::forward<F>(f));
+	}
+
+	*reinterpret_cast<stored_type**>(&m_storage) = stored;
+	m_operations = &HeapOperations<stored_type>::m_operations;
+}
+
+
+/**
+ * @description: 移动构造函数
+ * @param {Task} &&other: 被移动的任务，移动后为空
+ */
+inline Task::Task(Task &&other) noexcept : m_operations(other.m_operations) {
+	if (m_operations) {
+		m_operations->m_move(&m_storage, &other.m_storage);
+		other.m_operations = nullptr;
+	}
+}
+
+
+/**
+ * @description: 移动赋值运算符
+ * @param {Task} &&other: 被移动的任务，移动后为空
+ * @return {Task&} *this
+ */
+inline Task &Task::operator=(Task &&other) noexcept {
+	if (this != &other) {
+		reset();
+		if (other.m_operations) {
+			other.m_operations->m_move(&m_storage, &other.m_storage);
+			m_operations = other.m_operations;
+			other.m_operations = nullptr;
+		}
+	}
+	return *this;
+}
+
+
+/**
+ * @description: 置空，释放保存的可调用对象
+ * @return {Task&} *this
+ */
+inline Task &Task::operator=(std::nullptr_t) noexcept {
+	reset();
+	return *this;
+}
+
+
+/**
+ * @description: 析构保存的可调用对象
+ */
+inline void Task::reset() {
+	if (m_operations) {
+		m_operations->m_destroy(&m_storage);
+		m_operations = nullptr;
+	}
+}
+
+
+/**
+ * @description: 可调用对象是否保存在内部缓冲区中，空任务返回 false
+ * @return {bool} true/false
+ */
+inline bool Task::storedInline() const noexcept {
+	return m_operations != nullptr && m_operations->m_inline;
+}
+
+
+/**
+ * @description: 编译期下标序列，用于展开 tuple 中保存的参数
+ */
+template <size_t... I>
+struct TaskIndexSequence { };
+
+template <size_t N, size_t... I>
+struct MakeTaskIndexSequence : MakeTaskIndexSequence<N - 1, N - 1, I...> { };
+
+template <size_t... I>
+struct MakeTaskIndexSequence<0, I...> {
+	using type = TaskIndexSequence<I...>;
+};
+
+
+/**
+ * @description: 调用普通可调用对象
+ */
+template <typename F, typename... A>
+inline auto taskInvoke(F &&f, A &&... args) -> decltype(std::forward<F>(f)(std::forward<A>(args)...)) {
+	return std::forward<F>(f)(std::forward<A>(args)...);
+}
+
+
+/**
+ * @description: 通过对象（或引用）调用成员函数
+ */
+template <typename M, typename O, typename... A>
+inline auto taskInvoke(M &&method, O &&object, A &&... args) -> decltype((std::forward<O>(object).*method)(std::forward<A>(args)...)) {
+	return (std::forward<O>(object).*method)(std::forward<A>(args)...);
+}
+
+
+/**
+ * @description: 通过指针（或智能指针）调用成员函数
+ */
+template <typename M, typename O, typename... A>
+inline auto taskInvoke(M &&method, O &&object, A &&... args) -> decltype(((*std::forward<O>(object)).*method)(std::forward<A>(args)...)) {
+	return ((*std::forward<O>(object)).*method)(std::forward<A>(args)...);
+}
+
+
+/**
+ * @description: 通过 std::ref 包装的对象调用成员函数
+ */
+template <typename M, typename T, typename... A>
+inline auto taskInvoke(M &&method, std::reference_wrapper<T> object, A &&... args) -> decltype((object.get().*method)(std::forward<A>(args)...)) {
+	return (object.get().*method)(std::forward<A>(args)...);
+}
+
+
+/**
+ * @description: 任务函数的返回类型，函数与参数都按退化后的类型保存，调用时以右值传入
+ */
+#if __cplusplus >= 201703L
+template <typename Func, typename... Args>
+using TaskResult = typename std::invoke_result<typename std::decay<Func>::type, typename std::decay<Args>::type...>::type;  // C++20 移除了 std::result_of
+#else
+template <typename Func, typename... Args>
+using TaskResult = typename std::result_of<typename std::decay<Func>::type(typename std::decay<Args>::type...)>::type;
+#endif
+
+
+/**
+ * @description: 任务函数可以被调用时为 void，否则替换失败，用于排除不匹配的重载
+ */
+template <typename Func, typename... Args>
+using TaskVoid = typename std::conditional<true, void, TaskResult<Func, Args...>>::type;
+
+
+/**
+ * @description: 将任务函数和参数绑定为无参可调用对象，用于替代 std::bind
+ * @description: 函数和参数都被移动（或拷贝）保存，只会被调用一次，调用时将参数移动给任务函数，因此支持 unique_ptr 等只可移动的参数
+ */
+template <typename Func, typename... Args>
+class BoundTask {
+private:
+	typename std::decay<Func>::type m_func;  // 任务函数
+	std::tuple<typename std::decay<Args>::type...> m_args;  // 任务函数参数
+
+	template <size_t... I>
+	TaskResult<Func, Args...> invoke(TaskIndexSequence<I...>) {
+		return taskInvoke(std::move(m_func), std::move(std::get<I>(m_args))...);
+	}
+
+public:
+	template <typename F, typename... A>
+	explicit BoundTask(F &&func, A &&... args)
+		: m_func(std::forward<F>(func))
+		, m_args(std::forward<A>(args)...)
+	{ }
+
+	TaskResult<Func, Args...> operator()() {
+		return invoke(typename MakeTaskIndexSequence<sizeof...(Args)>::type());
+	}
+};
+
+
+/**
+ * @description: 写入 promise 的结果或异常，PromiseTask 通过这两个函数访问 promise；TaskPromise 的重载在 TaskFuture.h 中
+ */
+template <typename R, typename... V>
+inline void setPromiseValue(std::promise<R> &promise, V &&... value) {
+	promise.set_value(std::forward<V>(value)...);
+}
+
+template <typename R>
+inline void setPromiseException(std::promise<R> &promise, std::exception_ptr exception) {
+	promise.set_exception(exception);
+}
+
+
+/**
+ * @description: 将任务函数与 promise 绑定，执行时把返回值或异常写入 promise，用于替代 packaged_task
+ * @description: Promise 为 std::promise<R> 或 TaskPromise<R>；std::promise 的共享状态与结果由 TaskAllocator 分配，未执行就被析构时 future 得到 broken_promise 异常
+ */
+template <typename R, typename F, typename Promise = std::promise<R>>
+class PromiseTask {
+private:
+	Promise m_promise;  // 保存结果
+	F m_func;  // 无参任务函数
+
+	void invoke(std::true_type) {
+		m_func();
+		setPromiseValue(m_promise);
+	}
+
+	void invoke(std::false_type) {
+		setPromiseValue(m_promise, m_func());
+	}
+
+public:
+	template <typename G>
+	PromiseTask(Promise &&promise, G &&func)
+		: m_promise(std::move(promise))
+		, m_func(std::forward<G>(func))
+	{ }
+
+	void operator()() {
+		try {
+			invoke(std::is_void<R>());
+		}
+		catch (...) {
+			setPromiseException(m_promise, std::current_exception());
+		}
+	}
+};
+
+
+/**
+ * @description: 创建带 future 的任务，promise 的共享状态从 TaskArena 分配
+ * @param {F} &&func: 无参任务函数
+ * @param {std::future<R>&} future: 存放任务的 future
+ * @return {Task} 任务
+ */
+template <typename R, typename F>
+inline Task makePromiseTask(F &&func, std::future<R> &future) {
+	std::promise<R> promise(std::allocator_arg, TaskAllocator<R>());
+	future = promise.get_future();
+	return Task(PromiseTask<R, typename std::decay<F>::type>(std::move(promise), std::forward<F>(func)));
+}
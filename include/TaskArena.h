@@ -0,0 +1,129 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 11:20:43
+ * @last_edit_time: 2026-10-18 11:20:43
+ * @file_path: /Thread-Pool/include/TaskArena.h
+ * @description: 线程私有的分块内存池头文件，用于任务与 future 共享状态等小对象
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+
+/**
+ * @description: 内存池统计，所有线程的内存池累加
+ */
+struct ArenaStatistics {
+	size_t m_allocations;  // 从内存池分配的次数
+	size_t m_bytes;  // 从内存池分配的字节数 (按分级后的块大小计算)
+	size_t m_remote_frees;  // 由其他线程释放、经跨线程空闲链表归还的次数
+	size_t m_large_allocations;  // 超过最大分级或线程已退出，改用 malloc 的次数
+	size_t m_reserved_bytes;  // 所有内存池向系统申请的内存
+	size_t m_arenas;  // 内存池数量，即曾经同时存在的提交、工作线程数量
+	size_t m_tasks;  // 线程池已提交的任务数量，由 ThreadPool::getArenaStatistics 填写
+	double allocationsPerTask() const { return m_tasks ? static_cast<double>(m_allocations + m_large_allocations) / m_tasks : 0; }  // 每个任务的分配次数
+	double bytesPerTask() const { return m_tasks ? static_cast<double>(m_bytes) / m_tasks : 0; }  // 每个任务从内存池分配的字节数
+};
+
+
+/**
+ * @description: 线程私有的分块内存池
+ * @description: 每个线程第一次分配时获得一个内存池，按 32 ~ 1024 字节分级，每级从 64KB 的大块中切分，释放后进入本级空闲链表，分配与释放都不加锁
+ * @description: 由其他线程释放的块放入所属内存池的跨线程空闲链表 (无锁栈)，所属线程在本级空闲链表为空时一次取回
+ * @description: 线程退出时内存池被挂起，由之后新建的线程接管，内存不归还系统；future 共享状态可能比线程池活得更久，因此内存池属于线程而不是线程池
+ */
+class TaskArena {
+public:
+	static const size_t CLASSES = 6;  // 分级数量
+	static const size_t MIN_BLOCK = 32;  // 最小的块，含块头
+	static const size_t SLAB_SIZE = 64 * 1024;  // 每次向系统申请的大块
+
+private:
+	/* 块头，记录所属内存池与分级，保证用户区按 max_align_t 对齐 */
+	struct alignas(std::max_align_t) Header {
+		TaskArena* m_arena;  // 所属内存池，malloc 分配的块为 nullptr
+		size_t m_class;  // 分级下标
+	};
+
+	/* 空闲块，复用用户区保存链表指针 */
+	struct FreeBlock {
+		FreeBlock* m_next;
+	};
+
+	struct Holder;  // 线程退出时挂起内存池
+
+	FreeBlock* m_free[CLASSES];  // 每级的空闲链表，只由所属线程访问
+	std::atomic<FreeBlock*> m_remote;  // 其他线程归还的块，所有分级共用
+	char* m_cursor;  // 当前大块中尚未切分的位置
+	char* m_end;  // 当前大块的结尾
+
+	/* 统计，只由所属线程写入 (m_remote_frees 除外)，其他线程可以随时读取 */
+	std::atomic<size_t> m_allocations;
+	std::atomic<size_t> m_bytes;
+	std::atomic<size_t> m_remote_frees;
+	std::atomic<size_t> m_reserved;
+
+	TaskArena();
+
+	static TaskArena* local();  // 当前线程的内存池，线程已退出时返回 nullptr
+	static size_t classOf(size_t);  // 字节数对应的分级，超过最大分级返回 CLASSES
+	static size_t blockSize(size_t);  // 分级对应的块大小，含块头
+
+	void* allocateBlock(size_t);  // 从本级空闲链表或当前大块分配
+	void collectRemote();  // 取回跨线程空闲链表中的块
+	void freeLocal(Header*);  // 所属线程释放
+	void freeRemote(Header*);  // 其他线程释放
+
+public:
+	TaskArena(const TaskArena &) = delete;
+	TaskArena &operator=(const TaskArena &) = delete;
+
+	static void* allocate(size_t);  // 分配内存，任意线程
+	static void deallocate(void*) noexcept;  // 释放内存，任意线程，可以不是分配时的线程
+	static ArenaStatistics statistics();  // 所有线程的内存池统计
+};
+
+
+/**
+ * @description: 使用 TaskArena 的标准分配器，可以用于 std::promise、std::allocate_shared 与容器
+ * @description: 所有实例等价，任意线程分配的内存可以由任意线程释放
+ */
+template <typename T>
+class TaskAllocator {
+public:
+	using value_type = T;
+
+	TaskAllocator() noexcept { }
+	template <typename U>
+	TaskAllocator(const TaskAllocator<U> &) noexcept { }
+
+	T* allocate(size_t n) {
+		static_assert(alignof(T) <= alignof(std::max_align_t), "TaskAllocator does not support over-aligned types");
+		return static_cast<T*>(TaskArena::allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, size_t) noexcept {
+		TaskArena::deallocate(p);
+	}
+
+	template <typename U>
+	struct rebind {
+		using other = TaskAllocator<U>;
+	};
+};
+
+
+template <typename T, typename U>
+inline bool operator==(const TaskAllocator<T> &, const TaskAllocator<U> &) noexcept {
+	return true;
+}
+
+
+template <typename T, typename U>
+inline bool operator!=(const TaskAllocator<T> &, const TaskAllocator<U> &) noexcept {
+	return false;
+}
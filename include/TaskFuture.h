@@ -0,0 +1,585 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 12:06:52
+ * @last_edit_time: 2026-10-19 16:05:44
+ * @file_path: /Thread-Pool/include/TaskFuture.h
+ * @description: 线程池专用的 future / promise 头文件，支持后续任务，工作线程中等待时帮助执行任务
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Task.h"
+#include "TaskArena.h"
+
+
+class ThreadPool;
+
+
+/**
+ * @description: 后续任务的执行方式
+ * @description: POOL 表示提交到前置任务所属的线程池，任务队列已满或线程池已关闭时改为直接执行；没有线程池时直接执行
+ * @description: INLINE 表示由完成前置任务的线程直接执行 (设置时已完成则由设置的线程执行)，适合很短的后续任务，省去一次入队
+ */
+enum class ContinuationPolicy : char {
+	POOL,
+	INLINE
+};
+
+
+/**
+ * @description: TaskFuture 共享状态中与结果类型无关的部分
+ * @description: 结果只由 promise 一方写入、future 一方读取，状态通过一个原子标志位同步，不加锁：
+ * @description: 写入方存好结果后置 READY，读取方设置后续任务后置 CONTINUATION，后置位的一方负责执行后续任务；读取方阻塞前置 WAITING，写入方据此决定是否唤醒
+ * @description: 阻塞等待使用按地址分组的全局条件变量，共享状态本身不含互斥锁
+ */
+class FutureCore {
+private:
+	static const unsigned READY = 1;  // 结果已写入
+	static const unsigned CONTINUATION = 2;  // 后续任务已设置
+	static const unsigned WAITING = 4;  // 有线程阻塞等待
+
+	std::atomic<unsigned> m_flags;  // 状态标志位
+	std::atomic<unsigned> m_references;  // 引用计数，promise 与 future 各持有一个
+	ThreadPool* m_pool;  // 产生结果的线程池，后续任务默认提交到这里；没有线程池时为 nullptr
+	size_t m_priority;  // 后续任务的优先级，与前置任务相同
+	Task m_continuation;  // 后续任务
+	ContinuationPolicy m_policy;  // 后续任务的执行方式
+
+	void runContinuation();  // 执行或提交后续任务，之后不再访问本对象
+	void notifyWaiters();  // 唤醒阻塞等待的线程
+
+protected:
+	std::exception_ptr m_exception;  // 任务抛出的异常
+
+	FutureCore(ThreadPool*, size_t);
+	virtual ~FutureCore() { }
+	virtual void destroy() noexcept = 0;  // 析构并归还内存
+
+public:
+	FutureCore(const FutureCore &) = delete;
+	FutureCore &operator=(const FutureCore &) = delete;
+
+	void retain() noexcept { m_references.fetch_add(1, std::memory_order_relaxed); }  // 增加引用
+	void release() noexcept;  // 减少引用，最后一个引用释放时销毁
+	bool ready() const noexcept { return (m_flags.load(std::memory_order_acquire) & READY) != 0; }  // 结果是否已写入
+	ThreadPool* pool() const noexcept { return m_pool; }
+	size_t priority() const noexcept { return m_priority; }
+	const std::exception_ptr &exception() const noexcept { return m_exception; }
+
+	void complete() noexcept;  // 写入方：结果已写入，唤醒等待者并执行后续任务
+	void fail(std::exception_ptr) noexcept;  // 写入方：保存异常并完成
+	void setContinuation(Task &, ContinuationPolicy);  // 读取方：设置后续任务，已完成时立即执行
+	void wait();  // 读取方：等待结果，线程池的工作线程等待时帮助执行任务
+	static void notifyHelpers();  // 唤醒阻塞等待的线程，线程池有新任务时让等待结果的工作线程帮助执行
+};
+
+
+/**
+ * @description: 带结果的共享状态，从当前线程的 TaskArena 分配
+ */
+template <typename T>
+class FutureState : public FutureCore {
+private:
+	static_assert(!std::is_reference<T>::value, "TaskFuture does not support reference types");
+	static_assert(alignof(T) <= alignof(std::max_align_t), "TaskFuture does not support over-aligned types");
+
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type m_value;  // 结果
+	bool m_has_value;  // 结果是否已构造
+
+	FutureState(ThreadPool* pool, size_t priority) : FutureCore(pool, priority), m_has_value(false) { }
+
+	~FutureState() {
+		if (m_has_value) {
+			reinterpret_cast<T*>(&m_value)->~T();
+		}
+	}
+
+	void destroy() noexcept override {
+		this->~FutureState();
+		TaskArena::deallocate(this);
+	}
+
+public:
+	static FutureState* create(ThreadPool* pool, size_t priority) {
+		return ::new (TaskArena::allocate(sizeof(FutureState))) FutureState(pool, priority);
+	}
+
+	template <typename U>
+	void store(U &&value) {
+		::new (&m_value) T(std::forward<U>(value));
+		m_has_value = true;
+	}
+
+	T take() {
+		return std::move(*reinterpret_cast<T*>(&m_value));
+	}
+};
+
+
+template <>
+class FutureState<void> : public FutureCore {
+private:
+	FutureState(ThreadPool* pool, size_t priority) : FutureCore(pool, priority) { }
+
+	void destroy() noexcept override {
+		this->~FutureState();
+		TaskArena::deallocate(this);
+	}
+
+public:
+	static FutureState* create(ThreadPool* pool, size_t priority) {
+		return ::new (TaskArena::allocate(sizeof(FutureState))) FutureState(pool, priority);
+	}
+
+	void store() { }
+	void take() { }
+};
+
+
+template <typename T>
+class TaskPromise;
+
+
+/**
+ * @description: 后续任务 f 的返回类型：前置结果为 void 时为 f()，否则为 f(T)
+ */
+template <typename T, typename F>
+struct ContinuationTraits {
+	using type = TaskResult<F, T>;
+};
+
+template <typename F>
+struct ContinuationTraits<void, F> {
+	using type = TaskResult<F>;
+};
+
+template <typename T, typename F>
+using ContinuationResult = typename ContinuationTraits<T, F>::type;
+
+
+/**
+ * @description: 线程池专用的 future，只可移动
+ * @description: 与 std::future 相比：共享状态不含互斥锁与条件变量；可以通过 then / onComplete 设置后续任务，不必阻塞一个线程等待结果再提交下一步；
+ * @description: 在所属线程池的工作线程中调用 get / wait 时，等待期间帮助执行任务队列中的任务，而不是阻塞工作线程
+ * @description: get、then、onComplete 都会消耗 future，之后 valid() 为 false；每个 future 只能设置一个后续任务
+ * @description: 使用 POOL 方式的后续任务时，线程池需要比 future 活得更久
+ */
+template <typename T>
+class TaskFuture {
+private:
+	FutureState<T>* m_state;  // 共享状态，为空表示无效
+
+	template <typename>
+	friend class TaskPromise;
+
+	explicit TaskFuture(FutureState<T>* state) noexcept : m_state(state) { }  // 接管一个引用
+	FutureState<T>* detach();  // 交出共享状态，之后无效
+
+public:
+	using value_type = T;
+
+	TaskFuture() noexcept : m_state(nullptr) { }
+	TaskFuture(TaskFuture &&other) noexcept : m_state(other.m_state) { other.m_state = nullptr; }
+	TaskFuture &operator=(TaskFuture &&) noexcept;
+	TaskFuture(const TaskFuture &) = delete;
+	TaskFuture &operator=(const TaskFuture &) = delete;
+	~TaskFuture() { if (m_state) m_state->release(); }
+
+	bool valid() const noexcept { return m_state != nullptr; }  // 是否持有共享状态
+	bool isReady() const noexcept { return m_state != nullptr && m_state->ready(); }  // 结果是否已就绪，不阻塞
+	void wait() const;  // 等待结果就绪，不消耗 future
+	T get();  // 取出结果，任务抛出的异常在这里重新抛出
+
+	template <typename F>
+	auto then(F &&func) -> TaskFuture<ContinuationResult<T, F>>;  // 结果就绪后提交 func(结果) 到线程池
+	template <typename F>
+	auto then(ContinuationPolicy policy, F &&func) -> TaskFuture<ContinuationResult<T, F>>;  // 按指定方式执行 func(结果)
+	template <typename F>
+	void onComplete(F &&func);  // 结果就绪 (或失败) 后提交 func(就绪的 future) 到线程池
+	template <typename F>
+	void onComplete(ContinuationPolicy policy, F &&func);  // 按指定方式执行 func(就绪的 future)
+};
+
+
+/**
+ * @description: TaskFuture 对应的 promise，只可移动，只能写入一次结果
+ * @description: 未写入结果就被析构时，future 得到 broken_promise 异常
+ */
+template <typename T>
+class TaskPromise {
+private:
+	FutureState<T>* m_state;  // 共享状态
+	bool m_retrieved;  // future 是否已取出
+	bool m_satisfied;  // 结果是否已写入
+
+	void checkSatisfiable();
+
+public:
+	TaskPromise() : TaskPromise(nullptr, 0) { }  // 不属于线程池，后续任务直接执行
+	TaskPromise(ThreadPool* pool, size_t priority);  // 后续任务以 priority 提交到 pool
+	TaskPromise(TaskPromise &&other) noexcept;
+	TaskPromise &operator=(TaskPromise &&) noexcept;
+	TaskPromise(const TaskPromise &) = delete;
+	TaskPromise &operator=(const TaskPromise &) = delete;
+	~TaskPromise();
+
+	TaskFuture<T> getFuture();  // 取出 future，只能调用一次
+	template <typename... U>
+	void setValue(U &&... value);  // 写入结果，T 为 void 时不带参数
+	void setException(std::exception_ptr);  // 写入异常
+};
+
+
+/**
+ * @description: then 设置的后续任务：前置任务成功时以其结果调用任务函数，失败时把异常原样传给后续 future
+ */
+template <typename T, typename F, typename R>
+class ThenTask {
+private:
+	TaskFuture<T> m_antecedent;  // 已就绪的前置 future
+	F m_func;  // 任务函数
+	TaskPromise<R> m_promise;  // 后续 future 的 promise
+
+	void invoke(std::false_type, std::false_type) {
+		m_promise.setValue(taskInvoke(std::move(m_func), m_antecedent.get()));
+	}
+
+	void invoke(std::false_type, std::true_type) {
+		taskInvoke(std::move(m_func), m_antecedent.get());
+		m_promise.setValue();
+	}
+
+	void invoke(std::true_type, std::false_type) {
+		m_antecedent.get();
+		m_promise.setValue(taskInvoke(std::move(m_func)));
+	}
+
+	void invoke(std::true_type, std::true_type) {
+		m_antecedent.get();
+		taskInvoke(std::move(m_func));
+		m_promise.setValue();
+	}
+
+public:
+	template <typename G>
+	ThenTask(TaskFuture<T> &&antecedent, G &&func, TaskPromise<R> &&promise)
+		: m_antecedent(std::move(antecedent))
+		, m_func(std::forward<G>(func))
+		, m_promise(std::move(promise))
+	{ }
+
+	void operator()() {
+		try {
+			invoke(std::is_void<T>(), std::is_void<R>());
+		}
+		catch (...) {
+			m_promise.setException(std::current_exception());
+		}
+	}
+};
+
+
+/**
+ * @description: onComplete 设置的后续任务：以就绪的 future 调用任务函数，由任务函数自行 get 结果或处理异常
+ */
+template <typename T, typename F>
+class CompleteTask {
+private:
+	TaskFuture<T> m_future;  // 已就绪的 future
+	F m_func;  // 任务函数
+
+public:
+	template <typename G>
+	CompleteTask(TaskFuture<T> &&future, G &&func)
+		: m_future(std::move(future))
+		, m_func(std::forward<G>(func))
+	{ }
+
+	void operator()() {
+		taskInvoke(std::move(m_func), std::move(m_future));
+	}
+};
+
+
+/**
+ * @description: PromiseTask 写入 TaskPromise 的结果或异常
+ */
+template <typename T, typename... V>
+inline void setPromiseValue(TaskPromise<T> &promise, V &&... value) {
+	promise.setValue(std::forward<V>(value)...);
+}
+
+template <typename T>
+inline void setPromiseException(TaskPromise<T> &promise, std::exception_ptr exception) {
+	promise.setException(exception);
+}
+
+
+/**
+ * @description: 创建带 TaskFuture 的任务，共享状态从 TaskArena 分配
+ * @param {F} &&func: 无参任务函数
+ * @param {TaskFuture<R>&} future: 存放任务的 future
+ * @param {ThreadPool*} pool: 执行任务的线程池，后续任务默认提交到这里
+ * @param {size_t} priority: 任务优先级，后续任务沿用
+ * @return {Task} 任务
+ */
+template <typename R, typename F>
+inline Task makeFutureTask(F &&func, TaskFuture<R> &future, ThreadPool* pool, size_t priority) {
+	TaskPromise<R> promise(pool, priority);
+	future = promise.getFuture();
+	return Task(PromiseTask<R, typename std::decay<F>::type, TaskPromise<R>>(std::move(promise), std::forward<F>(func)));
+}
+
+
+
+/**
+ * @description: 移动赋值运算符
+ * @param {TaskFuture} &&other: 被移动的 future，移动后无效
+ * @return {TaskFuture&} *this
+ */
+template <typename T>
+inline TaskFuture<T> &TaskFuture<T>::operator=(TaskFuture &&other) noexcept {
+	if (this != &other) {
+		if (m_state) {
+			m_state->release();
+		}
+		m_state = other.m_state;
+		other.m_state = nullptr;
+	}
+	return *this;
+}
+
+
+/**
+ * @description: 交出共享状态，调用者接管引用
+ * @return {FutureState<T>*} 共享状态
+ */
+template <typename T>
+inline FutureState<T>* TaskFuture<T>::detach() {
+	if (!m_state) {
+		throw std::future_error(std::future_errc::no_state);
+	}
+	FutureState<T>* state = m_state;
+	m_state = nullptr;
+	return state;
+}
+
+
+/**
+ * @description: 等待结果就绪；在所属线程池的工作线程中调用时，等待期间帮助执行任务
+ */
+template <typename T>
+inline void TaskFuture<T>::wait() const {
+	if (!m_state) {
+		throw std::future_error(std::future_errc::no_state);
+	}
+	m_state->wait();
+}
+
+
+/**
+ * @description: 等待并取出结果，之后 future 无效
+ * @return {T} 任务函数的返回值，任务抛出异常时重新抛出
+ */
+template <typename T>
+inline T TaskFuture<T>::get() {
+	struct Releaser {
+		FutureState<T>* m_state;
+		~Releaser() { m_state->release(); }
+	} releaser = { detach() };
+
+	releaser.m_state->wait();
+	if (releaser.m_state->exception()) {
+		std::rethrow_exception(releaser.m_state->exception());
+	}
+	return releaser.m_state->take();
+}
+
+
+/**
+ * @description: 结果就绪后，以结果调用 func，func 提交到前置任务所属的线程池
+ * @param {F} &&func: 后续任务函数，参数为前置任务的结果 (void 时无参数)
+ * @return {TaskFuture<...>} 后续任务的 future，前置任务失败时得到同样的异常
+ */
+template <typename T>
+template <typename F>
+inline auto TaskFuture<T>::then(F &&func) -> TaskFuture<ContinuationResult<T, F>> {
+	return then(ContinuationPolicy::POOL, std::forward<F>(func));
+}
+
+
+/**
+ * @description: 结果就绪后，按指定方式以结果调用 func；前置任务失败时不调用 func，异常传给返回的 future
+ * @param {ContinuationPolicy} policy: 执行方式
+ * @param {F} &&func: 后续任务函数，参数为前置任务的结果 (void 时无参数)
+ * @return {TaskFuture<...>} 后续任务的 future，沿用前置任务的线程池与优先级
+ */
+template <typename T>
+template <typename F>
+inline auto TaskFuture<T>::then(ContinuationPolicy policy, F &&func) -> TaskFuture<ContinuationResult<T, F>> {
+	using result_type = ContinuationResult<T, F>;
+
+	FutureState<T>* state = detach();
+	TaskPromise<result_type> promise(state->pool(), state->priority());
+	TaskFuture<result_type> future = promise.getFuture();
+
+	// 后续任务持有前置状态的引用，设置之后可能立即被执行并释放状态，不能再访问 state
+	Task continuation(ThenTask<T, typename std::decay<F>::type, result_type>(TaskFuture<T>(state), std::forward<F>(func), std::move(promise)));
+	state->setContinuation(continuation, policy);
+
+	return future;
+}
+
+
+/**
+ * @description: 结果就绪或失败后，以就绪的 future 调用 func，func 提交到前置任务所属的线程池
+ * @param {F} &&func: 回调函数，参数为 TaskFuture<T>
+ */
+template <typename T>
+template <typename F>
+inline void TaskFuture<T>::onComplete(F &&func) {
+	onComplete(ContinuationPolicy::POOL, std::forward<F>(func));
+}
+
+
+/**
+ * @description: 结果就绪或失败后，按指定方式以就绪的 future 调用 func
+ * @description: func 抛出的异常交给线程池的 setExceptionHandler 回调；没有线程池且直接执行时调用 std::terminate
+ * @param {ContinuationPolicy} policy: 执行方式
+ * @param {F} &&func: 回调函数，参数为 TaskFuture<T>
+ */
+template <typename T>
+template <typename F>
+inline void TaskFuture<T>::onComplete(ContinuationPolicy policy, F &&func) {
+	FutureState<T>* state = detach();
+	Task continuation(CompleteTask<T, typename std::decay<F>::type>(TaskFuture<T>(state), std::forward<F>(func)));
+	state->setContinuation(continuation, policy);
+}
+
+
+
+/**
+ * @description: 创建共享状态
+ * @param {ThreadPool*} pool: 后续任务提交到的线程池，nullptr 表示直接执行
+ * @param {size_t} priority: 后续任务的优先级
+ */
+template <typename T>
+inline TaskPromise<T>::TaskPromise(ThreadPool* pool, size_t priority)
+	: m_state(FutureState<T>::create(pool, priority))
+	, m_retrieved(false)
+	, m_satisfied(false)
+{ }
+
+
+/**
+ * @description: 移动构造函数
+ * @param {TaskPromise} &&other: 被移动的 promise，移动后不再持有共享状态
+ */
+template <typename T>
+inline TaskPromise<T>::TaskPromise(TaskPromise &&other) noexcept
+	: m_state(other.m_state)
+	, m_retrieved(other.m_retrieved)
+	, m_satisfied(other.m_satisfied)
+{
+	other.m_state = nullptr;
+}
+
+
+/**
+ * @description: 移动赋值运算符，原有的共享状态按析构处理
+ * @param {TaskPromise} &&other: 被移动的 promise
+ * @return {TaskPromise&} *this
+ */
+template <typename T>
+inline TaskPromise<T> &TaskPromise<T>::operator=(TaskPromise &&other) noexcept {
+	if (this != &other) {
+		TaskPromise discarded(std::move(*this));
+		m_state = other.m_state;
+		m_retrieved = other.m_retrieved;
+		m_satisfied = other.m_satisfied;
+		other.m_state = nullptr;
+	}
+	return *this;
+}
+
+
+/**
+ * @description: 析构函数，未写入结果时以 broken_promise 异常完成
+ */
+template <typename T>
+inline TaskPromise<T>::~TaskPromise() {
+	if (!m_state) {
+		return;
+	}
+	if (!m_satisfied) {
+		m_state->fail(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+	}
+	m_state->release();
+}
+
+
+/**
+ * @description: 取出 future
+ * @return {TaskFuture<T>} 与本 promise 共享状态的 future
+ */
+template <typename T>
+inline TaskFuture<T> TaskPromise<T>::getFuture() {
+	if (!m_state) {
+		throw std::future_error(std::future_errc::no_state);
+	}
+	if (m_retrieved) {
+		throw std::future_error(std::future_errc::future_already_retrieved);
+	}
+	m_retrieved = true;
+	m_state->retain();
+	return TaskFuture<T>(m_state);
+}
+
+
+/**
+ * @description: 检查是否还可以写入结果
+ */
+template <typename T>
+inline void TaskPromise<T>::checkSatisfiable() {
+	if (!m_state) {
+		throw std::future_error(std::future_errc::no_state);
+	}
+	if (m_satisfied) {
+		throw std::future_error(std::future_errc::promise_already_satisfied);
+	}
+}
+
+
+/**
+ * @description: 写入结果，唤醒等待者并执行后续任务
+ * @description: 结果构造抛出异常时 promise 保持未完成，可以再写入异常
+ * @param {U &&...} value: 结果，T 为 void 时不带参数
+ */
+template <typename T>
+template <typename... U>
+inline void TaskPromise<T>::setValue(U &&... value) {
+	checkSatisfiable();
+	m_state->store(std::forward<U>(value)...);
+	m_satisfied = true;
+	m_state->complete();
+}
+
+
+/**
+ * @description: 写入异常，唤醒等待者并执行后续任务
+ * @param {std::exception_ptr} exception: 异常
+ */
+template <typename T>
+inline void TaskPromise<T>::setException(std::exception_ptr exception) {
+	checkSatisfiable();
+	m_satisfied = true;
+	m_state->fail(exception);
+}
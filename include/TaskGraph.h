@@ -0,0 +1,102 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 13:02:17
+ * @last_edit_time: 2026-10-19 16:42:13
+ * @file_path: /Thread-Pool/include/TaskGraph.h
+ * @description: 任务依赖图 (DAG) 头文件，一次声明节点与依赖，之后可以在线程池上反复执行
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ThreadPool.h"
+
+
+/**
+ * @description: 任务依赖图
+ * @description: addNode 添加节点，addEdge(from, to) 表示 to 依赖 from；第一次执行 (或修改图之后) 时检查是否有环，并计算每个节点到终点的关键路径长度
+ * @description: 执行时每个节点持有一个原子的剩余依赖计数，前驱完成时减一，减到 0 的节点就绪：
+ * @description: 关键路径最长的就绪后继由完成前驱的线程直接接着执行，不经过任务队列；其余就绪后继按关键路径长度映射到线程池的优先级后提交，关键路径越长优先级越高
+ * @description: 提交的节点进入共享的任务队列，由任意工作线程执行；只有工作窃取模式下由工作线程提交的节点进入该线程自己的双端队列，通常由它接着执行
+ * @description: 节点函数可以被执行多次，因此不能在执行时移走自己捕获的资源；同一个图同一时间只能执行一次
+ */
+class TaskGraph {
+private:
+	/* 节点 */
+	struct Node {
+		Task m_func;  // 节点函数，每次执行都会调用
+		size_t m_cost;  // 估计的执行代价，用于计算关键路径
+		size_t m_predecessors;  // 前驱数量
+		size_t m_rank;  // 从本节点到终点的关键路径长度 (含本节点)
+		std::vector<size_t> m_successors;  // 后继节点
+	};
+
+	std::vector<Node> m_nodes;  // 所有节点
+	std::vector<size_t> m_roots;  // 没有前驱的节点，检查图时计算
+	size_t m_max_rank = 0;  // 最长的关键路径
+	bool m_prepared = false;  // 检查图之后是否被修改过
+
+	/* 本次执行的状态，同一时间只有一次执行 */
+	std::unique_ptr<std::atomic<size_t>[]> m_pending;  // 每个节点剩余的依赖数量
+	std::atomic<size_t> m_remaining;  // 尚未完成的节点数量，减到 0 时本次执行结束
+	std::atomic_bool m_running;  // 是否正在执行
+	std::mutex m_mutex;  // 与 m_finished 配合，析构时等待本次执行结束
+	std::condition_variable m_finished;  // 本次执行结束时通知
+	std::atomic_bool m_failed;  // 是否有节点抛出异常，之后的节点不再调用节点函数
+	std::exception_ptr m_exception;  // 第一个节点抛出的异常
+	TaskPromise<void> m_promise;  // 本次执行的结果
+	ThreadPool* m_pool = nullptr;  // 执行所在的线程池
+	size_t m_priority = 0;  // 关键路径最长的节点使用的优先级
+	size_t m_levels = 1;  // 使用的优先级数量
+
+	void prepare();  // 检查是否有环，计算根节点与关键路径
+	void checkIdle() const;  // 正在执行时不允许修改图
+	size_t priorityOf(size_t) const;  // 节点提交时使用的优先级
+	void schedule(size_t, std::vector<size_t> &);  // 提交就绪节点，任务队列已满时放入当前线程的待执行列表
+	void execute(size_t);  // 执行节点，并沿关键路径继续执行就绪的后继与未能提交的节点
+	void finish();  // 最后一个节点完成时结束本次执行
+
+public:
+	TaskGraph();
+	TaskGraph(const TaskGraph &) = delete;
+	TaskGraph &operator=(const TaskGraph &) = delete;
+	~TaskGraph();
+
+	template <typename Func>
+	size_t addNode(Func &&func, size_t cost = 1);  // 添加节点，返回节点编号
+	void addEdge(size_t from, size_t to);  // 添加依赖，to 在 from 完成后才执行
+	size_t size() const { return m_nodes.size(); }  // 节点数量
+	size_t criticalPath();  // 最长的关键路径长度 (代价之和)
+
+	TaskFuture<void> runAsync(ThreadPool &pool);  // 以线程池默认优先级开始执行，所有节点完成时 future 就绪
+	TaskFuture<void> runAsync(ThreadPool &pool, size_t priority);  // 开始执行，关键路径最长的节点使用 priority
+	void run(ThreadPool &pool);  // 执行并等待完成，节点抛出的第一个异常在这里重新抛出
+	void run(ThreadPool &pool, size_t priority);  // 执行并等待完成
+};
+
+
+/**
+ * @description: 添加节点
+ * @param {Func} &&func: 无参节点函数，被移动（或拷贝）进图中，每次执行图时调用一次
+ * @param {size_t} cost: 估计的执行代价，默认为 1，只影响优先级
+ * @return {size_t} 节点编号，从 0 开始连续分配
+ */
+template <typename Func>
+inline size_t TaskGraph::addNode(Func &&func, size_t cost) {
+	checkIdle();
+
+	Node node;
+	node.m_func = Task(std::forward<Func>(func));
+	node.m_cost = cost;
+	node.m_predecessors = 0;
+	node.m_rank = 0;
+	m_nodes.push_back(std::move(node));
+	m_prepared = false;
+
+	return m_nodes.size() - 1;
+}
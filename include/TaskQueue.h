@@ -0,0 +1,74 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 11:02:18
+ * @last_edit_time: 2026-10-17 23:16:42
+ * @file_path: /Thread-Pool/include/TaskQueue.h
+ * @description: 任务队列接口
+ */
+
+#pragma once
+#include <cstddef>
+#include "Task.h"
+
+
+/**
+ * @description: 任务队列工作模式
+ * @description: HEAP 表示基于堆结构的优先级队列
+ * @description: FIFO 表示无锁有界环形队列，忽略任务优先级，按提交顺序执行
+ * @description: BUCKET 表示分桶优先级队列，优先级范围有限，入队出队 O(1)，同一优先级内按提交顺序执行
+ * @description: DARY_HEAP 表示间接 4 叉堆优先级队列，优先级范围不受限，调整堆时只移动 8 字节的键
+ */
+enum class TaskQueueMode : char {
+	HEAP,
+	FIFO,
+	BUCKET,
+	DARY_HEAP
+};
+
+
+/**
+ * @description: 任务队列接口，线程池通过该接口使用不同实现的任务队列
+ */
+class TaskQueue {
+public:
+	virtual ~TaskQueue() = default;
+
+	/* 成员函数 */
+	virtual bool empty() = 0;  // 队列是否为空
+	virtual size_t size() = 0;  // 任务队列大小
+	virtual bool taskEnqueue(Task &, size_t, size_t) = 0;  // 添加任务，成功时任务被移走，队列已达上限时返回 false 且任务保持不变
+	virtual bool taskDequeue(Task &) = 0;  // 取出任务
+	virtual size_t taskEnqueueBatch(Task *, size_t, size_t, size_t);  // 批量添加任务，返回成功入队的数量
+	virtual bool taskReplaceLowest(Task &, size_t, Task &);  // 用新任务替换优先级最低的任务，队列不支持或没有更低优先级的任务时返回 false
+};
+
+
+/**
+ * @description: 批量添加任务，默认逐个入队，直到全部入队或队列已满
+ * @param {Task*} tasks: 任务数组，入队的任务被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 任务队列上限
+ * @return {size_t} 成功入队的任务数量，入队的总是前若干个任务
+ */
+inline size_t TaskQueue::taskEnqueueBatch(Task *tasks, size_t count, size_t priority, size_t max_size) {
+	size_t enqueued = 0;
+	while (enqueued < count && taskEnqueue(tasks[enqueued], priority, max_size)) {
+		++enqueued;
+	}
+	return enqueued;
+}
+
+
+/**
+ * @description: 用新任务替换队列中优先级最低的任务，默认不支持
+ * @param {Task&} task: 新任务，替换成功时被移走
+ * @param {size_t} priority: 新任务优先级
+ * @param {Task&} victim: 存放被替换出的任务
+ * @return {bool} 替换成功返回 true
+ */
+inline bool TaskQueue::taskReplaceLowest(Task &, size_t, Task &) {
+	return false;
+}
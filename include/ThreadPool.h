@@ -3,7 +3,7 @@
  * @github: https://github.com/yuyuyuj1e
  * @csdn: https://blog.csdn.net/yuyuyuj1e
  * @date: 2022-11-10 18:17:23
- * @last_edit_time: 2023-04-14 14:51:13
+ * @last_edit_time: 2026-10-20 10:12:35
  * @file_path: /Thread-Pool/include/ThreadPool.h
  * @description: 线程池模块头文件 
  */
@@ -22,7 +22,20 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
+#include <iterator>
+#include "Task.h"
+#include "TaskFuture.h"
+#include "ParallelLoop.h"
+#include "GroupTable.h"
+#include "Trace.h"
 #include "HeapSafeQueue.h"
+#include "RingSafeQueue.h"
+#include "BucketSafeQueue.h"
+#include "DaryHeapSafeQueue.h"
+#include "NumaSafeQueue.h"
+#include "WorkStealingDeque.h"
+#include "Affinity.h"
 #include "CppLog.h"
 
 
@@ -38,65 +51,270 @@ enum class ThreadPoolWorkMode : char {
 };
 
 
+/** 
+ * @description: 拒绝策略，任务队列已满且等待超过 timeout 后执行
+ * @description: BLOCK 表示一直等待，直到任务入队或线程池关闭，不会超时
+ * @description: THROW 表示抛出 std::runtime_error；批量提交时已入队的任务仍会执行，但 future 随异常一起丢失
+ * @description: DISCARD_NEWEST 表示丢弃新提交的任务，其 future 得到 broken_promise 异常
+ * @description: DISCARD_OLDEST 表示丢弃最早提交的任务，新任务入队；只适用于 FIFO 任务队列，优先级队列的队首是优先级最高的任务，按 DISCARD_LOWEST 处理
+ * @description: DISCARD_LOWEST 表示新任务替换队列中优先级最低的任务，新任务优先级最低或队列不支持 (FIFO) 时丢弃新任务
+ * @description: CALLER_RUNS 表示由提交任务的线程直接执行，自然地减慢提交速度
+ */
+enum class RejectPolicy : char {
+	BLOCK,
+	THROW,
+	DISCARD_NEWEST,
+	DISCARD_OLDEST,
+	DISCARD_LOWEST,
+	CALLER_RUNS
+};
+
+
+/** 
+ * @description: 工作线程空闲策略
+ * @description: PARK 表示没有任务时立即休眠，等待提交者唤醒
+ * @description: SPIN 表示先自旋 (pause)，再让出 CPU (yield)，仍然没有任务才休眠；自旋次数根据任务到达间隔自适应调整
+ */
+enum class IdleStrategy : char {
+	PARK,
+	SPIN
+};
+
+
+/** 
+ * @description: 工作线程空闲统计
+ */
+struct IdleStatistics {
+	size_t m_spin_hits;  // 自旋阶段取到任务的次数
+	size_t m_yield_hits;  // 让出 CPU 阶段取到任务的次数
+	size_t m_parks;  // 真正休眠的次数
+	size_t avoidedWakeups() const { return m_spin_hits + m_yield_hits; }  // 避免的唤醒次数
+};
+
+
+/** 
+ * @description: 扩缩容线程最近一次采样的结果
+ */
+struct ScalingStatistics {
+	size_t m_threads;  // 工作线程数量
+	size_t m_pending;  // 等待执行的任务数量
+	double m_busy_ratio;  // 正在工作的线程比例
+	double m_arrival_rate;  // 任务到达速率 (个/秒)
+	double m_queue_wait;  // 估计的任务排队时长 (毫秒)，由 排队数量 / 到达速率 得到
+	size_t m_reserved;  // 停放在后备池中的线程数量
+	size_t m_spawned;  // 创建线程的次数
+	size_t m_revived;  // 从后备池唤醒线程的次数
+	size_t m_reaped;  // 后备池中停放过久而被回收的线程数量
+};
+
+
 struct ThreadPoolConfig {
 	/* 线程池相关设置 */
 	ThreadPoolWorkMode m_mode;  // 线程池的工作模式
+	bool m_work_stealing;  // 是否启用工作窃取调度
 	std::chrono::milliseconds m_timeout;  // 超时时长
+	RejectPolicy m_reject_policy;  // 拒绝策略，需持有线程池锁读写
 	size_t m_priority_level;  // 任务优先级等级
 
 	/* 任务队列 */
-	size_t m_max_task;  // 最大任务量
+	TaskQueueMode m_queue_mode;  // 任务队列的工作模式
+	size_t m_priority_buckets;  // BUCKET 模式下的优先级数量
+	bool m_numa_queues;  // 是否每个 NUMA 节点使用一个任务队列
+	std::atomic<size_t> m_max_task;  // 最大任务量，提交任务时不加线程池锁读取
+
+	/* 提交缓冲区 */
+	size_t m_submit_buffer_size;  // 每个提交线程缓冲的任务数量上限，达到后批量入队
+	std::chrono::microseconds m_submit_buffer_delay;  // 任务在缓冲区中停留的最长时间
 
 	/* 工作线程 */
+	IdleStrategy m_idle_strategy;  // 空闲策略
+	size_t m_spin_count;  // SPIN 策略下每次空闲自旋次数的上限
+	size_t m_yield_count;  // SPIN 策略下自旋之后让出 CPU 的次数
 	size_t m_max_threshold;  // 线程上限
 	size_t m_min_threshold;  // 线程下限
+	AffinityPolicy m_affinity;  // 工作线程绑定 CPU 的方式
+	std::vector<int> m_cpu_list;  // LIST 方式下依次绑定的 CPU
+
+	/* 扩缩容，只在 MUTABLE_THREAD 模式下生效 */
+	std::chrono::milliseconds m_scale_interval;  // 采样间隔
+	std::chrono::milliseconds m_grow_timeout;  // 持续过载多久后开始增加线程
+	std::chrono::milliseconds m_shrink_timeout;  // 持续空闲多久后减少一个线程
+	double m_grow_utilization;  // 繁忙比例不低于该值且排队过久时视为过载
+	double m_shrink_utilization;  // 繁忙比例不高于该值时视为空闲，与 m_grow_utilization 之间的区间用于防止来回扩缩
+	std::chrono::milliseconds m_target_queue_wait;  // 可接受的任务排队时长
+	std::chrono::milliseconds m_reserve_timeout;  // 线程在后备池中停放超过该时长后被回收
 };
 
 
+class ScheduleAwaiter;  // 协程切换到线程池的等待对象，定义在 CoTask.h
+
+
 /** 
  * @description: 线程池类
  * @description: 线程池类负责维护线程池队列（创建/删除子线程），维护任务队列（任务的提交）
  */
 class ThreadPool {
+	friend class FutureCore;  // 提交后续任务、等待时帮助执行任务
+	friend class TaskGraph;  // 提交就绪节点，读取优先级数量
+	friend class ScheduleAwaiter;  // 协程切换到线程池时提交恢复任务
+
 private:
 	/* 配置文件 */
 	ThreadPoolConfig* m_config = nullptr;
 
 	/* 线程池相关设置 */
 	int m_thread_id = 1;  // 线程 id，用于传递给工作线程使用
-	bool m_start = false; // 线程池启动标志
-	std::mutex m_mutex; // 互斥锁
+	std::atomic_bool m_start; // 线程池启动标志
+	std::mutex m_mutex; // 互斥锁，只在线程休眠、唤醒、增删线程时使用
 
 	/* 任务队列 */
-	HeapSafeQueue m_queue; // 函数任务队列
+	std::unique_ptr<TaskQueue> m_queue; // 函数任务队列，工作窃取模式下作为全局注入队列
 	std::condition_variable m_queue_not_full;  // 任务已满
 	std::condition_variable m_queue_not_empty; // 任务为空
+	std::atomic_int m_idle_threads;  // 正在休眠等待任务的线程数量
+	std::atomic_int m_blocked_submitters;  // 因任务队列已满而等待的提交者数量
+	std::atomic_int m_blocked_helpers;  // 在 TaskFuture 中阻塞等待结果的工作线程数量，有新任务时唤醒其帮助执行
+	std::atomic_int m_submitting;  // 正在提交 (已通过关闭检查、尚未完成入队) 的提交者数量，关闭线程池时等待其归零
+
+	/* 静止等待 */
+	std::atomic<size_t> m_unfinished;  // 已入队 (或正在入队) 但尚未执行完、也未被丢弃的任务数量
+	std::atomic_int m_idle_waiters;  // 在 waitIdle 中等待的线程数量
+	std::condition_variable m_tasks_done;  // 所有任务执行完毕，需持有 m_mutex
+	std::atomic_bool m_stop_now;  // shutdownNow 要求工作线程执行完当前任务后立即退出
+
+	/* 空闲统计 */
+	std::atomic<size_t> m_spin_hits;  // 自旋阶段取到任务的次数
+	std::atomic<size_t> m_yield_hits;  // 让出 CPU 阶段取到任务的次数
+	std::atomic<size_t> m_parks;  // 工作线程休眠的次数
+
+	/* 扩缩容 */
+	std::thread m_scaler;  // 扩缩容线程，只在 MUTABLE_THREAD 模式下启动
+	std::condition_variable m_scale_cv;  // 用于唤醒、停止扩缩容线程
+	std::atomic<size_t> m_submitted;  // 已入队的任务数量，用于计算到达速率，提交失败的任务不计入
+	size_t m_retire_requests = 0;  // 扩缩容线程要求退出的线程数量，需持有 m_mutex
+	ScalingStatistics m_scaling_statistics = ScalingStatistics();  // 最近一次采样的结果，需持有 m_mutex
+
+	/* 工作窃取 */
+	using LocalDeque = WorkStealingDeque<Task*>;
+	std::vector<std::unique_ptr<LocalDeque>> m_deques;  // 每个工作线程槽位独占的双端队列
+	std::vector<int> m_free_slots;  // 空闲的工作线程槽位
+	static thread_local ThreadPool* m_local_pool;  // 当前线程所属的线程池，非工作线程为 nullptr
+	static thread_local int m_local_slot;  // 当前工作线程的槽位
+
+	/* CPU 亲和性 */
+	std::vector<int> m_slot_cpus;  // 每个槽位绑定的 CPU，不绑定为 -1，启动时一次计算
+	std::vector<int> m_slot_nodes;  // 每个槽位所在的 NUMA 节点，不绑定为 -1
+
+	/* 提交缓冲区 */
+	struct SubmitBuffer;  // 每个提交线程独占的缓冲区
+	class SubmitScope;  // 提交期间计入 m_submitting
+	struct LocalSubmitBuffers;  // 当前线程持有的所有缓冲区，线程退出时全部入队
+	std::vector<std::shared_ptr<SubmitBuffer>> m_submit_buffers;  // 已注册的缓冲区
+	std::mutex m_buffer_mutex;  // 缓冲区注册表互斥锁
+	std::condition_variable m_flush_cv;  // 用于唤醒、停止定时入队线程
+	std::mutex m_flushing_mutex;  // 定时入队线程取出任务到入队或放回期间持有，将所有缓冲区入队时据此等待
+	std::thread m_flusher;  // 定时入队线程，第一次使用缓冲区时启动
+	bool m_flusher_stop = false;  // 定时入队线程停止标志
+	size_t m_flush_generation = 0;  // 缓冲区由空变为非空的次数，用于唤醒定时入队线程
+	static thread_local LocalSubmitBuffers m_local_buffers;  // 当前线程持有的缓冲区
 
 	/* 日志 */
 	CppLog* m_log = CppLog::getInstance();
+	std::function<void(std::exception_ptr)> m_exception_handler;  // 任务抛出未处理异常时的回调
 
 	/* 工作线程 */
-	std::unordered_map<int, std::thread> m_threads;  // 线程队列
-	std::atomic_int m_thread_amount;  // 线程数量
+	struct WorkerSlot {
+		std::thread m_thread;  // 槽位上的线程，为空表示槽位未使用
+		std::condition_variable m_revive;  // 停放线程的唤醒信号，需持有 m_mutex
+		bool m_parked = false;  // 是否停放在后备池中
+		bool m_stop = false;  // 停放过久，要求线程退出
+		std::chrono::steady_clock::time_point m_parked_since;  // 开始停放的时间
+	};
+	std::vector<std::unique_ptr<WorkerSlot>> m_slots;  // 工作线程槽位，数量即线程上限，启动时一次分配
+	std::vector<int> m_reserve;  // 后备池，停放中的线程槽位，按停放时间先后排列
+	std::atomic_int m_thread_amount;  // 线程数量，不含后备池中的线程
+	size_t m_spawned = 0;  // 创建线程的次数，需持有 m_mutex
+	size_t m_revived = 0;  // 从后备池唤醒线程的次数，需持有 m_mutex
+	size_t m_reaped = 0;  // 回收后备池线程的次数，需持有 m_mutex
 
 
 	/* 工作线程类 */
 	class Worker {
 	private:
 		int m_id; // 工作 id
+		int m_slot;  // 工作线程槽位，工作窃取模式下对应自己的双端队列
+		unsigned m_seed;  // 随机选择窃取对象的种子
+		std::chrono::nanoseconds m_idle_gap;  // 空闲时长 (任务到达间隔) 的滑动平均，决定自旋时长
+		std::chrono::nanoseconds m_spin_span;  // 自旋 spin_count 次的耗时，第一次自旋到上限时测得
 		ThreadPool *m_pool; // 所属线程池
 
+		bool fetchTask(Task &);  // 依次从本地队列、全局队列、其他线程队列获取任务
+		bool stealTask(Task &);  // 从随机选择的其他线程窃取任务
+		bool spinForTask(Task &, std::chrono::steady_clock::time_point);  // 休眠前先自旋、让出 CPU 等待任务
+		void recordIdleGap(std::chrono::steady_clock::time_point);  // 记录一次空闲时长，更新滑动平均
+		bool park(std::unique_lock<std::mutex> &);  // 停放到后备池，等待唤醒
+		void execute(Task &);  // 执行任务并计入完成数量
+
 	public:
-		Worker(ThreadPool*, const int);  // 含参构造函数
+		Worker(ThreadPool*, const int, const int);  // 含参构造函数
 		void operator()();  // 重载()，仿函数
+		bool helpOnce();  // 取出并执行一个任务，用于等待 TaskFuture 时帮助执行
 	};
+	static thread_local Worker* m_local_worker;  // 当前线程对应的工作线程对象，非工作线程为 nullptr
 
 
 private:
 void initThreadPool();  // 初始化线程池
+TaskQueue* createTaskQueue();  // 按 task_queue 创建任务队列
+void bindWorker(int);  // 将当前工作线程绑定到槽位对应的 CPU
 bool parseConfig(std::string);  // 解析线程池配置文件
+bool addWorker();  // 添加一个工作线程，优先唤醒后备池中的线程，需持有 m_mutex
+void reapReserve(std::unique_lock<std::mutex> &);  // 回收后备池中停放过久的线程，需持有 m_mutex
+bool hasPendingTask();  // 是否还有未执行的任务
+void throwIfClosed();  // 线程池已经关闭时拒绝提交任务
+bool tryEnqueue(Task &, size_t);  // 不等待地入队 (工作窃取模式下工作线程放入自己的双端队列)，并唤醒工作线程
+void enqueueTask(Task &, size_t);  // 任务入队，并唤醒工作线程
+void enqueueBatch(Task *, size_t, size_t);  // 批量任务入队，并唤醒工作线程
+size_t enqueueBlocking(Task *, size_t, size_t);  // 任务队列已满时加锁等待入队
+bool enqueueUntil(Task &, size_t, std::chrono::steady_clock::time_point);  // 任务入队，任务队列已满时最多等待到截止时间
+size_t waitEnqueue(std::unique_lock<std::mutex> &, Task *, size_t, size_t, std::chrono::steady_clock::time_point);  // 持有线程池锁，等待任务队列空出位置并入队
+template <typename Rep, typename Period>
+static std::chrono::steady_clock::time_point deadlineAfter(const std::chrono::duration<Rep, Period> &);  // 当前时间加上等待时长，溢出时取 time_point::max()
+template <typename Func, typename... Args>
+auto submitBefore(size_t, std::chrono::steady_clock::time_point, Func &&, Args &&...) -> std::future<TaskResult<Func, Args...>>;  // 在截止时间前提交，超时返回空 future
+void rejectTasks(Task *, size_t, size_t, RejectPolicy);  // 对超时未入队的任务执行拒绝策略
+void wakeWorker(size_t count = 1);  // 有线程休眠时唤醒线程
+void handleException(std::exception_ptr);  // 处理任务抛出的未处理异常
+SubmitBuffer* localSubmitBuffer();  // 获取当前线程在本线程池的提交缓冲区，第一次使用时注册
+void bufferTask(Task &, size_t);  // 任务放入当前线程的提交缓冲区
+void flushSubmitBuffer(SubmitBuffer &, std::unique_lock<std::mutex> &);  // 取出缓冲区中的任务，释放缓冲区锁后批量入队
+void enqueueBuffered(std::vector<Task> &, std::vector<size_t> &);  // 从缓冲区取出的任务批量入队
+bool flushExpiredBuffer(SubmitBuffer &, std::chrono::steady_clock::time_point);  // 定时入队线程不等待地入队停留过久的任务，失败时放回
+void flushAllSubmitBuffers(bool);  // 将所有缓冲区中的任务入队
+void flushing();  // 定时入队线程的工作函数
+void scaling();  // 扩缩容线程的工作函数
+void notifySubmitters();  // 有提交者等待时通知其任务队列未满
+static inline Task* newLocalTask(Task &);  // 为工作窃取双端队列创建任务节点，从 TaskArena 分配
+static inline void deleteLocalTask(Task*);  // 释放工作窃取双端队列的任务节点
+void finishTasks(size_t count = 1);  // 任务执行完毕或被丢弃，全部完成时唤醒 waitIdle
+void stopThreads();  // 停止扩缩容线程，唤醒并等待所有工作线程退出
+void waitSubmitters();  // 关闭线程池时等待正在提交的任务入队或放弃
+bool runPendingTask();  // 当前工作线程帮助执行一个任务，没有任务时返回 false
+size_t loopParticipants(size_t, size_t &);  // 并行循环的参与者数量，grain 为 0 时自动选择
+template <typename Body>
+void runLoop(size_t, size_t, size_t, LoopSchedule, Body &);  // 调用线程与帮助任务一起分块执行 body(first, last, participant)
+template <typename Iterator, typename Compare>
+void sortRange(Iterator, Iterator, Compare &, bool);  // 分块排序后逐轮并行归并
+template <typename Source, typename Target, typename Compare>
+void mergeRuns(Source, Target, size_t, size_t, size_t, Compare &);  // 将相邻两个有序段并行归并到 target
+static size_t scanChunk(size_t);  // 前缀和每块的元素数量，按二级缓存大小选择
+template <typename Iterator, typename Output, typename T, typename Combine>
+Output scanRange(Iterator, Iterator, Output, const T *, Combine &, size_t);  // 两遍分块前缀和，init 为空时为包含式
 
 public:
+	template <typename T>
+	using Allocator = TaskAllocator<T>;  // 线程池使用的分配器，线程私有、支持跨线程释放
+
 	/* 构造函数与析构函数 */
 	ThreadPool();  // 默认构造函数
 	ThreadPool(const std::string);  // 含参构造函数
@@ -108,11 +326,83 @@ public:
 
 	/* 成员函数 */	
 	void close();  // 关闭线程池
+	std::vector<Task> shutdownNow();  // 立即关闭线程池，返回尚未执行的任务
+	void waitIdle();  // 等待已提交的任务全部执行完毕，不关闭线程池
 
 	template <typename Func, typename... Args>
-	auto submitTask(size_t proity, Func &&f, Args &&...args) -> std::future<decltype(f(args...))>;  // 提交异步执行的函数
+	auto submitTask(size_t proity, Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 提交异步执行的函数
+	template <typename Func, typename... Args>
+	auto submitTask(Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 提交异步执行的函数
+	template <typename Func, typename... Args>
+	auto trySubmit(size_t proity, Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 不阻塞地提交，任务队列已满时返回空 future
+	template <typename Func, typename... Args>
+	auto trySubmit(Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 不阻塞地提交，任务队列已满时返回空 future
+	template <typename Rep, typename Period, typename Func, typename... Args>
+	auto submitFor(size_t proity, const std::chrono::duration<Rep, Period> &timeout, Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 最多等待 timeout，超时返回空 future
+	template <typename Rep, typename Period, typename Func, typename... Args>
+	auto submitFor(const std::chrono::duration<Rep, Period> &timeout, Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 最多等待 timeout，超时返回空 future
+	template <typename Clock, typename Duration, typename Func, typename... Args>
+	auto submitUntil(size_t proity, const std::chrono::time_point<Clock, Duration> &deadline, Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 最多等待到 deadline，超时返回空 future
+	template <typename Clock, typename Duration, typename Func, typename... Args>
+	auto submitUntil(const std::chrono::time_point<Clock, Duration> &deadline, Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 最多等待到 deadline，超时返回空 future
+	template <typename Func, typename... Args>
+	auto submitAsync(size_t proity, Func &&f, Args &&...args) -> TaskFuture<TaskResult<Func, Args...>>;  // 提交异步执行的函数，返回可以设置后续任务的 TaskFuture
+	template <typename Func, typename... Args>
+	auto submitAsync(Func &&f, Args &&...args) -> TaskFuture<TaskResult<Func, Args...>>;  // 提交异步执行的函数，返回可以设置后续任务的 TaskFuture
+	template <typename Func, typename... Args>
+	auto post(size_t proity, Func &&f, Args &&...args) -> TaskVoid<Func, Args...>;  // 提交不需要返回结果的函数
 	template <typename Func, typename... Args>
-	auto submitTask(Func &&f, Args &&...args) -> std::future<decltype(f(args...))>;  // 提交异步执行的函数
+	auto post(Func &&f, Args &&...args) -> TaskVoid<Func, Args...>;  // 提交不需要返回结果的函数
+	template <typename Func, typename... Args>
+	auto submitBuffered(size_t proity, Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 通过当前线程的缓冲区提交
+	template <typename Func, typename... Args>
+	auto submitBuffered(Func &&f, Args &&...args) -> std::future<TaskResult<Func, Args...>>;  // 通过当前线程的缓冲区提交
+	template <typename Func, typename... Args>
+	auto postBuffered(size_t proity, Func &&f, Args &&...args) -> TaskVoid<Func, Args...>;  // 通过当前线程的缓冲区提交不需要返回结果的函数
+	template <typename Func, typename... Args>
+	auto postBuffered(Func &&f, Args &&...args) -> TaskVoid<Func, Args...>;  // 通过当前线程的缓冲区提交不需要返回结果的函数
+	void flush();  // 将当前线程缓冲区中的任务全部入队
+	template <typename Iterator>
+	auto submitBatch(size_t proity, Iterator first, Iterator last) -> std::vector<std::future<TaskResult<typename std::iterator_traits<Iterator>::value_type>>>;  // 批量提交无参函数
+	template <typename Iterator>
+	auto submitBatch(Iterator first, Iterator last) -> std::vector<std::future<TaskResult<typename std::iterator_traits<Iterator>::value_type>>>;  // 批量提交无参函数
+	template <typename Func>
+	auto submitBulk(size_t proity, size_t n, Func &&f) -> std::vector<std::future<TaskResult<Func, size_t>>>;  // 批量提交 f(0) ... f(n - 1)
+	template <typename Func>
+	auto submitBulk(size_t n, Func &&f) -> std::vector<std::future<TaskResult<Func, size_t>>>;  // 批量提交 f(0) ... f(n - 1)
+
+	template <typename Index, typename Func>
+	void parallelFor(Index begin, Index end, size_t grain, Func &&func, LoopSchedule schedule = LoopSchedule::GUIDED);  // 并行执行 func(begin) ... func(end - 1)
+	template <typename Index, typename Func>
+	void parallelFor(Index begin, Index end, Func &&func, LoopSchedule schedule = LoopSchedule::GUIDED);  // 并行执行 func(begin) ... func(end - 1)，自动选择块大小
+	template <typename Iterator, typename T, typename Combine>
+	T parallelReduce(Iterator first, Iterator last, T identity, Combine &&combine, size_t grain = 0);  // 并行归约 [first, last)
+	template <typename Iterator, typename T, typename Combine, typename Transform>
+	T transformReduce(Iterator first, Iterator last, T identity, Combine &&combine, Transform &&transform, size_t grain = 0);  // 并行归约 transform(*it)
+	template <typename Iterator, typename Compare>
+	void parallelSort(Iterator first, Iterator last, Compare comp);  // 并行排序，不保证相等元素的顺序
+	template <typename Iterator>
+	void parallelSort(Iterator first, Iterator last);  // 按 operator< 并行排序
+	template <typename Iterator, typename Compare>
+	void parallelStableSort(Iterator first, Iterator last, Compare comp);  // 并行稳定排序，相等元素保持原有顺序
+	template <typename Iterator>
+	void parallelStableSort(Iterator first, Iterator last);  // 按 operator< 并行稳定排序
+	template <typename Iterator, typename Output, typename Combine>
+	Output parallelInclusiveScan(Iterator first, Iterator last, Output out, Combine combine, size_t grain = 0);  // 并行包含式前缀和，out[i] 含第 i 个元素
+	template <typename Iterator, typename Output>
+	Output parallelInclusiveScan(Iterator first, Iterator last, Output out);  // 按 operator+ 并行包含式前缀和
+	template <typename Iterator, typename Output, typename T, typename Combine>
+	Output parallelExclusiveScan(Iterator first, Iterator last, Output out, T init, Combine combine, size_t grain = 0);  // 并行排除式前缀和，out[i] 不含第 i 个元素
+	template <typename Iterator, typename Output, typename T>
+	Output parallelExclusiveScan(Iterator first, Iterator last, Output out, T init);  // 按 operator+ 并行排除式前缀和
+	template <typename Iterator, typename KeyOf, typename ValueOf, typename Combine>
+	auto parallelGroupBy(Iterator first, Iterator last, KeyOf key_of, ValueOf value_of, Combine combine, size_t grain = 0)
+		-> std::vector<std::pair<GroupKey<Iterator, KeyOf>, GroupValue<Iterator, ValueOf>>>;  // 按 key_of 分组，组内用 combine 合并 value_of
+	template <typename Iterator, typename KeyOf, typename ValueOf, typename Combine, typename Hash, typename Equal>
+	auto parallelGroupBy(Iterator first, Iterator last, KeyOf key_of, ValueOf value_of, Combine combine, Hash hash, Equal equal, size_t grain = 0)
+		-> std::vector<std::pair<GroupKey<Iterator, KeyOf>, GroupValue<Iterator, ValueOf>>>;  // 指定键的哈希函数与相等比较
+	inline ScheduleAwaiter schedule();  // co_await pool.schedule() 切换到工作线程，需要包含 CoTask.h 并以 C++20 编译
+	inline ScheduleAwaiter schedule(size_t priority);  // 以指定优先级切换到工作线程
 
 	inline size_t getThreadsAmount();  // 获取线程数量
 	inline void setTaskMaxAmount(size_t);  // 设置任务量最大值
@@ -121,17 +411,85 @@ public:
 	inline void setTaskTimeoutBySeconds(std::chrono::seconds);  // 设置超时时长
 	inline size_t getTaskPriority();  // 获取任务优先级
 	inline void setTaskPriority(size_t);  // 设置任务优先级
+	void setExceptionHandler(std::function<void(std::exception_ptr)>);  // 设置未处理异常的回调
+	inline RejectPolicy getRejectPolicy();  // 获取拒绝策略
+	inline void setRejectPolicy(RejectPolicy);  // 设置拒绝策略
+	IdleStatistics getIdleStatistics();  // 获取工作线程空闲统计
+	ScalingStatistics getScalingStatistics();  // 获取扩缩容线程最近一次采样的结果
+	ArenaStatistics getArenaStatistics();  // 获取内存池统计，以及平均每个任务的分配次数与字节数
+	static inline void* allocate(size_t);  // 从当前线程的内存池分配
+	static inline void deallocate(void*);  // 释放 allocate 分配的内存，可以在任意线程释放
 };
 
 
 
 /**
- * @description: 获取线程池线程数量
- * @return {size_t} m_threads.size()
+ * @description: 从当前线程的内存池分配，超过 1KB 时改用 malloc
+ * @param {size_t} size: 字节数
+ * @return {void*} 按 max_align_t 对齐的内存
+ */
+inline void* ThreadPool::allocate(size_t size) {
+	return TaskArena::allocate(size);
+}
+
+
+/**
+ * @description: 释放 allocate 分配的内存，不是分配线程时经跨线程空闲链表归还
+ * @param {void*} p: 内存
+ */
+inline void ThreadPool::deallocate(void* p) {
+	TaskArena::deallocate(p);
+}
+
+
+/**
+ * @description: 为工作窃取双端队列创建任务节点，双端队列只保存指针
+ * @param {Task&} task: 任务函数，被移走
+ * @return {Task*} 任务节点
+ */
+inline Task* ThreadPool::newLocalTask(Task &task) {
+	return ::new (TaskArena::allocate(sizeof(Task))) Task(std::move(task));
+}
+
+
+/**
+ * @description: 释放工作窃取双端队列的任务节点，通常由窃取或执行任务的线程释放
+ * @param {Task*} task: 任务节点
+ */
+inline void ThreadPool::deleteLocalTask(Task* task) {
+	task->~Task();
+	TaskArena::deallocate(task);
+}
+
+
+
+/**
+ * @description: 获取线程池线程数量，不含后备池中停放的线程
+ * @return {size_t} m_thread_amount
  */
 inline size_t ThreadPool::getThreadsAmount() {
 	std::unique_lock<std::mutex> lock(m_mutex);
-	return m_threads.size();
+	return m_thread_amount;
+}
+
+
+/**
+ * @description: 获取拒绝策略
+ * @return {RejectPolicy} m_reject_policy
+ */
+inline RejectPolicy ThreadPool::getRejectPolicy() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_config->m_reject_policy;
+}
+
+
+/**
+ * @description: 设置拒绝策略，对之后被阻塞的提交生效
+ * @param {RejectPolicy} policy: 拒绝策略
+ */
+inline void ThreadPool::setRejectPolicy(RejectPolicy policy) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_config->m_reject_policy = policy;
 }
 
 
@@ -203,106 +561,940 @@ inline void ThreadPool::setTaskPriority(size_t priority) {
  * @description: 提交异步执行的函数
  * @param {Func} &: 任务函数
  * @param {Args &&...} args: 任务函数参数
- * @return {std::future<decltype(func(args...))>} 任务函数形成的 future
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future
  */
 template <typename Func, typename... Args>
-inline auto ThreadPool::submitTask(Func &&func, Args &&... args) -> std::future<decltype(func(args...))> {
+inline auto ThreadPool::submitTask(Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
 	return submitTask(m_config->m_priority_level, std::forward<Func>(func), std::forward<Args>(args)...);
 }
 
 
 /**
  * @description: 提交异步执行的函数
+ * @description: 任务函数与参数被移动进 PromiseTask，PromiseTask 再被移动进只可移动的 Task，全程不拷贝
+ * @description: promise 的共享状态与结果从当前线程的 TaskArena 分配，不经过全局 malloc
+ * @param {size_t} proity: 任务优先级
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数，支持 unique_ptr 等只可移动的参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::submitTask(size_t proity, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+
+	using func_renturn_type = TaskResult<Func, Args...>;
+
+	// 将任务函数和参数绑定，打包成无参函数，再与 promise 一起放入 Task；较小的任务函数直接保存在 Task 的内部缓冲区
+	std::future<func_renturn_type> return_future;
+	Task warpper_func = makePromiseTask(BoundTask<Func, Args...>(std::forward<Func>(func), std::forward<Args>(args)...), return_future);
+
+	// 任务入队
+	enqueueTask(warpper_func, proity);
+
+	return return_future;
+}
+
+
+/**
+ * @description: 计算等待 timeout 后的截止时间，在 timeout 的单位下与剩余可表示的时长比较，避免换算与相加溢出
+ * @param {std::chrono::duration<Rep, Period>} timeout: 等待时长
+ * @return {std::chrono::steady_clock::time_point} 截止时间；timeout 不大于 0 时为 time_point::min() (不等待)，超出可表示范围时为 time_point::max() (一直等待)
+ */
+template <typename Rep, typename Period>
+inline std::chrono::steady_clock::time_point ThreadPool::deadlineAfter(const std::chrono::duration<Rep, Period> &timeout) {
+	typedef std::chrono::steady_clock clock;
+
+	if (timeout <= std::chrono::duration<Rep, Period>::zero()) {
+		return clock::time_point::min();
+	}
+
+	clock::time_point now = clock::now();
+	if (timeout >= std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(clock::time_point::max() - now)) {
+		return clock::time_point::max();
+	}
+	return now + std::chrono::duration_cast<clock::duration>(timeout);
+}
+
+
+/**
+ * @description: 在截止时间前提交异步执行的函数，任务队列已满时最多等待到截止时间，不执行拒绝策略
  * @param {size_t} proity: 任务优先级
+ * @param {std::chrono::steady_clock::time_point} deadline: 截止时间，早于当前时间时不等待
  * @param {Func} &: 任务函数
  * @param {Args &&...} args: 任务函数参数
- * @return {std::future<decltype(func(args...))>} 任务函数形成的 future
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future，未能入队时为空 (valid() 为 false)
  */
 template <typename Func, typename... Args>
-inline auto ThreadPool::submitTask(size_t proity, Func &&func, Args &&... args) -> std::future<decltype(func(args...))> {
+inline auto ThreadPool::submitBefore(size_t proity, std::chrono::steady_clock::time_point deadline, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
 
-	// typename std::result_of<Func(Args...)>::type 等同于 decltype(func(args...))
-	using func_renturn_type = typename std::result_of<Func(Args...)>::type;
-	
-	// function<int(int, int)> new_func = bind(old_func, _1, _2);
-	// 将任务函数和参数绑定，打包成 func，先转换成无参函数
-	std::function<func_renturn_type()> nonparam_task_func = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
+	using func_renturn_type = TaskResult<Func, Args...>;
 
-	// 将任务函数（新打包的 func）封装进共享指针中，方便复制(被 lambda 函数值捕捉)
-	auto task_ptr = std::make_shared<std::packaged_task<func_renturn_type()>>(nonparam_task_func);
+	std::future<func_renturn_type> return_future;
+	Task warpper_func = makePromiseTask(BoundTask<Func, Args...>(std::forward<Func>(func), std::forward<Args>(args)...), return_future);
 
-	// 返回通过 packaged_task 打包的 future
-	auto return_future = (*task_ptr).get_future();
+	// 未能入队时任务被丢弃，返回空 future，而不是得到 broken_promise 的 future
+	if (!enqueueUntil(warpper_func, proity, deadline)) {
+		return std::future<func_renturn_type>();
+	}
 
+	return return_future;
+}
 
-	{
-		// 线程池加锁
-		std::unique_lock<std::mutex> lock(m_mutex);
 
-		// 将打包好的无参任务函数转换成 void 函数
-		std::function<void()> warpper_func = [task_ptr]() {
-			(*task_ptr)();  //  (*指针变量名) (函数参数列表)
-		};
+/**
+ * @description: 不阻塞地提交异步执行的函数
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future，任务队列已满时为空 (valid() 为 false)
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::trySubmit(Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+	return trySubmit(m_config->m_priority_level, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 不阻塞地提交异步执行的函数，任务队列已满时立即返回，不执行拒绝策略
+ * @description: C++11 没有 std::optional，以空 future 表示提交失败
+ * @param {size_t} proity: 任务优先级
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future，任务队列已满时为空 (valid() 为 false)
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::trySubmit(size_t proity, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+	return submitBefore(proity, std::chrono::steady_clock::time_point::min(), std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 提交异步执行的函数，任务队列已满时最多等待 timeout
+ * @param {std::chrono::duration<Rep, Period>} timeout: 本次提交的等待时长，代替线程池的 timeout 设置
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future，超时未入队时为空 (valid() 为 false)
+ */
+template <typename Rep, typename Period, typename Func, typename... Args>
+inline auto ThreadPool::submitFor(const std::chrono::duration<Rep, Period> &timeout, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+	return submitFor(m_config->m_priority_level, timeout, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 提交异步执行的函数，任务队列已满时最多等待 timeout，超时不执行拒绝策略
+ * @param {size_t} proity: 任务优先级
+ * @param {std::chrono::duration<Rep, Period>} timeout: 本次提交的等待时长，代替线程池的 timeout 设置
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future，超时未入队时为空 (valid() 为 false)
+ */
+template <typename Rep, typename Period, typename Func, typename... Args>
+inline auto ThreadPool::submitFor(size_t proity, const std::chrono::duration<Rep, Period> &timeout, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+	return submitBefore(proity, deadlineAfter(timeout), std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 提交异步执行的函数，任务队列已满时最多等待到 deadline
+ * @param {std::chrono::time_point<Clock, Duration>} deadline: 本次提交的截止时间
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future，超时未入队时为空 (valid() 为 false)
+ */
+template <typename Clock, typename Duration, typename Func, typename... Args>
+inline auto ThreadPool::submitUntil(const std::chrono::time_point<Clock, Duration> &deadline, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+	return submitUntil(m_config->m_priority_level, deadline, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 提交异步执行的函数，任务队列已满时最多等待到 deadline，超时不执行拒绝策略
+ * @description: 其他时钟的截止时间换算为 steady_clock，不受系统时间调整影响
+ * @param {size_t} proity: 任务优先级
+ * @param {std::chrono::time_point<Clock, Duration>} deadline: 本次提交的截止时间
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future，超时未入队时为空 (valid() 为 false)
+ */
+template <typename Clock, typename Duration, typename Func, typename... Args>
+inline auto ThreadPool::submitUntil(size_t proity, const std::chrono::time_point<Clock, Duration> &deadline, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+	typename Clock::time_point now = Clock::now();
+	std::chrono::steady_clock::time_point steady_deadline = deadline > now ? deadlineAfter(deadline - now) : std::chrono::steady_clock::time_point::min();
+	return submitBefore(proity, steady_deadline, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 提交异步执行的函数，返回线程池专用的 TaskFuture
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {TaskFuture<TaskResult<Func, Args...>>} 任务函数形成的 future
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::submitAsync(Func &&func, Args &&... args) -> TaskFuture<TaskResult<Func, Args...>> {
+	return submitAsync(m_config->m_priority_level, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 提交异步执行的函数，返回线程池专用的 TaskFuture
+ * @description: 共享状态不加锁，可以通过 then / onComplete 设置后续任务，后续任务沿用本任务的优先级提交到本线程池
+ * @description: 在本线程池的工作线程中 get 时，等待期间帮助执行其他任务，嵌套提交不会占满工作线程而死锁
+ * @param {size_t} proity: 任务优先级
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {TaskFuture<TaskResult<Func, Args...>>} 任务函数形成的 future
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::submitAsync(size_t proity, Func &&func, Args &&... args) -> TaskFuture<TaskResult<Func, Args...>> {
+
+	using func_renturn_type = TaskResult<Func, Args...>;
+
+	TaskFuture<func_renturn_type> return_future;
+	Task warpper_func = makeFutureTask(BoundTask<Func, Args...>(std::forward<Func>(func), std::forward<Args>(args)...), return_future, this, proity);
+
+	// 任务入队
+	enqueueTask(warpper_func, proity);
+
+	return return_future;
+}
+
+
+/**
+ * @description: 提交不需要返回结果的函数
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::post(Func &&func, Args &&... args) -> TaskVoid<Func, Args...> {
+	post(m_config->m_priority_level, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 提交不需要返回结果的函数
+ * @description: 不创建 promise 和 future，任务函数与参数直接保存在 Task 中，只有一次入队的开销
+ * @description: 任务函数的返回值被丢弃，抛出的异常交给 setExceptionHandler 设置的回调处理
+ * @param {size_t} proity: 任务优先级
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::post(size_t proity, Func &&func, Args &&... args) -> TaskVoid<Func, Args...> {
+	Task task(BoundTask<Func, Args...>(std::forward<Func>(func), std::forward<Args>(args)...));
+
+	// 任务入队
+	enqueueTask(task, proity);
+}
+
+
+/**
+ * @description: 批量提交无参函数，所有任务在一次加锁中入队
+ * @param {Iterator} first: 第一个任务函数的迭代器
+ * @param {Iterator} last: 最后一个任务函数之后的迭代器
+ * @return {std::vector<std::future<...>>} 与任务函数一一对应的 future
+ */
+template <typename Iterator>
+inline auto ThreadPool::submitBatch(Iterator first, Iterator last) -> std::vector<std::future<TaskResult<typename std::iterator_traits<Iterator>::value_type>>> {
+	return submitBatch(m_config->m_priority_level, first, last);
+}
+
 
-		// 如果线程池已经决定关闭，则不可再提交任务
-		if (!m_start) {
+/**
+ * @description: 批量提交无参函数，所有任务在一次加锁中入队
+ * @description: 堆结构的任务队列在追加数量较多时整体重新建堆，而不是逐个向上调整
+ * @param {size_t} proity: 任务优先级
+ * @param {Iterator} first: 第一个任务函数的迭代器，任务函数会被拷贝
+ * @param {Iterator} last: 最后一个任务函数之后的迭代器
+ * @return {std::vector<std::future<...>>} 与任务函数一一对应的 future
+ */
+template <typename Iterator>
+inline auto ThreadPool::submitBatch(size_t proity, Iterator first, Iterator last) -> std::vector<std::future<TaskResult<typename std::iterator_traits<Iterator>::value_type>>> {
+
+	using func_type = typename std::iterator_traits<Iterator>::value_type;
+	using func_renturn_type = TaskResult<func_type>;
 
-#ifdef DEBUG
-			std::cout << "线程池已被关闭，无法提交新任务";
-#else
-			m_log->addTask("线程池已被关闭，无法提交新任务");
-#endif
+	std::vector<std::future<func_renturn_type>> futures;
+	std::vector<Task> tasks;
+
+	size_t amount = std::distance(first, last);
+	futures.reserve(amount);
+	tasks.reserve(amount);
+
+	for (; first != last; ++first) {
+		std::future<func_renturn_type> future;
+		tasks.push_back(makePromiseTask(BoundTask<func_type>(*first), future));
+		futures.push_back(std::move(future));
+	}
+
+	// 任务入队
+	enqueueBatch(tasks.data(), tasks.size(), proity);
+
+	return futures;
+}
+
+
+/**
+ * @description: 批量提交 f(0) ... f(n - 1)
+ * @param {size_t} n: 任务数量
+ * @param {Func} &&f: 任务函数，参数为任务下标
+ * @return {std::vector<std::future<...>>} 与任务下标一一对应的 future
+ */
+template <typename Func>
+inline auto ThreadPool::submitBulk(size_t n, Func &&func) -> std::vector<std::future<TaskResult<Func, size_t>>> {
+	return submitBulk(m_config->m_priority_level, n, std::forward<Func>(func));
+}
+
+
+/**
+ * @description: 批量提交 f(0) ... f(n - 1)，所有任务在一次加锁中入队
+ * @param {size_t} proity: 任务优先级
+ * @param {size_t} n: 任务数量
+ * @param {Func} &&f: 任务函数，参数为任务下标，每个任务持有一份拷贝
+ * @return {std::vector<std::future<...>>} 与任务下标一一对应的 future
+ */
+template <typename Func>
+inline auto ThreadPool::submitBulk(size_t proity, size_t n, Func &&func) -> std::vector<std::future<TaskResult<Func, size_t>>> {
 
-			throw std::runtime_error("ThreadPool is already colsed");
+	using func_renturn_type = TaskResult<Func, size_t>;
+
+	std::vector<std::future<func_renturn_type>> futures;
+	std::vector<Task> tasks;
+	futures.reserve(n);
+	tasks.reserve(n);
+
+	for (size_t i = 0; i < n; ++i) {
+		std::future<func_renturn_type> future;
+		tasks.push_back(makePromiseTask(BoundTask<Func, size_t>(func, i), future));
+		futures.push_back(std::move(future));
+	}
+
+	// 任务入队
+	enqueueBatch(tasks.data(), tasks.size(), proity);
+
+	return futures;
+}
+
+
+/**
+ * @description: 通过当前线程的提交缓冲区提交异步执行的函数
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::submitBuffered(Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+	return submitBuffered(m_config->m_priority_level, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 通过当前线程的提交缓冲区提交异步执行的函数
+ * @description: 任务先放入当前线程独占的缓冲区，缓冲区满、调用 flush()、或停留超过 submit_buffer_delay 时批量入队
+ * @param {size_t} proity: 任务优先级
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<TaskResult<Func, Args...>>} 任务函数形成的 future
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::submitBuffered(size_t proity, Func &&func, Args &&... args) -> std::future<TaskResult<Func, Args...>> {
+
+	using func_renturn_type = TaskResult<Func, Args...>;
+
+	std::future<func_renturn_type> return_future;
+	Task warpper_func = makePromiseTask(BoundTask<Func, Args...>(std::forward<Func>(func), std::forward<Args>(args)...), return_future);
+
+	// 放入提交缓冲区
+	bufferTask(warpper_func, proity);
+
+	return return_future;
+}
+
+
+/**
+ * @description: 通过当前线程的提交缓冲区提交不需要返回结果的函数
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::postBuffered(Func &&func, Args &&... args) -> TaskVoid<Func, Args...> {
+	postBuffered(m_config->m_priority_level, std::forward<Func>(func), std::forward<Args>(args)...);
+}
+
+
+/**
+ * @description: 通过当前线程的提交缓冲区提交不需要返回结果的函数
+ * @param {size_t} proity: 任务优先级
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ */
+template <typename Func, typename... Args>
+inline auto ThreadPool::postBuffered(size_t proity, Func &&func, Args &&... args) -> TaskVoid<Func, Args...> {
+	Task task(BoundTask<Func, Args...>(std::forward<Func>(func), std::forward<Args>(args)...));
+
+	// 放入提交缓冲区
+	bufferTask(task, proity);
+}
+
+
+/**
+ * @description: 调用线程与帮助任务一起分块执行 body(first, last, participant)，返回时所有迭代都已完成
+ * @description: 帮助任务数量为参与者数量减一，逐个提交且不等待任务队列空出位置，提交失败时由已有的参与者完成剩余的迭代
+ * @description: 调用线程是本线程池的工作线程时，执行完自己领取的区间后，等待期间帮助执行其他任务
+ * @param {size_t} size: 迭代数量
+ * @param {size_t} grain: 块大小，由 loopParticipants 确定
+ * @param {size_t} participants: 参与者数量，由 loopParticipants 确定，body 的 participant 参数小于该值
+ * @param {LoopSchedule} schedule: 分块方式
+ * @param {Body&} body: 循环体，第一个迭代抛出的异常在这里重新抛出
+ */
+template <typename Body>
+inline void ThreadPool::runLoop(size_t size, size_t grain, size_t participants, LoopSchedule schedule, Body &body) {
+	if (size == 0) {
+		return;
+	}
+
+	if (participants <= 1) {
+		body(static_cast<size_t>(0), size, static_cast<size_t>(0));
+		return;
+	}
+
+	using region_type = LoopRegion<Body>;
+	size_t priority = m_config->m_priority_level;
+	region_type* region = region_type::create(body, size, grain, participants, schedule, this, priority);
+	TaskFuture<void> done = region->getFuture();
+
+	for (size_t i = 1; i < participants; ++i) {
+		Task helper(typename region_type::Handle(region, i));
+		try {
+			if (!m_start || !enqueueUntil(helper, priority, std::chrono::steady_clock::time_point::min())) {
+				break;
+			}
+		}
+		catch (const std::runtime_error &) {
+			break;
+		}
+	}
+
+	region->work(0);
+	region->release();
+	done.get();
+}
+
+
+/**
+ * @description: 并行执行 func(begin) ... func(end - 1)，自动选择块大小
+ * @param {Index} begin: 第一个下标
+ * @param {Index} end: 最后一个下标之后
+ * @param {Func} &&func: 循环体，参数为下标
+ * @param {LoopSchedule} schedule: 分块方式
+ */
+template <typename Index, typename Func>
+inline void ThreadPool::parallelFor(Index begin, Index end, Func &&func, LoopSchedule schedule) {
+	parallelFor(begin, end, 0, std::forward<Func>(func), schedule);
+}
+
+
+/**
+ * @description: 并行执行 func(begin) ... func(end - 1)，调用线程参与执行，返回时所有迭代都已完成
+ * @description: 迭代被分成若干块，由调用线程和不超过线程数量的帮助任务领取，整个循环只有几次入队，不受 max_task 限制
+ * @description: 迭代数量不超过 grain 或线程池已关闭时，由调用线程直接执行
+ * @param {Index} begin: 第一个下标，整数类型
+ * @param {Index} end: 最后一个下标之后
+ * @param {size_t} grain: 块大小 (GUIDED 下为最小块)，为 0 时按每个参与者约 8 块自动选择
+ * @param {Func} &&func: 循环体，参数为下标，第一个抛出的异常在这里重新抛出，之后未开始的块不再执行
+ * @param {LoopSchedule} schedule: 分块方式，默认为 GUIDED
+ */
+template <typename Index, typename Func>
+inline void ThreadPool::parallelFor(Index begin, Index end, size_t grain, Func &&func, LoopSchedule schedule) {
+	static_assert(std::is_integral<Index>::value, "parallelFor requires an integral index type");
+
+	if (!(begin < end)) {
+		return;
+	}
+
+	auto body = [begin, &func](size_t first, size_t last, size_t) {
+		for (size_t i = first; i < last; ++i) {
+			func(static_cast<Index>(begin + static_cast<Index>(i)));
+		}
+	};
+	size_t size = static_cast<size_t>(end - begin);
+	size_t participants = loopParticipants(size, grain);
+	runLoop(size, grain, participants, schedule, body);
+}
+
+
+/**
+ * @description: 并行归约 [first, last)，等价于 transformReduce 不做变换
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {T} identity: 单位元，combine(identity, x) == x，每个参与者的部分结果从它开始
+ * @param {Combine} &&combine: 满足结合律与交换律的合并函数，combine(T, 元素) 与 combine(T, T) 都返回 T
+ * @param {size_t} grain: 块大小，为 0 时自动选择
+ * @return {T} 归约结果，空区间返回 identity
+ */
+template <typename Iterator, typename T, typename Combine>
+inline T ThreadPool::parallelReduce(Iterator first, Iterator last, T identity, Combine &&combine, size_t grain) {
+	return transformReduce(first, last, std::move(identity), std::forward<Combine>(combine), LoopIdentity(), grain);
+}
+
+
+/**
+ * @description: 并行归约 transform(*first) ... transform(*(last - 1))，调用线程参与执行
+ * @description: 每个参与者在自己的部分结果上累加，部分结果之间填充一个缓存行，避免伪共享；最后按二叉树两两合并
+ * @description: 各块的合并顺序不固定，因此 combine 需要满足结合律与交换律 (浮点数加法的结果可能与顺序累加略有差别)
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {T} identity: 单位元，combine(identity, x) == x，每个参与者的部分结果从它开始
+ * @param {Combine} &&combine: 合并函数，combine(T, transform 的结果) 与 combine(T, T) 都返回 T
+ * @param {Transform} &&transform: 变换函数，参数为元素
+ * @param {size_t} grain: 块大小，为 0 时自动选择
+ * @return {T} 归约结果，空区间返回 identity
+ */
+template <typename Iterator, typename T, typename Combine, typename Transform>
+inline T ThreadPool::transformReduce(Iterator first, Iterator last, T identity, Combine &&combine, Transform &&transform, size_t grain) {
+	static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+		"transformReduce requires random access iterators");
+
+	if (!(first < last)) {
+		return identity;
+	}
+
+	size_t size = static_cast<size_t>(last - first);
+	size_t participants = loopParticipants(size, grain);
+	std::vector<LoopPartial<T>> partials(participants, LoopPartial<T>(identity));
+
+	auto body = [first, &partials, &combine, &transform](size_t begin, size_t end, size_t participant) {
+		T value = std::move(partials[participant].m_value);
+		for (size_t i = begin; i < end; ++i) {
+			value = combine(std::move(value), transform(first[i]));
+		}
+		partials[participant].m_value = std::move(value);
+	};
+	runLoop(size, grain, participants, LoopSchedule::GUIDED, body);
+
+	// 二叉树合并：第 k 轮把相距 2^k 的部分结果两两合并
+	for (size_t stride = 1; stride < participants; stride *= 2) {
+		for (size_t i = 0; i + stride < participants; i += 2 * stride) {
+			partials[i].m_value = combine(std::move(partials[i].m_value), std::move(partials[i + stride].m_value));
 		}
+	}
+	return std::move(partials[0].m_value);
+}
+
+
+/**
+ * @description: 将 source 中相邻的两个长度为 run 的有序段归并到 target 的相同位置，最后一段没有配对时直接移动
+ * @description: 每对有序段按输出位置切成若干片 (mergeSplit 求切分点)，所有片由参与者分别归并，最后一轮只有一对时同样并行
+ * @param {Source} source: 有序段所在的区间
+ * @param {Target} target: 输出区间，与 source 等长且不重叠
+ * @param {size_t} size: 元素数量
+ * @param {size_t} run: 有序段长度
+ * @param {size_t} participants: 参与者数量
+ * @param {Compare&} comp: 比较函数
+ */
+template <typename Source, typename Target, typename Compare>
+inline void ThreadPool::mergeRuns(Source source, Target target, size_t size, size_t run, size_t participants, Compare &comp) {
+	size_t pairs = (size + 2 * run - 1) / (2 * run);
+	size_t pieces = std::max<size_t>((2 * participants + pairs - 1) / pairs, 1);  // 每对有序段切成的片数，合计约为参与者的 2 倍
+
+	auto body = [source, target, size, run, pieces, &comp](size_t begin, size_t end, size_t) {
+		for (size_t k = begin; k < end; ++k) {
+			size_t low = k / pieces * 2 * run;
+			size_t middle = std::min(size, low + run);
+			size_t high = std::min(size, low + 2 * run);
+			size_t length = high - low;
+			size_t piece = k % pieces;
+			size_t from = length * piece / pieces;
+			size_t to = length * (piece + 1) / pieces;
+
+			Source left = source + low;
+			Source right = source + middle;
+			size_t left_from = mergeSplit(left, middle - low, right, high - middle, from, comp);
+			size_t left_to = mergeSplit(left, middle - low, right, high - middle, to, comp);
+			std::merge(std::make_move_iterator(left + left_from), std::make_move_iterator(left + left_to),
+				std::make_move_iterator(right + (from - left_from)), std::make_move_iterator(right + (to - left_to)),
+				target + (low + from), comp);
+		}
+	};
+	size_t amount = pairs * pieces;
+	runLoop(amount, 1, std::min(participants, amount), LoopSchedule::DYNAMIC, body);
+}
+
+
+/**
+ * @description: 并行归并排序：区间按参与者数量分块，各块由参与者分别排序，再逐轮把相邻的有序段两两并行归并，段长每轮翻倍
+ * @description: 归并在区间与一个等长的临时缓冲区之间交替进行，轮数为奇数时最后并行移回区间
+ * @description: 元素少于 SORT_BLOCK 个或线程池已关闭时由调用线程直接排序
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Compare&} comp: 比较函数
+ * @param {bool} stable: 是否保持相等元素的原有顺序
+ */
+template <typename Iterator, typename Compare>
+inline void ThreadPool::sortRange(Iterator first, Iterator last, Compare &comp, bool stable) {
+	static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+		"parallel sort requires random access iterators");
+	static const size_t SORT_BLOCK = 8192;  // 每块的最少元素数量，更小的块排序时间不足以抵消调度与归并的开销
+
+	using value_type = typename std::iterator_traits<Iterator>::value_type;
+	size_t size = static_cast<size_t>(last - first);
+	size_t grain = SORT_BLOCK;
+	size_t participants = size < 2 ? 1 : loopParticipants(size, grain);
 
-		// 如果任务数已满，等待线程执行
-		if (m_config->m_max_task == m_queue.size()) {
-
-#ifdef DEBUG
-			std::cout << "任务队列已满, 请等待任务完成";
-#else
-			m_log->addTask("任务队列已满, 请等待任务完成");
-#endif
-			// 尝试添加线程
-			if (m_config->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD
-				&& m_threads.size() < m_config->m_max_threshold
-				&& m_threads.size() < std::thread::hardware_concurrency()
-			) {
-				m_threads[m_thread_id] = std::thread(&Worker::operator(), Worker(this, m_thread_id));  // 指定线程所执行的函数
-				m_thread_id++;
-				m_thread_amount++;
-
-				size_t threads_amount = m_threads.size();
-#ifdef DEBUG
-				std::cout << "已动态添加新线程，当前线程数量为: " << threads_amount << "  ----->   " << m_config->m_max_threshold << std::endl;
-#else
-				std::string task = "已动态添加新线程，当前线程数量为: " + threads_amount;
-				m_log->addTask(task);
-#endif
+	if (participants <= 1) {
+		if (stable) {
+			std::stable_sort(first, last, comp);
+		}
+		else {
+			std::sort(first, last, comp);
+		}
+		return;
+	}
+
+	// 每个参与者一块
+	size_t run = (size + participants - 1) / participants;
+	auto sort_body = [first, size, run, stable, &comp](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			Iterator low = first + std::min(size, i * run);
+			Iterator high = first + std::min(size, (i + 1) * run);
+			if (stable) {
+				std::stable_sort(low, high, comp);
+			}
+			else {
+				std::sort(low, high, comp);
 			}
+		}
+	};
+	runLoop(participants, 1, participants, LoopSchedule::DYNAMIC, sort_body);
+
+	std::vector<value_type> buffer(size);
+	bool in_buffer = false;
+	for (; run < size; run *= 2) {
+		if (in_buffer) {
+			mergeRuns(buffer.begin(), first, size, run, participants, comp);
+		}
+		else {
+			mergeRuns(first, buffer.begin(), size, run, participants, comp);
+		}
+		in_buffer = !in_buffer;
+	}
+
+	if (in_buffer) {
+		typename std::vector<value_type>::iterator source = buffer.begin();
+		auto move_body = [source, first](size_t begin, size_t end, size_t) {
+			std::move(source + begin, source + end, first + begin);
+		};
+		runLoop(size, grain, participants, LoopSchedule::STATIC, move_body);
+	}
+}
+
+
+/**
+ * @description: 并行排序，调用线程参与执行，返回时区间已有序；相等元素的顺序不确定
+ * @description: 元素需要可以默认构造与移动赋值 (归并使用等长的临时缓冲区)；比较函数抛出异常时在这里重新抛出，区间中的内容不确定
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Compare} comp: 比较函数，满足严格弱序，会被多个线程同时调用
+ */
+template <typename Iterator, typename Compare>
+inline void ThreadPool::parallelSort(Iterator first, Iterator last, Compare comp) {
+	sortRange(first, last, comp, false);
+}
+
+
+/**
+ * @description: 按 operator< 并行排序
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ */
+template <typename Iterator>
+inline void ThreadPool::parallelSort(Iterator first, Iterator last) {
+	parallelSort(first, last, std::less<typename std::iterator_traits<Iterator>::value_type>());
+}
+
+
+/**
+ * @description: 并行稳定排序，调用线程参与执行，相等元素保持原有顺序
+ * @description: 元素需要可以默认构造与移动赋值；比较函数抛出异常时在这里重新抛出，区间中的内容不确定
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Compare} comp: 比较函数，满足严格弱序，会被多个线程同时调用
+ */
+template <typename Iterator, typename Compare>
+inline void ThreadPool::parallelStableSort(Iterator first, Iterator last, Compare comp) {
+	sortRange(first, last, comp, true);
+}
+
+
+/**
+ * @description: 按 operator< 并行稳定排序
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ */
+template <typename Iterator>
+inline void ThreadPool::parallelStableSort(Iterator first, Iterator last) {
+	parallelStableSort(first, last, std::less<typename std::iterator_traits<Iterator>::value_type>());
+}
+
+/**
+ * @description: 两遍分块前缀和：区间按 scanChunk 切成块，块的输入与输出能留在二级缓存中
+ * @description: 第一遍并行求每块的合并结果 (最后一块不需要)，调用线程按顺序求每块之前的合并结果，第二遍并行地以它为起点扫描每块
+ * @description: 块的先后顺序保持不变，因此 combine 只需满足结合律；out 可以与 first 相同 (原地计算)
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Output} out: 输出的第一个位置，随机访问迭代器
+ * @param {const T*} init: 排除式的初始值，为空时为包含式
+ * @param {Combine&} combine: 合并函数
+ * @param {size_t} grain: 块大小，为 0 时按二级缓存大小选择
+ * @return {Output} 输出的最后一个位置之后
+ */
+template <typename Iterator, typename Output, typename T, typename Combine>
+inline Output ThreadPool::scanRange(Iterator first, Iterator last, Output out, const T *init, Combine &combine, size_t grain) {
+	static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+		"parallel scan requires random access iterators");
 
-			// 用户提交任务，超过时长，执行拒绝策略
-			if (std::cv_status::timeout == m_queue_not_full.wait_for(lock, std::chrono::milliseconds(m_config->m_timeout))) {
-				// 动态添加线程
-				std::cout << "拒绝策略" << std::endl;
+	if (!(first < last)) {
+		return out;
+	}
+
+	size_t size = static_cast<size_t>(last - first);
+	size_t chunk = grain != 0 ? grain : scanChunk(sizeof(T));
+	size_t blocks = (size + chunk - 1) / chunk;
+	size_t one = 1;
+	size_t participants = loopParticipants(blocks, one);
+
+	// 以 carry 为起点扫描 [begin, end)，carry 已包含 begin 之前的所有元素；先读输入再写输出，原地计算时同样正确
+	auto scan_block = [first, out, init, &combine](size_t begin, size_t end, T carry) {
+		for (size_t i = begin; i < end; ++i) {
+			T value = first[i];
+			if (init) {
+				out[i] = carry;
+				carry = combine(std::move(carry), std::move(value));
 			}
 			else {
-				// 任务入队
-				m_queue.taskEnqueue(warpper_func, proity);
+				carry = combine(std::move(carry), std::move(value));
+				out[i] = carry;
 			}
 		}
+	};
+	// 包含式的第一个元素没有起点
+	auto scan_first = [first, out, init, &scan_block](size_t end) {
+		if (init) {
+			scan_block(0, end, *init);
+		}
 		else {
-			// 任务入队
-				m_queue.taskEnqueue(warpper_func, proity);
+			T carry = first[0];
+			out[0] = carry;
+			scan_block(1, end, std::move(carry));
 		}
-		
+	};
+
+	if (participants <= 1) {
+		scan_first(size);
+		return out + size;
 	}
 
-	// 唤醒一个等待中的线程
-	m_queue_not_empty.notify_one();
-	
-	return return_future;
+	// 第一遍：每块的合并结果，LoopPartial 避免相邻块的结果位于同一缓存行
+	std::vector<LoopPartial<T>> sums(blocks - 1, LoopPartial<T>(init ? *init : T(first[0])));
+	auto reduce_body = [first, chunk, &sums, &combine](size_t begin, size_t end, size_t) {
+		for (size_t b = begin; b < end; ++b) {
+			size_t low = b * chunk;
+			size_t high = low + chunk;
+			T sum = first[low];
+			for (size_t i = low + 1; i < high; ++i) {
+				sum = combine(std::move(sum), first[i]);
+			}
+			sums[b].m_value = std::move(sum);
+		}
+	};
+	runLoop(blocks - 1, 1, std::min(participants, blocks - 1), LoopSchedule::DYNAMIC, reduce_body);
+
+	// 每块的合并结果替换为该块之前所有元素的合并结果，sums[b] 为第 b + 1 块的起点
+	T carry = init ? combine(*init, std::move(sums[0].m_value)) : std::move(sums[0].m_value);
+	sums[0].m_value = carry;
+	for (size_t b = 1; b < blocks - 1; ++b) {
+		carry = combine(std::move(carry), std::move(sums[b].m_value));
+		sums[b].m_value = carry;
+	}
+
+	// 第二遍：以起点扫描每块
+	auto scan_body = [size, chunk, &sums, &scan_block, &scan_first](size_t begin, size_t end, size_t) {
+		for (size_t b = begin; b < end; ++b) {
+			if (b == 0) {
+				scan_first(chunk);
+			}
+			else {
+				scan_block(b * chunk, std::min(size, (b + 1) * chunk), sums[b - 1].m_value);
+			}
+		}
+	};
+	runLoop(blocks, 1, participants, LoopSchedule::DYNAMIC, scan_body);
+
+	return out + size;
+}
+
+
+/**
+ * @description: 并行包含式前缀和：out[i] = first[0] combine ... combine first[i]，调用线程参与执行
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Output} out: 输出的第一个位置，随机访问迭代器，可以与 first 相同
+ * @param {Combine} combine: 满足结合律的合并函数，会被多个线程同时调用，第一个抛出的异常在这里重新抛出
+ * @param {size_t} grain: 块大小，为 0 时按二级缓存大小选择
+ * @return {Output} 输出的最后一个位置之后
+ */
+template <typename Iterator, typename Output, typename Combine>
+inline Output ThreadPool::parallelInclusiveScan(Iterator first, Iterator last, Output out, Combine combine, size_t grain) {
+	using value_type = typename std::iterator_traits<Iterator>::value_type;
+	return scanRange(first, last, out, static_cast<const value_type*>(nullptr), combine, grain);
+}
+
+
+/**
+ * @description: 按 operator+ 并行包含式前缀和
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Output} out: 输出的第一个位置，随机访问迭代器，可以与 first 相同
+ * @return {Output} 输出的最后一个位置之后
+ */
+template <typename Iterator, typename Output>
+inline Output ThreadPool::parallelInclusiveScan(Iterator first, Iterator last, Output out) {
+	return parallelInclusiveScan(first, last, out, std::plus<typename std::iterator_traits<Iterator>::value_type>());
+}
+
+
+/**
+ * @description: 并行排除式前缀和：out[0] = init，out[i] = init combine first[0] combine ... combine first[i - 1]，调用线程参与执行
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Output} out: 输出的第一个位置，随机访问迭代器，可以与 first 相同
+ * @param {T} init: 初始值，决定累加使用的类型
+ * @param {Combine} combine: 满足结合律的合并函数，会被多个线程同时调用，第一个抛出的异常在这里重新抛出
+ * @param {size_t} grain: 块大小，为 0 时按二级缓存大小选择
+ * @return {Output} 输出的最后一个位置之后
+ */
+template <typename Iterator, typename Output, typename T, typename Combine>
+inline Output ThreadPool::parallelExclusiveScan(Iterator first, Iterator last, Output out, T init, Combine combine, size_t grain) {
+	return scanRange(first, last, out, &init, combine, grain);
+}
+
+
+/**
+ * @description: 按 operator+ 并行排除式前缀和，例如由记录长度计算每条记录的偏移
+ * @param {Iterator} first: 第一个元素，随机访问迭代器
+ * @param {Iterator} last: 最后一个元素之后
+ * @param {Output} out: 输出的第一个位置，随机访问迭代器，可以与 first 相同
+ * @param {T} init: 初始值
+ * @return {Output} 输出的最后一个位置之后
+ */
+template <typename Iterator, typename Output, typename T>
+inline Output ThreadPool::parallelExclusiveScan(Iterator first, Iterator last, Output out, T init) {
+	return parallelExclusiveScan(first, last, out, std::move(init), std::plus<T>());
+}
+
+/**
+ * @description: 以 std::hash 与 std::equal_to 并行分组聚合
+ * @param {Iterator} first: 第一行，随机访问迭代器
+ * @param {Iterator} last: 最后一行之后
+ * @param {KeyOf} key_of: 取出一行的键
+ * @param {ValueOf} value_of: 取出一行参与聚合的值
+ * @param {Combine} combine: 合并同一组的两个值
+ * @param {size_t} grain: 块大小，为 0 时自动选择
+ * @return {vector<pair<Key, Value>>} 每组一个条目，顺序不确定
+ */
+template <typename Iterator, typename KeyOf, typename ValueOf, typename Combine>
+inline auto ThreadPool::parallelGroupBy(Iterator first, Iterator last, KeyOf key_of, ValueOf value_of, Combine combine, size_t grain)
+	-> std::vector<std::pair<GroupKey<Iterator, KeyOf>, GroupValue<Iterator, ValueOf>>> {
+	using key_type = GroupKey<Iterator, KeyOf>;
+	return parallelGroupBy(first, last, key_of, value_of, combine, std::hash<key_type>(), std::equal_to<key_type>(), grain);
+}
+
+
+/**
+ * @description: 并行分组聚合，调用线程参与执行
+ * @description: 分区数量为不小于参与者数量的 2 的幂，打散后的哈希值高位决定分区；每个参与者为每个分区建一张开放寻址哈希表，聚合时不加锁
+ * @description: 之后各分区由不同参与者并行合并：同一分区在所有参与者中的表合并到其中最大的一张，不同分区的键互不相同，合并时没有竞争
+ * @description: 合并的先后顺序不固定，combine 需要满足结合律与交换律；第一个抛出的异常在这里重新抛出
+ * @param {Iterator} first: 第一行，随机访问迭代器
+ * @param {Iterator} last: 最后一行之后
+ * @param {KeyOf} key_of: 取出一行的键，会被多个线程同时调用
+ * @param {ValueOf} value_of: 取出一行参与聚合的值，一组的第一个值直接作为初始值
+ * @param {Combine} combine: 合并同一组的两个值，combine(Value, Value) 返回 Value
+ * @param {Hash} hash: 键的哈希函数
+ * @param {Equal} equal: 键的相等比较
+ * @param {size_t} grain: 块大小，为 0 时自动选择
+ * @return {vector<pair<Key, Value>>} 每组一个条目，顺序不确定
+ */
+template <typename Iterator, typename KeyOf, typename ValueOf, typename Combine, typename Hash, typename Equal>
+inline auto ThreadPool::parallelGroupBy(Iterator first, Iterator last, KeyOf key_of, ValueOf value_of, Combine combine, Hash hash, Equal equal, size_t grain)
+	-> std::vector<std::pair<GroupKey<Iterator, KeyOf>, GroupValue<Iterator, ValueOf>>> {
+	static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+		"parallelGroupBy requires random access iterators");
+
+	using key_type = GroupKey<Iterator, KeyOf>;
+	using value_type = GroupValue<Iterator, ValueOf>;
+	using table_type = GroupTable<key_type, value_type>;
+	std::vector<std::pair<key_type, value_type>> groups;
+
+	if (!(first < last)) {
+		return groups;
+	}
+
+	size_t size = static_cast<size_t>(last - first);
+	size_t participants = loopParticipants(size, grain);
+	size_t partitions = 1;
+	unsigned partition_bits = 0;
+	while (partitions < participants) {
+		partitions *= 2;
+		partition_bits++;
+	}
+	unsigned shift = static_cast<unsigned>(sizeof(size_t) * 8) - partition_bits;
+
+	// 每个参与者一组表，用 LoopPartial 填充，相邻参与者的表头不在同一缓存行
+	std::vector<LoopPartial<std::vector<table_type>>> tables(participants, LoopPartial<std::vector<table_type>>(std::vector<table_type>(partitions)));
+
+	auto build_body = [first, &tables, &key_of, &value_of, &combine, &hash, &equal, partition_bits, shift](size_t begin, size_t end, size_t participant) {
+		std::vector<table_type> &local = tables[participant].m_value;
+		for (size_t i = begin; i < end; ++i) {
+			auto &&row = first[i];
+			key_type key = key_of(row);
+			size_t mixed = mixGroupHash(hash(key));
+			size_t partition = partition_bits == 0 ? 0 : mixed >> shift;
+			local[partition].insert(mixed, std::move(key), value_of(row), combine, equal);
+		}
+	};
+	runLoop(size, grain, participants, LoopSchedule::GUIDED, build_body);
+
+	if (participants > 1) {
+		auto merge_body = [&tables, &combine, &equal, participants](size_t begin, size_t end, size_t) {
+			for (size_t partition = begin; partition < end; ++partition) {
+				// 合并到最大的一张表，减少扩容
+				size_t largest = 0;
+				for (size_t p = 1; p < participants; ++p) {
+					if (tables[p].m_value[partition].size() > tables[largest].m_value[partition].size()) {
+						largest = p;
+					}
+				}
+				std::swap(tables[0].m_value[partition], tables[largest].m_value[partition]);
+
+				table_type &target = tables[0].m_value[partition];
+				for (size_t p = 1; p < participants; ++p) {
+					target.merge(tables[p].m_value[partition], combine, equal);
+				}
+			}
+		};
+		runLoop(partitions, 1, std::min(participants, partitions), LoopSchedule::DYNAMIC, merge_body);
+	}
+
+	size_t amount = 0;
+	for (table_type &table : tables[0].m_value) {
+		amount += table.size();
+	}
+	groups.reserve(amount);
+	for (table_type &table : tables[0].m_value) {
+		std::move(table.entries().begin(), table.entries().end(), std::back_inserter(groups));
+		table.clear();
+	}
+	return groups;
 }
 
 #endif  // !THREAD_POOL_H__
@@ -0,0 +1,119 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 16:40:12
+ * @last_edit_time: 2026-10-17 16:40:12
+ * @file_path: /Thread-Pool/include/Trace.h
+ * @description: 线程池追踪模块头文件，用于替代热路径上的 std::cout
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+
+/*
+***************************追踪等级***************************
+*/
+#define TRACE_LEVEL_NONE 0  // 不记录
+#define TRACE_LEVEL_ERROR 1  // 错误，例如拒绝任务
+#define TRACE_LEVEL_INFO 2  // 线程增删等低频事件
+#define TRACE_LEVEL_DEBUG 3  // 每个任务的入队、出队等高频事件
+
+/* 编译期追踪等级，发布版本（定义了 NDEBUG）默认全部编译去除，也可以通过 -DTHREADPOOL_TRACE_LEVEL=N 指定 */
+#ifndef THREADPOOL_TRACE_LEVEL
+#ifdef NDEBUG
+#define THREADPOOL_TRACE_LEVEL TRACE_LEVEL_NONE
+#else
+#define THREADPOOL_TRACE_LEVEL TRACE_LEVEL_DEBUG
+#endif
+#endif
+
+
+/*
+***************************运行时追踪模式***************************
+*/
+enum class TraceMode : char {
+    OFF,  // 不记录，热路径上只有一次原子读取
+    BUFFER,  // 记录到每个线程独立的环形缓冲区，不加锁、不格式化
+    CONSOLE  // 立即输出到 std::cout，只用于调试
+};
+
+
+/*
+***************************追踪记录***************************
+*/
+struct TraceRecord {
+    uint64_t m_time;  // 时间戳（纳秒，steady_clock）
+    const char* m_event;  // 事件描述，必须是字符串字面量
+    int64_t m_first;  // 第一个参数
+    int64_t m_second;  // 第二个参数
+    int m_level;  // 追踪等级
+};
+
+
+/*
+***************************追踪模块***************************
+*/
+class Trace {
+private:
+    struct Buffer;  // 线程缓冲区
+    struct Registry;  // 缓冲区注册表
+
+    static std::atomic<int> m_mode;  // 运行时追踪模式
+
+    static Registry &registry();  // 获取缓冲区注册表
+    static Buffer* localBuffer();  // 获取当前线程的缓冲区，第一次调用时注册
+
+public:
+    static const size_t BUFFER_SIZE = 4096;  // 每个线程缓冲区保存的记录数量，写满后覆盖最旧的记录
+
+    /* 接口 */
+    static void setMode(TraceMode);  // 设置运行时追踪模式
+    static TraceMode getMode();  // 获取运行时追踪模式
+    inline static bool enabled();  // 是否开启追踪
+    static void record(int, const char*, int64_t, int64_t);  // 记录一个事件
+    static void dump(std::ostream &);  // 按时间顺序输出所有线程缓冲区中的记录，应在线程池空闲或关闭后调用
+    static void clear();  // 清空所有线程缓冲区
+};
+
+
+/**
+ * @description: 是否开启追踪
+ * @return {bool} 运行时追踪模式不为 OFF 时返回 true
+ */
+inline bool Trace::enabled() {
+    return m_mode.load(std::memory_order_relaxed) != static_cast<int>(TraceMode::OFF);
+}
+
+
+/*
+***************************追踪宏***************************
+*/
+#define TP_TRACE(level, event, first, second) \
+    do { \
+        if (Trace::enabled()) { \
+            Trace::record((level), (event), static_cast<int64_t>(first), static_cast<int64_t>(second)); \
+        } \
+    } while (0)
+
+#if THREADPOOL_TRACE_LEVEL >= TRACE_LEVEL_ERROR
+#define TP_TRACE_ERROR(event, first, second) TP_TRACE(TRACE_LEVEL_ERROR, event, first, second)
+#else
+#define TP_TRACE_ERROR(event, first, second) do { } while (0)
+#endif
+
+#if THREADPOOL_TRACE_LEVEL >= TRACE_LEVEL_INFO
+#define TP_TRACE_INFO(event, first, second) TP_TRACE(TRACE_LEVEL_INFO, event, first, second)
+#else
+#define TP_TRACE_INFO(event, first, second) do { } while (0)
+#endif
+
+#if THREADPOOL_TRACE_LEVEL >= TRACE_LEVEL_DEBUG
+#define TP_TRACE_DEBUG(event, first, second) TP_TRACE(TRACE_LEVEL_DEBUG, event, first, second)
+#else
+#define TP_TRACE_DEBUG(event, first, second) do { } while (0)
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 09:12:40
+ * @last_edit_time: 2026-10-17 09:12:40
+ * @file_path: /Thread-Pool/include/WorkStealingDeque.h
+ * @description: 工作窃取双端队列（Chase-Lev 无锁双端队列）
+ */
+
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @description: Chase-Lev 工作窃取双端队列
+ * @description: 只有所属线程可以调用 push/pop（在底部操作，后进先出），其他线程只能调用 steal（从顶部窃取，先进先出）
+ * @description: T 必须是可平凡拷贝的类型（例如指针），数组满时自动扩容，旧数组在析构时统一释放，保证窃取线程不会访问已释放内存
+ */
+template<typename T>
+class WorkStealingDeque {
+private:
+	/* 环形数组 */
+	struct Array {
+		int64_t m_capacity;  // 容量，必须为 2 的幂
+		int64_t m_mask;  // 下标掩码
+		std::atomic<T>* m_data;  // 元素
+
+		explicit Array(int64_t capacity)
+			: m_capacity(capacity)
+			, m_mask(capacity - 1)
+			, m_data(new std::atomic<T>[capacity])
+		{ }
+		~Array() { delete[] m_data; }
+
+		T get(int64_t i) { return m_data[i & m_mask].load(std::memory_order_relaxed); }
+		void put(int64_t i, T t) { m_data[i & m_mask].store(t, std::memory_order_relaxed); }
+
+		Array* resize(int64_t bottom, int64_t top) {
+			Array* array = new Array(2 * m_capacity);
+			for (int64_t i = top; i != bottom; ++i) {
+				array->put(i, get(i));
+			}
+			return array;
+		}
+	};
+
+	std::atomic<int64_t> m_top;  // 窃取端
+	std::atomic<int64_t> m_bottom;  // 所属线程端
+	std::atomic<Array*> m_array;  // 当前使用的数组
+	std::vector<Array*> m_garbage;  // 扩容后被替换的旧数组，只由所属线程访问
+
+public:
+	explicit WorkStealingDeque(int64_t capacity = 256);
+	~WorkStealingDeque();
+	WorkStealingDeque(const WorkStealingDeque &) = delete;
+	WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+	/* 成员函数 */
+	bool empty() const;  // 队列是否为空
+	size_t size() const;  // 队列大小（并发时只是近似值）
+
+	void push(T);  // 所属线程压入任务
+	bool pop(T &);  // 所属线程弹出任务
+	bool steal(T &);  // 其他线程窃取任务
+};
+
+
+/**
+ * @description: 构造函数
+ * @param {int64_t} capacity: 初始容量，会向上取整为 2 的幂
+ */
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(int64_t capacity)
+	: m_top(0)
+	, m_bottom(0)
+{
+	int64_t real_capacity = 1;
+	while (real_capacity < capacity) {
+		real_capacity <<= 1;
+	}
+	m_array.store(new Array(real_capacity), std::memory_order_relaxed);
+}
+
+
+/**
+ * @description: 析构函数，释放当前数组以及扩容时替换下来的旧数组
+ */
+template<typename T>
+WorkStealingDeque<T>::~WorkStealingDeque() {
+	for (Array* array : m_garbage) {
+		delete array;
+	}
+	delete m_array.load(std::memory_order_relaxed);
+}
+
+
+/**
+ * @description: 判断队列是否为空
+ * @return {bool} true/false
+ */
+template<typename T>
+bool WorkStealingDeque<T>::empty() const {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+	return bottom <= top;
+}
+
+
+/**
+ * @description: 获取队列大小
+ * @return {size_t} 元素数量
+ */
+template<typename T>
+size_t WorkStealingDeque<T>::size() const {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+	return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+}
+
+
+/**
+ * @description: 所属线程在底部压入元素，数组已满时扩容
+ * @param {T} t: 元素
+ */
+template<typename T>
+void WorkStealingDeque<T>::push(T t) {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+	Array* array = m_array.load(std::memory_order_relaxed);
+
+	// 数组已满，扩容
+	if (bottom - top > array->m_capacity - 1) {
+		m_garbage.push_back(array);
+		array = array->resize(bottom, top);
+		m_array.store(array, std::memory_order_release);
+	}
+
+	array->put(bottom, t);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+
+/**
+ * @description: 所属线程从底部弹出元素，只剩一个元素时与窃取线程通过 CAS 竞争
+ * @param {T} &t: 存放弹出的元素
+ * @return {bool} 成功返回 true, 队列为空或竞争失败返回 false
+ */
+template<typename T>
+bool WorkStealingDeque<T>::pop(T &t) {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	Array* array = m_array.load(std::memory_order_relaxed);
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	// 队列为空
+	if (top > bottom) {
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	t = array->get(bottom);
+
+	// 最后一个元素，需要与窃取线程竞争
+	if (top == bottom) {
+		bool success = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return success;
+	}
+
+	return true;
+}
+
+
+/**
+ * @description: 其他线程从顶部窃取元素
+ * @param {T} &t: 存放窃取的元素
+ * @return {bool} 成功返回 true, 队列为空或竞争失败返回 false
+ */
+template<typename T>
+bool WorkStealingDeque<T>::steal(T &t) {
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom) {
+		return false;
+	}
+
+	Array* array = m_array.load(std::memory_order_acquire);
+	t = array->get(top);
+
+	return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
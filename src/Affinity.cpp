@@ -0,0 +1,302 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 10:12:36
+ * @last_edit_time: 2026-10-19 15:02:40
+ * @file_path: /Thread-Pool/src/Affinity.cpp
+ * @description: CPU 亲和性与 NUMA 拓扑源文件
+ */
+
+#include "Affinity.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+static thread_local int g_current_node = -1;  // 当前线程绑定的节点，未绑定为 -1
+
+
+/**
+ * @description: 读取 root 下 node0、node1 ... 目录中的 cpulist
+ * @param {string} root: 节点目录，测试时可以指定伪造的目录
+ */
+CpuTopology::CpuTopology(const std::string &root) {
+#ifdef __linux__
+	std::vector<int> ids;
+	DIR* dir = opendir(root.c_str());
+	if (dir) {
+		while (dirent* entry = readdir(dir)) {
+			std::string name = entry->d_name;
+			if (name.size() > 4 && name.compare(0, 4, "node") == 0 && name.find_first_not_of("0123456789", 4) == std::string::npos) {
+				ids.push_back(std::atoi(name.c_str() + 4));
+			}
+		}
+		closedir(dir);
+	}
+	std::sort(ids.begin(), ids.end());
+
+	for (int id : ids) {
+		std::ifstream ifs(root + "/node" + std::to_string(id) + "/cpulist");
+		std::string list;
+		std::getline(ifs, list);
+		std::vector<int> cpus = parseCpuList(list);
+		if (!cpus.empty()) {
+			m_nodes.push_back(cpus);
+		}
+	}
+#endif
+
+	// 没有 NUMA 信息时视为一个节点
+	if (m_nodes.empty()) {
+		std::vector<int> cpus;
+		unsigned hardware_size = std::max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned i = 0; i < hardware_size; ++i) {
+			cpus.push_back(static_cast<int>(i));
+		}
+		m_nodes.push_back(cpus);
+	}
+
+	index();
+}
+
+
+/**
+ * @description: 本机拓扑，去掉当前进程不允许使用的 CPU (例如被 taskset、cgroup 限制)
+ * @return {const CpuTopology&} 本机拓扑
+ */
+const CpuTopology &CpuTopology::system() {
+	static const CpuTopology topology = []() {
+		CpuTopology result;
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+			std::vector<int> allowed;
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+				if (CPU_ISSET(cpu, &set)) {
+					allowed.push_back(cpu);
+				}
+			}
+			result.restrict(allowed);
+		}
+#endif
+		return result;
+	}();
+
+	return topology;
+}
+
+
+/**
+ * @description: 只保留给定的 CPU，去掉没有 CPU 的节点；全部去掉时保持不变
+ * @param {std::vector<int>} allowed: 允许使用的 CPU，升序
+ */
+void CpuTopology::restrict(const std::vector<int> &allowed) {
+	std::vector<std::vector<int>> nodes;
+	for (auto &node : m_nodes) {
+		std::vector<int> cpus;
+		for (int cpu : node) {
+			if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+				cpus.push_back(cpu);
+			}
+		}
+		if (!cpus.empty()) {
+			nodes.push_back(cpus);
+		}
+	}
+
+	if (!nodes.empty()) {
+		m_nodes.swap(nodes);
+		index();
+	}
+}
+
+
+/**
+ * @description: 重建 CPU 编号到节点下标的映射
+ */
+void CpuTopology::index() {
+	m_cpu_nodes.clear();
+	for (size_t node = 0; node < m_nodes.size(); ++node) {
+		for (int cpu : m_nodes[node]) {
+			if (static_cast<size_t>(cpu) >= m_cpu_nodes.size()) {
+				m_cpu_nodes.resize(cpu + 1, -1);
+			}
+			m_cpu_nodes[cpu] = static_cast<int>(node);
+		}
+	}
+}
+
+
+/**
+ * @description: 节点数量
+ * @return {size_t} 至少有 CPU 的节点数量
+ */
+size_t CpuTopology::nodes() const {
+	return m_nodes.size();
+}
+
+
+/**
+ * @description: 节点上的 CPU
+ * @param {size_t} node: 节点下标，小于 nodes()
+ * @return {const std::vector<int>&} CPU 编号，按升序排列
+ */
+const std::vector<int> &CpuTopology::cpus(size_t node) const {
+	return m_nodes[node];
+}
+
+
+/**
+ * @description: CPU 所在节点
+ * @param {int} cpu: CPU 编号
+ * @return {int} 节点下标，未知时返回 -1
+ */
+int CpuTopology::nodeOf(int cpu) const {
+	if (cpu < 0 || static_cast<size_t>(cpu) >= m_cpu_nodes.size()) {
+		return -1;
+	}
+	return m_cpu_nodes[cpu];
+}
+
+
+/**
+ * @description: 计算每个工作线程槽位绑定的 CPU，槽位多于 CPU 时循环使用
+ * @param {AffinityPolicy} policy: 绑定方式
+ * @param {size_t} slots: 槽位数量
+ * @param {std::vector<int>} cpu_list: LIST 方式下使用的 CPU
+ * @return {std::vector<int>} 每个槽位绑定的 CPU，不绑定为 -1
+ */
+std::vector<int> CpuTopology::placement(AffinityPolicy policy, size_t slots, const std::vector<int> &cpu_list) const {
+	std::vector<int> order;
+
+	if (policy == AffinityPolicy::LIST) {
+		order = cpu_list;
+	}
+	else if (policy == AffinityPolicy::COMPACT) {
+		for (auto &node : m_nodes) {
+			order.insert(order.end(), node.begin(), node.end());
+		}
+	}
+	else if (policy == AffinityPolicy::SCATTER) {
+		// 每轮从每个节点各取一个 CPU
+		bool taken = true;
+		for (size_t i = 0; taken; ++i) {
+			taken = false;
+			for (auto &node : m_nodes) {
+				if (i < node.size()) {
+					order.push_back(node[i]);
+					taken = true;
+				}
+			}
+		}
+	}
+
+	std::vector<int> result(slots, -1);
+	if (!order.empty()) {
+		for (size_t i = 0; i < slots; ++i) {
+			result[i] = order[i % order.size()];
+		}
+	}
+	return result;
+}
+
+
+/**
+ * @description: 解析 Linux cpulist 格式的 CPU 列表，忽略格式错误的部分
+ * @param {string} list: 例如 "0-3,8,10-11"
+ * @return {std::vector<int>} CPU 编号，按出现顺序排列
+ */
+std::vector<int> CpuTopology::parseCpuList(const std::string &list) {
+	std::vector<int> cpus;
+	size_t begin = 0;
+
+	while (begin < list.size()) {
+		size_t end = list.find(',', begin);
+		if (end == std::string::npos) {
+			end = list.size();
+		}
+		std::string range = list.substr(begin, end - begin);
+		begin = end + 1;
+
+		size_t dash = range.find('-');
+		char* parsed = nullptr;
+		long first = std::strtol(range.c_str(), &parsed, 10);
+		if (parsed == range.c_str() || first < 0) {
+			continue;
+		}
+		long last = first;
+		if (dash != std::string::npos) {
+			const char* second = range.c_str() + dash + 1;
+			last = std::strtol(second, &parsed, 10);
+			if (parsed == second || last < first) {
+				continue;
+			}
+		}
+
+		for (long cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(static_cast<int>(cpu));
+		}
+	}
+
+	return cpus;
+}
+
+
+/**
+ * @description: 将当前线程绑定到给定的 CPU
+ * @param {std::vector<int>} cpus: 允许运行的 CPU
+ * @return {bool} 成功返回 true，非 Linux 平台或 CPU 不可用时返回 false
+ */
+bool CpuTopology::bindCurrentThread(const std::vector<int> &cpus) {
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu : cpus) {
+		if (cpu >= 0 && cpu < CPU_SETSIZE) {
+			CPU_SET(cpu, &set);
+		}
+	}
+	if (CPU_COUNT(&set) == 0) {
+		return false;
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpus;
+	return false;
+#endif
+}
+
+
+/**
+ * @description: 记录当前线程绑定的节点，之后 currentNode 不再查询所在 CPU
+ * @param {int} node: 节点下标，-1 表示未绑定
+ */
+void CpuTopology::setCurrentNode(int node) {
+	g_current_node = node;
+}
+
+
+/**
+ * @description: 当前线程所在节点：绑定过节点的线程直接返回，否则按当前运行的 CPU 查询本机拓扑
+ * @return {int} 节点下标，无法确定时返回 0
+ */
+int CpuTopology::currentNode() {
+	if (g_current_node >= 0) {
+		return g_current_node;
+	}
+
+#ifdef __linux__
+	int node = system().nodeOf(sched_getcpu());
+	return node >= 0 ? node : 0;
+#else
+	return 0;
+#endif
+}
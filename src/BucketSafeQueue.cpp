@@ -0,0 +1,248 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 17:32:08
+ * @last_edit_time: 2026-10-20 12:05:31
+ * @file_path: /Thread-Pool/src/BucketSafeQueue.cpp
+ * @description: 基于分桶与位图的优先级队列源文件
+ */
+
+#include "BucketSafeQueue.h"
+#include "Trace.h"
+
+
+/**
+ * @description: 统计低位连续 0 的个数，word 不能为 0
+ * @param {uint64_t} word: 位图中的一个字
+ * @return {int} 最低位的 1 所在的下标
+ */
+static inline int countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(word);
+#else
+	int index = 0;
+	while ((word & 1) == 0) {
+		word >>= 1;
+		++index;
+	}
+	return index;
+#endif
+}
+
+
+/**
+ * @description: 找到最高位的 1，word 不能为 0
+ * @param {uint64_t} word: 位图中的一个字
+ * @return {int} 最高位的 1 所在的下标
+ */
+static inline int highestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+	return 63 - __builtin_clzll(word);
+#else
+	int index = 63;
+	while ((word & (uint64_t(1) << index)) == 0) {
+		--index;
+	}
+	return index;
+#endif
+}
+
+
+/**
+ * @description: 在队尾添加任务，数组已满时容量翻倍
+ * @param {Task&} task: 任务函数，添加后被移走
+ */
+void BucketSafeQueue::Bucket::push(Task &task) {
+	if (m_size == m_tasks.size()) {
+		// 扩容，按队列顺序搬到新数组的开头
+		std::vector<Task> tasks(m_tasks.empty() ? 8 : m_tasks.size() * 2);
+		for (size_t i = 0; i < m_size; ++i) {
+			tasks[i] = std::move(m_tasks[(m_head + i) % m_tasks.size()]);
+		}
+		m_tasks.swap(tasks);
+		m_head = 0;
+	}
+
+	m_tasks[(m_head + m_size) % m_tasks.size()] = std::move(task);
+	m_size++;
+}
+
+
+/**
+ * @description: 从队首取出任务，调用前需保证桶非空
+ * @param {Task&} task: 获取任务函数的空函数
+ */
+void BucketSafeQueue::Bucket::pop(Task &task) {
+	task = std::move(m_tasks[m_head]);
+	m_head = (m_head + 1) % m_tasks.size();
+	m_size--;
+}
+
+
+/**
+ * @description: 从队尾取出任务 (最后提交的任务)，调用前需保证桶非空
+ * @param {Task&} task: 获取任务函数的空函数
+ */
+void BucketSafeQueue::Bucket::popBack(Task &task) {
+	task = std::move(m_tasks[(m_head + m_size - 1) % m_tasks.size()]);
+	m_size--;
+}
+
+
+/**
+ * @description: 构造函数
+ * @param {size_t} buckets: 桶的数量，即优先级范围 [0, buckets)
+ */
+BucketSafeQueue::BucketSafeQueue(size_t buckets)
+	: m_buckets(buckets ? buckets : 1)
+	, m_bitmap((m_buckets.size() + 63) / 64, 0)
+	, m_size(0)
+{ }
+
+
+/**
+ * @description: 优先级对应的桶下标，超出范围的优先级归入最后一个桶
+ * @param {size_t} priority: 任务优先级
+ * @return {size_t} 桶下标
+ */
+size_t BucketSafeQueue::bucketIndex(size_t priority) {
+	return priority < m_buckets.size() ? priority : m_buckets.size() - 1;
+}
+
+
+/**
+ * @description: 扫描位图，找到优先级最高（下标最小）的非空桶
+ * @return {int} 桶下标，所有桶都为空时返回 -1
+ */
+int BucketSafeQueue::firstNonEmpty() {
+	for (size_t i = 0; i < m_bitmap.size(); ++i) {
+		if (m_bitmap[i]) {
+			return static_cast<int>(i * 64) + countTrailingZeros(m_bitmap[i]);
+		}
+	}
+	return -1;
+}
+
+
+/**
+ * @description: 从高位扫描位图，找到优先级最低（下标最大）的非空桶
+ * @return {int} 桶下标，所有桶都为空时返回 -1
+ */
+int BucketSafeQueue::lastNonEmpty() {
+	for (size_t i = m_bitmap.size(); i > 0; --i) {
+		if (m_bitmap[i - 1]) {
+			return static_cast<int>((i - 1) * 64) + highestBit(m_bitmap[i - 1]);
+		}
+	}
+	return -1;
+}
+
+
+/**
+ * @description: 向任务队列添加任务
+ * @param {Task&} task: 任务函数，入队后被移走
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 任务队列上限
+ * @return {bool} 成功入队返回 true，队列已满返回 false
+ */
+bool BucketSafeQueue::taskEnqueue(Task &task, size_t priority, size_t max_size) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_size.load(std::memory_order_relaxed) >= max_size)
+		return false;
+
+	size_t index = bucketIndex(priority);
+	m_buckets[index].push(task);
+	m_bitmap[index / 64] |= uint64_t(1) << (index % 64);
+	m_size.fetch_add(1, std::memory_order_relaxed);
+
+	TP_TRACE_DEBUG("任务已提交，当前任务数量", priority, m_size.load(std::memory_order_relaxed));
+	return true;
+}
+
+
+/**
+ * @description: 批量向任务队列添加任务，只加锁一次
+ * @param {Task*} tasks: 任务数组，入队的任务被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 任务队列上限
+ * @return {size_t} 成功入队的任务数量
+ */
+size_t BucketSafeQueue::taskEnqueueBatch(Task *tasks, size_t count, size_t priority, size_t max_size) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	size_t old_size = m_size.load(std::memory_order_relaxed);
+	size_t space = max_size > old_size ? max_size - old_size : 0;
+	size_t amount = count < space ? count : space;
+
+	if (amount == 0)
+		return 0;
+
+	size_t index = bucketIndex(priority);
+	for (size_t i = 0; i < amount; ++i) {
+		m_buckets[index].push(tasks[i]);
+	}
+	m_bitmap[index / 64] |= uint64_t(1) << (index % 64);
+	m_size.fetch_add(amount, std::memory_order_relaxed);
+
+	TP_TRACE_DEBUG("批量任务已提交，当前任务数量", amount, old_size + amount);
+	return amount;
+}
+
+
+/**
+ * @description: 用新任务替换优先级最低的非空桶中最后提交的任务，O(1)
+ * @description: 内存不足时抛出 std::bad_alloc，队列、新任务与 victim 都不变
+ * @param {Task&} task: 新任务，替换成功时被移走
+ * @param {size_t} priority: 新任务优先级
+ * @param {Task&} victim: 存放被替换出的任务
+ * @return {bool} 替换成功返回 true，队列为空或没有比新任务优先级更低的任务时返回 false
+ */
+bool BucketSafeQueue::taskReplaceLowest(Task &task, size_t priority, Task &victim) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	int lowest = lastNonEmpty();
+	size_t index = bucketIndex(priority);
+	if (lowest < 0 || static_cast<size_t>(lowest) <= index)
+		return false;
+
+	TP_TRACE_DEBUG("替换优先级最低的任务", lowest, priority);
+
+	// 先放入新任务：扩容时内存不足会抛出异常，此时新任务与被替换的任务都保持原样，不会丢失
+	m_buckets[index].push(task);
+	m_bitmap[index / 64] |= uint64_t(1) << (index % 64);
+
+	// 两个任务在不同的桶中，放入新任务不影响最低优先级桶的队尾
+	Bucket &bucket = m_buckets[lowest];
+	bucket.popBack(victim);
+	if (bucket.m_size == 0) {
+		m_bitmap[lowest / 64] &= ~(uint64_t(1) << (lowest % 64));
+	}
+	return true;
+}
+
+
+/**
+ * @description: 是否可以从任务队列取出任务，如可以取出任务
+ * @param {Task&} task: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+bool BucketSafeQueue::taskDequeue(Task &task) {
+	std::unique_lock<std::mutex> lock(m_mutex);  // 任务队列上锁
+
+	int index = firstNonEmpty();
+	if (index < 0)
+		return false;
+
+	Bucket &bucket = m_buckets[index];
+	bucket.pop(task);
+	if (bucket.m_size == 0) {
+		m_bitmap[index / 64] &= ~(uint64_t(1) << (index % 64));
+	}
+	m_size.fetch_sub(1, std::memory_order_relaxed);
+
+	TP_TRACE_DEBUG("任务已取出，任务优先级", index, m_size.load(std::memory_order_relaxed));
+	return true;
+}
@@ -3,7 +3,7 @@
  * @github: https://github.com/yuyuyuj1e
  * @csdn: https://blog.csdn.net/yuyuyuj1e
  * @date: 2023-03-15 09:22:13
- * @last_edit_time: 2023-03-31 20:50:22
+ * @last_edit_time: 2026-10-18 09:41:07
  * @file_path: /Thread-Pool/src/CppLog.cpp
  * @description: 日志模块源文件
  */
@@ -283,9 +283,14 @@ bool CppLog::parseConfig(std::string config_path) {
 
 
 /** 
- * @description: 日志文件启动函数
+ * @description: 日志文件启动函数，日志线程已在运行时只增加使用者数量
  */
 void CppLog::run() {
+    std::lock_guard<std::mutex> lock(m_run_mutex);
+    if (m_users++ > 0) {
+        return;
+    }
+
     m_start = true;  // 启动日志类
     m_thread = new std::thread(&CppLog::working, this);  // 构造线程
 }
\ No newline at end of file
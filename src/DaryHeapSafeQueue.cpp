@@ -0,0 +1,230 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 18:35:40
+ * @last_edit_time: 2026-10-17 23:16:42
+ * @file_path: /Thread-Pool/src/DaryHeapSafeQueue.cpp
+ * @description: 基于任务槽位与间接 4 叉堆的优先级队列源文件
+ */
+
+#include "DaryHeapSafeQueue.h"
+#include "Trace.h"
+
+
+/**
+ * @description: 构造函数，按最大任务量预分配槽位与堆
+ * @param {size_t} capacity: 预分配的任务数量
+ */
+DaryHeapSafeQueue::DaryHeapSafeQueue(size_t capacity)
+	: m_size(0)
+{
+	reserveSlots(capacity ? capacity : 1);
+}
+
+
+/**
+ * @description: 槽位不足时扩容，新槽位加入空闲列表，只在运行时调大任务上限后发生
+ * @param {size_t} capacity: 需要的槽位数量
+ */
+void DaryHeapSafeQueue::reserveSlots(size_t capacity) {
+	size_t old_capacity = m_slots.size();
+	if (capacity <= old_capacity) {
+		return;
+	}
+
+	m_slots.resize(capacity);
+	m_heap.reserve(capacity);
+	m_free_slots.reserve(capacity);
+
+	// 倒序放入，使小下标的槽位先被使用
+	for (size_t i = capacity; i > old_capacity; --i) {
+		m_free_slots.push_back(static_cast<uint32_t>(i - 1));
+	}
+}
+
+
+/**
+ * @description: 向上调整，空出的位置逐层上移，最后放入键，不做交换
+ * @param {size_t} start: 子节点下标
+ */
+void DaryHeapSafeQueue::siftUp(size_t start) {
+	uint64_t key = m_heap[start];
+	size_t son = start;
+
+	while (son > 0) {
+		size_t parent = (son - 1) / ARITY;
+		if (m_heap[parent] <= key) {
+			break;
+		}
+		m_heap[son] = m_heap[parent];
+		son = parent;
+	}
+
+	m_heap[son] = key;
+}
+
+
+/**
+ * @description: 向下调整，每层在至多 4 个子节点中选择最小者上移
+ * @param {size_t} start: 起始节点下标
+ */
+void DaryHeapSafeQueue::siftDown(size_t start) {
+	size_t size = m_heap.size();
+	uint64_t key = m_heap[start];
+	size_t parent = start;
+
+	while (true) {
+		size_t first_son = parent * ARITY + 1;
+		if (first_son >= size) {
+			break;
+		}
+
+		size_t last_son = first_son + ARITY < size ? first_son + ARITY : size;
+		size_t min_son = first_son;
+		for (size_t son = first_son + 1; son < last_son; ++son) {
+			if (m_heap[son] < m_heap[min_son]) {
+				min_son = son;
+			}
+		}
+
+		if (key <= m_heap[min_son]) {
+			break;
+		}
+		m_heap[parent] = m_heap[min_son];
+		parent = min_son;
+	}
+
+	m_heap[parent] = key;
+}
+
+
+/**
+ * @description: 将任务放入空闲槽位，并把键插入堆，调用前需持有 m_mutex
+ * @param {Task&} task: 任务函数，放入后被移走
+ * @param {size_t} priority: 任务优先级，超过 32 位的部分按最低优先级处理
+ */
+void DaryHeapSafeQueue::push(Task &task, size_t priority) {
+	if (m_free_slots.empty()) {
+		reserveSlots(m_slots.size() * 2);
+	}
+
+	uint32_t slot = m_free_slots.back();
+	m_free_slots.pop_back();
+	m_slots[slot] = std::move(task);
+
+	uint64_t level = priority < UINT32_MAX ? priority : UINT32_MAX;
+	m_heap.push_back((level << 32) | slot);
+	siftUp(m_heap.size() - 1);
+}
+
+
+/**
+ * @description: 向任务队列添加任务
+ * @param {Task&} task: 任务函数，入队后被移走
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 任务队列上限
+ * @return {bool} 成功入队返回 true，队列已满返回 false
+ */
+bool DaryHeapSafeQueue::taskEnqueue(Task &task, size_t priority, size_t max_size) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_heap.size() >= max_size)
+		return false;
+
+	push(task, priority);
+	m_size.store(m_heap.size(), std::memory_order_relaxed);
+
+	TP_TRACE_DEBUG("任务已提交，当前任务数量", priority, m_heap.size());
+	return true;
+}
+
+
+/**
+ * @description: 批量向任务队列添加任务，只加锁一次
+ * @param {Task*} tasks: 任务数组，入队的任务被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 任务队列上限
+ * @return {size_t} 成功入队的任务数量
+ */
+size_t DaryHeapSafeQueue::taskEnqueueBatch(Task *tasks, size_t count, size_t priority, size_t max_size) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	size_t old_size = m_heap.size();
+	size_t space = max_size > old_size ? max_size - old_size : 0;
+	size_t amount = count < space ? count : space;
+
+	for (size_t i = 0; i < amount; ++i) {
+		push(tasks[i], priority);
+	}
+	m_size.store(m_heap.size(), std::memory_order_relaxed);
+
+	TP_TRACE_DEBUG("批量任务已提交，当前任务数量", amount, m_heap.size());
+	return amount;
+}
+
+
+/**
+ * @description: 用新任务替换优先级最低的任务，只加锁一次
+ * @description: 优先级最低的键一定在叶子节点中；新任务直接复用被替换任务的槽位，替换后键变小，向上调整即可
+ * @param {Task&} task: 新任务，替换成功时被移走
+ * @param {size_t} priority: 新任务优先级
+ * @param {Task&} victim: 存放被替换出的任务
+ * @return {bool} 替换成功返回 true，队列为空或没有比新任务优先级更低的任务时返回 false
+ */
+bool DaryHeapSafeQueue::taskReplaceLowest(Task &task, size_t priority, Task &victim) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_heap.empty())
+		return false;
+
+	size_t size = m_heap.size();
+	size_t lowest = size > 1 ? (size - 2) / ARITY + 1 : 0;  // 第一个叶子节点
+	for (size_t i = lowest + 1; i < size; ++i) {
+		if ((m_heap[i] >> 32) > (m_heap[lowest] >> 32)) {
+			lowest = i;
+		}
+	}
+
+	uint64_t level = priority < UINT32_MAX ? priority : UINT32_MAX;
+	if ((m_heap[lowest] >> 32) <= level)
+		return false;
+
+	uint32_t slot = static_cast<uint32_t>(m_heap[lowest] & UINT32_MAX);
+	TP_TRACE_DEBUG("替换优先级最低的任务", m_heap[lowest] >> 32, priority);
+	victim = std::move(m_slots[slot]);
+	m_slots[slot] = std::move(task);
+	m_heap[lowest] = (level << 32) | slot;
+	siftUp(lowest);
+	return true;
+}
+
+
+/**
+ * @description: 是否可以从任务队列取出任务，如可以取出任务
+ * @param {Task&} task: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+bool DaryHeapSafeQueue::taskDequeue(Task &task) {
+	std::unique_lock<std::mutex> lock(m_mutex);  // 任务队列上锁
+
+	if (m_heap.empty())
+		return false;
+
+	uint64_t key = m_heap[0];
+	uint32_t slot = static_cast<uint32_t>(key & UINT32_MAX);
+	task = std::move(m_slots[slot]);
+	m_free_slots.push_back(slot);
+
+	// 将最后一个键放到堆顶，再向下调整
+	m_heap[0] = m_heap.back();
+	m_heap.pop_back();
+	if (!m_heap.empty()) {
+		siftDown(0);
+	}
+	m_size.store(m_heap.size(), std::memory_order_relaxed);
+
+	TP_TRACE_DEBUG("任务已取出，任务优先级", key >> 32, m_heap.size());
+	return true;
+}
@@ -3,12 +3,13 @@
  * @github: https://github.com/yuyuyuj1e
  * @csdn: https://blog.csdn.net/yuyuyuj1e
  * @date: 2023-04-05 14:53:08
- * @last_edit_time: 2023-04-05 16:08:28
+ * @last_edit_time: 2026-10-17 23:16:42
  * @file_path: /Thread-Pool/src/HeapSafeQueue.cpp
  * @description: 基于堆结构的优先级队列源文件
  */
 
 #include "HeapSafeQueue.h"
+#include "Trace.h"
 
 /** 
  * @description: 向上调整，用于向堆中插入一个数据，全局
@@ -29,10 +30,8 @@ void HeapSafeQueue::siftUp(int start) {
 			break;
 		}
 		else {
-			// 交换父子节点
-			std::pair<std::function<void()>, int> temp = m_queue[son];
-			m_queue[son] = m_queue[parent];
-			m_queue[parent] = temp;
+			// 交换父子节点，Task 只可移动，通过 swap 交换
+			std::swap(m_queue[son], m_queue[parent]);
 
 			// 获取下一轮父子节点下标
 			son = parent;  // 子节点(本节点)新下标
@@ -65,9 +64,7 @@ void HeapSafeQueue::siftDown(int start, int end) {
 		}
 		else {
 			// 交换节点
-			std::pair<std::function<void()>, int> temp = m_queue[son];
-			m_queue[son] = m_queue[parent];
-			m_queue[parent] = temp;
+			std::swap(m_queue[son], m_queue[parent]);
 
 			// 更新下标
 			parent = son;  // 父节点(本节点)的新下标
@@ -79,36 +76,132 @@ void HeapSafeQueue::siftDown(int start, int end) {
 
 /**
  * @description: 向任务队列添加任务
- * @param {std::function<void()>&} task: 任务函数
+ * @param {Task&} task: 任务函数，入队后被移走
  * @param {size_t} priority: 任务优先级
  */
-void HeapSafeQueue::taskEnqueue(std::function<void()> &task, size_t priority) {
+void HeapSafeQueue::taskEnqueue(Task &task, size_t priority) {
 	std::unique_lock<std::mutex> lock(m_mutex);
 
-	std::pair<std::function<void()>, int> priority_task(task, priority);  // 将任务与优先级打包
-	m_queue.emplace_back(priority_task);  // 放入任务队列
+	m_queue.emplace_back(std::move(task), priority);  // 将任务与优先级打包，放入任务队列
     siftUp(m_queue.size() - 1);  // 向上调整
 
-	std::cout << "任务已提交，当前任务数量为: " << m_queue.size() << std::endl;
+	TP_TRACE_DEBUG("任务已提交，当前任务数量", priority, m_queue.size());
+}
+
+
+/**
+ * @description: 向任务队列添加任务，队列大小的判断与入队在同一次加锁中完成
+ * @param {Task&} task: 任务函数，入队后被移走
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 任务队列上限
+ * @return {bool} 成功入队返回 true，队列已满返回 false
+ */
+bool HeapSafeQueue::taskEnqueue(Task &task, size_t priority, size_t max_size) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_queue.size() >= max_size)
+		return false;
+
+	m_queue.emplace_back(std::move(task), priority);  // 将任务与优先级打包，放入任务队列
+    siftUp(m_queue.size() - 1);  // 向上调整
+
+	TP_TRACE_DEBUG("任务已提交，当前任务数量", priority, m_queue.size());
+	return true;
+}
+
+
+/**
+ * @description: 批量向任务队列添加任务，只加锁一次
+ * @description: 追加的任务多于已有任务时，自底向上整体建堆 O(n)；否则逐个向上调整
+ * @param {Task*} tasks: 任务数组，入队的任务被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 任务队列上限
+ * @return {size_t} 成功入队的任务数量
+ */
+size_t HeapSafeQueue::taskEnqueueBatch(Task *tasks, size_t count, size_t priority, size_t max_size) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	size_t old_size = m_queue.size();
+	size_t space = max_size > old_size ? max_size - old_size : 0;
+	size_t amount = count < space ? count : space;
+
+	if (amount == 0)
+		return 0;
+
+	m_queue.reserve(old_size + amount);
+	for (size_t i = 0; i < amount; ++i) {
+		m_queue.emplace_back(std::move(tasks[i]), priority);
+	}
+
+	if (amount > old_size) {
+		// 从最后一个非叶子节点开始，依次向下调整
+		for (int i = static_cast<int>(m_queue.size()) / 2 - 1; i >= 0; --i) {
+			siftDown(i, m_queue.size() - 1);
+		}
+	}
+	else {
+		for (size_t i = old_size; i < m_queue.size(); ++i) {
+			siftUp(i);
+		}
+	}
+
+	TP_TRACE_DEBUG("批量任务已提交，当前任务数量", amount, m_queue.size());
+	return amount;
+}
+
+
+/**
+ * @description: 用新任务替换优先级最低的任务，只加锁一次
+ * @description: 优先级最低的任务一定是叶子节点，只需扫描后一半；替换后优先级变高，向上调整即可
+ * @param {Task&} task: 新任务，替换成功时被移走
+ * @param {size_t} priority: 新任务优先级
+ * @param {Task&} victim: 存放被替换出的任务
+ * @return {bool} 替换成功返回 true，队列为空或没有比新任务优先级更低的任务时返回 false
+ */
+bool HeapSafeQueue::taskReplaceLowest(Task &task, size_t priority, Task &victim) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_queue.empty())
+		return false;
+
+	size_t lowest = m_queue.size() / 2;
+	for (size_t i = lowest + 1; i < m_queue.size(); ++i) {
+		if (m_queue[i].second > m_queue[lowest].second) {
+			lowest = i;
+		}
+	}
+
+	if (static_cast<size_t>(m_queue[lowest].second) <= priority)
+		return false;
+
+	TP_TRACE_DEBUG("替换优先级最低的任务", m_queue[lowest].second, priority);
+	victim = std::move(m_queue[lowest].first);
+	m_queue[lowest].first = std::move(task);
+	m_queue[lowest].second = priority;
+	siftUp(lowest);
+	return true;
 }
 
 
 /**
  * @description: 是否可以从任务队列取出任务，如可以取出任务
- * @param {std::function<void()>&} task: 获取任务函数的空函数
+ * @param {Task&} task: 获取任务函数的空函数
  * @return {bool} true/false
  */
-bool HeapSafeQueue::taskDequeue(std::function<void()> &task) {
+bool HeapSafeQueue::taskDequeue(Task &task) {
 	std::unique_lock<std::mutex> lock(m_mutex);  // 任务队列上锁
 
 	if (m_queue.empty())
 		return false;
 
 	task = std::move(m_queue[0].first);  // 取出队首元素，返回队首元素值，并进行右值引用
-    std::cout << "任务优先级为：" << m_queue[0].second << std::endl;
+    TP_TRACE_DEBUG("任务已取出，任务优先级", m_queue[0].second, m_queue.size());
 
-    m_queue[0] = m_queue[m_queue.size() - 1];  // 将最后一个元素，放到堆顶；注意，此时堆的特性已经被破坏，需要重新维护
-	m_queue.erase(m_queue.end() - 1);  // 弹出任务
+    if (m_queue.size() > 1) {
+        m_queue[0] = std::move(m_queue[m_queue.size() - 1]);  // 将最后一个元素，放到堆顶；注意，此时堆的特性已经被破坏，需要重新维护
+    }
+	m_queue.pop_back();  // 弹出任务
     
     siftDown(0, m_queue.size() - 1);
 	return true;
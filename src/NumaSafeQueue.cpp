@@ -0,0 +1,146 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 10:31:54
+ * @last_edit_time: 2026-10-18 10:31:54
+ * @file_path: /Thread-Pool/src/NumaSafeQueue.cpp
+ * @description: 按 NUMA 节点划分的任务队列源文件
+ */
+
+#include "NumaSafeQueue.h"
+#include "Affinity.h"
+#include <algorithm>
+#include <limits>
+
+
+static const size_t UNBOUNDED = std::numeric_limits<size_t>::max();  // 子队列不再检查上限，由 m_size 统一限制
+
+
+/**
+ * @description: 构造函数
+ * @param {std::vector<std::unique_ptr<TaskQueue>>} queues: 每个节点的子队列，应由绑定到该节点的线程创建，使其内存分配在本节点
+ */
+NumaSafeQueue::NumaSafeQueue(std::vector<std::unique_ptr<TaskQueue>> queues)
+	: m_queues(std::move(queues))
+	, m_size(0)
+{ }
+
+
+/**
+ * @description: 在任务上限内预留位置
+ * @param {size_t} count: 需要的位置数量
+ * @param {size_t} max_size: 任务队列上限
+ * @return {size_t} 预留成功的数量，可能少于 count
+ */
+size_t NumaSafeQueue::reserve(size_t count, size_t max_size) {
+	size_t size = m_size.load(std::memory_order_relaxed);
+
+	while (size < max_size) {
+		size_t amount = std::min(count, max_size - size);
+		if (m_size.compare_exchange_weak(size, size + amount)) {
+			return amount;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * @description: 当前线程所在节点的子队列下标，工作线程绑定了节点时不需要查询所在 CPU
+ * @return {size_t} 子队列下标
+ */
+size_t NumaSafeQueue::localQueue() {
+	return static_cast<size_t>(CpuTopology::currentNode()) % m_queues.size();
+}
+
+
+/**
+ * @description: 向本节点子队列添加任务，本节点子队列已满 (环形队列容量用尽) 时放入其他节点
+ * @param {Task&} task: 任务函数，入队后被移走
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 所有节点的任务总数上限
+ * @return {bool} 成功入队返回 true，已达上限返回 false
+ */
+bool NumaSafeQueue::taskEnqueue(Task &task, size_t priority, size_t max_size) {
+	if (reserve(1, max_size) == 0) {
+		return false;
+	}
+
+	size_t local = localQueue();
+	for (size_t i = 0; i < m_queues.size(); ++i) {
+		if (m_queues[(local + i) % m_queues.size()]->taskEnqueue(task, priority, UNBOUNDED)) {
+			return true;
+		}
+	}
+
+	m_size.fetch_sub(1);
+	return false;
+}
+
+
+/**
+ * @description: 取出任务，先取本节点子队列，为空时依次尝试其他节点
+ * @param {Task&} task: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+bool NumaSafeQueue::taskDequeue(Task &task) {
+	size_t local = localQueue();
+
+	for (size_t i = 0; i < m_queues.size(); ++i) {
+		if (m_queues[(local + i) % m_queues.size()]->taskDequeue(task)) {
+			m_size.fetch_sub(1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @description: 批量添加任务到本节点子队列
+ * @param {Task*} tasks: 任务数组，入队的任务被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @param {size_t} max_size: 所有节点的任务总数上限
+ * @return {size_t} 成功入队的任务数量，入队的总是前若干个任务
+ */
+size_t NumaSafeQueue::taskEnqueueBatch(Task *tasks, size_t count, size_t priority, size_t max_size) {
+	size_t reserved = reserve(count, max_size);
+	if (reserved == 0) {
+		return 0;
+	}
+
+	size_t local = localQueue();
+	size_t enqueued = 0;
+	for (size_t i = 0; i < m_queues.size() && enqueued < reserved; ++i) {
+		enqueued += m_queues[(local + i) % m_queues.size()]->taskEnqueueBatch(tasks + enqueued, reserved - enqueued, priority, UNBOUNDED);
+	}
+
+	if (enqueued < reserved) {
+		m_size.fetch_sub(reserved - enqueued);
+	}
+	return enqueued;
+}
+
+
+/**
+ * @description: 用新任务替换优先级最低的任务，先在本节点子队列中替换，不支持或没有更低优先级的任务时尝试其他节点
+ * @param {Task&} task: 新任务，替换成功时被移走
+ * @param {size_t} priority: 新任务优先级
+ * @param {Task&} victim: 存放被替换出的任务
+ * @return {bool} 替换成功返回 true，任务总数不变
+ */
+bool NumaSafeQueue::taskReplaceLowest(Task &task, size_t priority, Task &victim) {
+	size_t local = localQueue();
+
+	for (size_t i = 0; i < m_queues.size(); ++i) {
+		if (m_queues[(local + i) % m_queues.size()]->taskReplaceLowest(task, priority, victim)) {
+			return true;
+		}
+	}
+
+	return false;
+}
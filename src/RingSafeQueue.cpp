@@ -0,0 +1,118 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 11:05:51
+ * @last_edit_time: 2026-10-17 13:41:09
+ * @file_path: /Thread-Pool/src/RingSafeQueue.cpp
+ * @description: 无锁有界多生产者多消费者环形队列源文件
+ */
+
+#include "RingSafeQueue.h"
+
+
+/**
+ * @description: 构造函数，第 i 个槽位的初始序号为 i
+ * @param {size_t} capacity: 队列容量，会向上取整为 2 的幂
+ */
+RingSafeQueue::RingSafeQueue(size_t capacity)
+	: m_enqueue_pos(0)
+	, m_dequeue_pos(0)
+{
+	size_t real_capacity = 2;
+	while (real_capacity < capacity) {
+		real_capacity <<= 1;
+	}
+
+	m_buffer = std::vector<Cell>(real_capacity);
+	m_mask = real_capacity - 1;
+
+	for (size_t i = 0; i < real_capacity; ++i) {
+		m_buffer[i].m_sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+
+/**
+ * @description: 向任务队列添加任务
+ * @description: 槽位序号等于生产者位置时可写入，写入后序号加一交给消费者
+ * @param {Task&} task: 任务函数，入队后被移走
+ * @param {size_t} priority: 任务优先级，环形队列不区分优先级
+ * @param {size_t} max_size: 任务队列上限，超过容量时以容量为准
+ * @return {bool} 成功入队返回 true，队列已满返回 false
+ */
+bool RingSafeQueue::taskEnqueue(Task &task, size_t priority, size_t max_size) {
+	(void)priority;
+
+	if (size() >= max_size) {
+		return false;
+	}
+
+	Cell* cell = nullptr;
+	size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+	while (true) {
+		cell = &m_buffer[pos & m_mask];
+		size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+		if (diff == 0) {
+			// 槽位可写，抢占生产者位置
+			if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (diff < 0) {
+			// 槽位还未被消费，队列已满
+			return false;
+		}
+		else {
+			// 位置已被其他生产者抢占
+			pos = m_enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->m_task = std::move(task);
+	cell->m_sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+
+/**
+ * @description: 是否可以从任务队列取出任务，如可以取出任务
+ * @description: 槽位序号等于消费者位置加一时可读取，读取后序号加上容量交还给生产者
+ * @param {Task&} task: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+bool RingSafeQueue::taskDequeue(Task &task) {
+	Cell* cell = nullptr;
+	size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+
+	while (true) {
+		cell = &m_buffer[pos & m_mask];
+		size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+		if (diff == 0) {
+			// 槽位可读，抢占消费者位置
+			if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (diff < 0) {
+			// 槽位还未写入，队列为空
+			return false;
+		}
+		else {
+			// 位置已被其他消费者抢占
+			pos = m_dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	task = std::move(cell->m_task);
+	cell->m_task = nullptr;
+	cell->m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+
+	return true;
+}
@@ -0,0 +1,129 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 21:48:05
+ * @last_edit_time: 2026-10-19 10:21:35
+ * @file_path: /Thread-Pool/src/Scaler.cpp
+ * @description: MUTABLE_THREAD 模式下的扩缩容线程，根据采样结果在线程上下限之间增删工作线程
+ */
+
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+
+static const double SAMPLE_WEIGHT = 0.5;  // 指数移动平均中新样本的权重
+
+
+/**
+ * @description: 扩缩容线程的工作函数
+ * @description: 每隔 scale_interval 采样一次繁忙比例、到达速率与排队时长 (提交者被阻塞时立即采样)
+ * @description: 持续过载超过 grow_timeout 后每次采样增加一个线程 (优先唤醒后备池中的线程)；持续空闲超过 shrink_timeout 后减少一个线程，由空闲的工作线程停放到后备池
+ * @description: 后备池中停放超过 reserve_timeout 的线程才会真正退出并被回收
+ * @description: 过载与空闲的繁忙比例阈值之间留有区间，避免线程数量来回抖动
+ */
+void ThreadPool::scaling() {
+	typedef std::chrono::steady_clock clock;
+	const ThreadPoolConfig* config = m_config;
+
+	clock::time_point last_sample = clock::now();
+	clock::time_point overload_since = last_sample;  // 开始过载的时间
+	clock::time_point idle_since = last_sample;  // 开始空闲的时间
+	bool overloaded = false;
+	bool idle = false;
+	size_t last_submitted = 0;  // 扩缩容线程开始运行前提交的任务也计入第一次采样
+	double busy_ratio = 0;
+	double arrival_rate = 0;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_start) {
+		m_scale_cv.wait_for(lock, config->m_scale_interval);
+		if (!m_start) {
+			break;
+		}
+
+		clock::time_point now = clock::now();
+		double elapsed = std::chrono::duration<double>(now - last_sample).count();
+		if (elapsed <= 0) {
+			continue;
+		}
+		last_sample = now;
+
+		// 到达速率
+		size_t submitted = m_submitted.load(std::memory_order_relaxed);
+		arrival_rate = (1 - SAMPLE_WEIGHT) * arrival_rate + SAMPLE_WEIGHT * ((submitted - last_submitted) / elapsed);
+		last_submitted = submitted;
+
+		// 繁忙比例，休眠中的线程视为空闲
+		size_t threads = m_thread_amount;
+		size_t idle_threads = std::min(static_cast<size_t>(std::max(m_idle_threads.load(), 0)), threads);
+		double busy = threads ? static_cast<double>(threads - idle_threads) / threads : 0;
+		busy_ratio = (1 - SAMPLE_WEIGHT) * busy_ratio + SAMPLE_WEIGHT * busy;
+
+		// 排队时长，由 Little 定律估计；有任务排队却没有新任务到达时，至少已经等待了一个采样间隔
+		size_t pending = m_queue->size();
+		for (size_t i = 0; i < m_deques.size(); ++i) {
+			pending += m_deques[i]->size();
+		}
+		double queue_wait = 0;
+		if (pending) {
+			queue_wait = arrival_rate > 0 ? pending / arrival_rate * 1000 : elapsed * 1000;
+		}
+
+		m_scaling_statistics.m_threads = threads;
+		m_scaling_statistics.m_pending = pending;
+		m_scaling_statistics.m_busy_ratio = busy_ratio;
+		m_scaling_statistics.m_arrival_rate = arrival_rate;
+		m_scaling_statistics.m_queue_wait = queue_wait;
+
+		// 回收后备池中停放过久的线程，join 期间会释放 m_mutex
+		reapReserve(lock);
+		if (!m_start) {
+			break;
+		}
+
+		// 过载：线程几乎都在工作，且任务排队过久或有提交者被阻塞
+		bool is_overloaded = busy_ratio >= config->m_grow_utilization
+			&& (queue_wait >= config->m_target_queue_wait.count() || m_blocked_submitters > 0);
+		// 空闲：大部分线程在休眠，且没有任务排队
+		bool is_idle = busy_ratio <= config->m_shrink_utilization && pending == 0;
+
+		if (is_overloaded && !overloaded) {
+			overload_since = now;
+		}
+		if (is_idle && !idle) {
+			idle_since = now;
+		}
+		overloaded = is_overloaded;
+		idle = is_idle;
+
+		size_t effective_threads = threads - std::min(m_retire_requests, threads);
+
+		if (overloaded && now - overload_since >= config->m_grow_timeout && effective_threads < config->m_max_threshold) {
+			// 还有线程尚未退出时，直接取消退出请求
+			if (m_retire_requests > 0) {
+				m_retire_requests--;
+			}
+			else if (addWorker()) {
+				size_t threads_amount = m_thread_amount;
+				TP_TRACE_INFO("已动态添加新线程，当前线程数量", threads_amount, m_config->m_max_threshold);
+#ifdef DEBUG
+				std::cout << "已动态添加新线程，当前线程数量为: " << threads_amount << "  ----->   " << m_config->m_max_threshold << std::endl;
+#else
+				std::string log_task = "已动态添加新线程，当前线程数量为: " + std::to_string(threads_amount);
+				m_log->addTask(log_task);
+#endif
+			}
+		}
+		else if (idle && now - idle_since >= config->m_shrink_timeout && effective_threads > config->m_min_threshold) {
+			// 由休眠中的线程停放到后备池，每个 shrink_timeout 最多减少一个线程
+			m_retire_requests++;
+			m_queue_not_empty.notify_one();
+			idle_since = now;
+		}
+	}
+
+	// 线程池关闭时，未完成的退出请求作废，所有线程执行完任务后统一退出
+	m_retire_requests = 0;
+}
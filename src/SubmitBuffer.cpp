@@ -0,0 +1,334 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 20:14:37
+ * @last_edit_time: 2026-10-20 10:12:35
+ * @file_path: /Thread-Pool/src/SubmitBuffer.cpp
+ * @description: 线程私有的提交缓冲区，任务先在缓冲区中积攒，再批量放入共享任务队列
+ */
+
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <iterator>
+
+
+/**
+ * @description: 提交缓冲区，每个提交线程对每个线程池各持有一个
+ * @description: 缓冲区锁几乎只被所属线程获取，只有定时入队线程与关闭线程池时才会竞争；持有缓冲区锁时只取出或放回任务，入队在释放锁之后进行
+ * @description: 所属线程退出后缓冲区被摘除 (m_pool 为 nullptr)，定时入队线程放回的任务仍留在注册表中，之后由定时入队线程或关闭线程池时入队
+ */
+struct ThreadPool::SubmitBuffer {
+	std::mutex m_mutex;  // 缓冲区锁
+	std::atomic<ThreadPool*> m_pool;  // 所属线程池，为 nullptr 表示已被摘除
+	std::vector<Task> m_tasks;  // 缓冲的任务
+	std::vector<size_t> m_priorities;  // 缓冲任务的优先级
+	std::chrono::steady_clock::time_point m_first;  // 最早一个缓冲任务的放入时间
+
+	explicit SubmitBuffer(ThreadPool* pool) : m_pool(pool) { }
+};
+
+
+/**
+ * @description: 当前线程持有的所有缓冲区，线程退出时将缓冲区中的任务入队并摘除
+ */
+struct ThreadPool::LocalSubmitBuffers {
+	std::vector<std::shared_ptr<SubmitBuffer>> m_buffers;
+
+	~LocalSubmitBuffers() {
+		// 工作线程退出时已归还槽位，任务改为放入全局队列
+		m_local_pool = nullptr;
+
+		for (auto &buffer : m_buffers) {
+			std::unique_lock<std::mutex> lock(buffer->m_mutex);
+			ThreadPool* pool = buffer->m_pool.exchange(nullptr);
+			if (pool == nullptr) {
+				continue;
+			}
+			try {
+				pool->flushSubmitBuffer(*buffer, lock);
+			}
+			catch (...) {
+				// 线程池关闭前会先摘除所有缓冲区，这里只是防止析构函数抛出异常
+			}
+		}
+	}
+};
+
+
+thread_local ThreadPool::LocalSubmitBuffers ThreadPool::m_local_buffers;
+
+
+/**
+ * @description: 获取当前线程在本线程池的提交缓冲区，第一次使用时注册，并启动定时入队线程
+ * @return {SubmitBuffer*} 当前线程的缓冲区
+ */
+ThreadPool::SubmitBuffer* ThreadPool::localSubmitBuffer() {
+	std::vector<std::shared_ptr<SubmitBuffer>> &buffers = m_local_buffers.m_buffers;
+
+	for (auto &buffer : buffers) {
+		if (buffer->m_pool == this) {
+			return buffer.get();
+		}
+	}
+
+	// 顺便清理已被摘除的缓冲区
+	buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+		[](const std::shared_ptr<SubmitBuffer> &buffer) { return buffer->m_pool == nullptr; }), buffers.end());
+
+	std::shared_ptr<SubmitBuffer> buffer = std::make_shared<SubmitBuffer>(this);
+	{
+		std::unique_lock<std::mutex> lock(m_buffer_mutex);
+		if (m_flusher_stop) {
+			throw std::runtime_error("ThreadPool is already colsed");
+		}
+		if (!m_flusher.joinable()) {
+			m_flusher = std::thread(&ThreadPool::flushing, this);
+		}
+		m_submit_buffers.push_back(buffer);
+	}
+	buffers.push_back(buffer);
+
+	return buffer.get();
+}
+
+
+/**
+ * @description: 任务放入当前线程的提交缓冲区，缓冲区满时批量入队
+ * @param {Task&} task: 任务函数，放入后被移走
+ * @param {size_t} priority: 任务优先级
+ */
+void ThreadPool::bufferTask(Task &task, size_t priority) {
+	throwIfClosed();
+
+	SubmitBuffer* buffer = localSubmitBuffer();
+	std::unique_lock<std::mutex> lock(buffer->m_mutex);
+
+	// 缓冲区已在关闭线程池时被摘除，直接入队
+	if (buffer->m_pool != this) {
+		lock.unlock();
+		enqueueTask(task, priority);
+		return;
+	}
+
+	if (buffer->m_tasks.empty()) {
+		buffer->m_first = std::chrono::steady_clock::now();
+
+		// 缓冲区由空变为非空，通知定时入队线程开始计时
+		{
+			std::lock_guard<std::mutex> guard(m_buffer_mutex);
+			m_flush_generation++;
+		}
+		m_flush_cv.notify_one();
+	}
+
+	buffer->m_tasks.push_back(std::move(task));
+	buffer->m_priorities.push_back(priority);
+
+	if (buffer->m_tasks.size() >= m_config->m_submit_buffer_size) {
+		flushSubmitBuffer(*buffer, lock);
+	}
+}
+
+
+/**
+ * @description: 取出缓冲区中的任务，释放缓冲区锁后批量入队，优先级相同的连续任务作为一批
+ * @description: 入队时可能等待任务队列空出位置或执行拒绝策略 (CALLER_RUNS 下在当前线程执行任务，任务中可以再次向缓冲区提交)，因此不持有缓冲区锁
+ * @description: 拒绝策略抛出异常时，尚未入队的任务被丢弃，异常传给调用者
+ * @param {SubmitBuffer&} buffer: 缓冲区
+ * @param {std::unique_lock<std::mutex>&} lock: 已持有的缓冲区锁，返回时已释放
+ */
+void ThreadPool::flushSubmitBuffer(SubmitBuffer &buffer, std::unique_lock<std::mutex> &lock) {
+	std::vector<Task> tasks;
+	std::vector<size_t> priorities;
+	tasks.swap(buffer.m_tasks);
+	priorities.swap(buffer.m_priorities);
+	lock.unlock();
+
+	enqueueBuffered(tasks, priorities);
+}
+
+
+/**
+ * @description: 从缓冲区取出的任务批量入队，优先级相同的连续任务作为一批，调用时不持有任何缓冲区锁
+ * @param {std::vector<Task>&} tasks: 任务，入队后被移走
+ * @param {std::vector<size_t>&} priorities: 对应的优先级
+ */
+void ThreadPool::enqueueBuffered(std::vector<Task> &tasks, std::vector<size_t> &priorities) {
+	size_t begin = 0;
+	while (begin < tasks.size()) {
+		size_t end = begin + 1;
+		while (end < tasks.size() && priorities[end] == priorities[begin]) {
+			++end;
+		}
+		enqueueBatch(tasks.data() + begin, end - begin, priorities[begin]);
+		begin = end;
+	}
+}
+
+
+/**
+ * @description: 定时入队线程将停留过久的任务入队：取出后释放缓冲区锁，逐个以不等待的方式入队
+ * @description: 不执行拒绝策略，也不等待任务队列空出位置，任务不会在定时入队线程上执行；未能入队的任务按原顺序放回缓冲区，下一轮再试
+ * @description: 入队抛出的异常 (如内存不足) 交给 handleException，剩余任务同样放回
+ * @param {SubmitBuffer&} buffer: 缓冲区
+ * @param {std::chrono::steady_clock::time_point} now: 本轮检查的时间
+ * @return {bool} 缓冲区中仍有任务 (未到期或被放回) 返回 true
+ */
+bool ThreadPool::flushExpiredBuffer(SubmitBuffer &buffer, std::chrono::steady_clock::time_point now) {
+	std::vector<Task> tasks;
+	std::vector<size_t> priorities;
+	std::chrono::steady_clock::time_point first;
+	{
+		std::lock_guard<std::mutex> guard(buffer.m_mutex);
+		if (buffer.m_tasks.empty()) {
+			return false;
+		}
+		if (now - buffer.m_first < m_config->m_submit_buffer_delay) {
+			return true;
+		}
+		TP_TRACE_DEBUG("缓冲任务超时入队", 0, buffer.m_tasks.size());
+		tasks.swap(buffer.m_tasks);
+		priorities.swap(buffer.m_priorities);
+		first = buffer.m_first;
+	}
+
+	size_t enqueued = 0;
+	std::exception_ptr exception;
+	try {
+		while (enqueued < tasks.size() && enqueueUntil(tasks[enqueued], priorities[enqueued], std::chrono::steady_clock::time_point::min())) {
+			++enqueued;
+		}
+	}
+	catch (...) {
+		exception = std::current_exception();
+	}
+
+	if (enqueued < tasks.size()) {
+		// 放回缓冲区最前面，保持提交顺序；期间所属线程新放入的任务排在后面
+		std::lock_guard<std::mutex> guard(buffer.m_mutex);
+		buffer.m_tasks.insert(buffer.m_tasks.begin(),
+			std::make_move_iterator(tasks.begin() + enqueued), std::make_move_iterator(tasks.end()));
+		buffer.m_priorities.insert(buffer.m_priorities.begin(), priorities.begin() + enqueued, priorities.end());
+		buffer.m_first = first;
+	}
+
+	if (exception) {
+		handleException(exception);
+	}
+	return enqueued < tasks.size();
+}
+
+
+/**
+ * @description: 将所有缓冲区中的任务入队
+ * @param {bool} detach: 是否停止定时入队线程并摘除所有缓冲区，关闭线程池时使用
+ */
+void ThreadPool::flushAllSubmitBuffers(bool detach) {
+	std::vector<std::shared_ptr<SubmitBuffer>> buffers;
+	std::thread flusher;
+
+	{
+		std::unique_lock<std::mutex> lock(m_buffer_mutex);
+		buffers = m_submit_buffers;
+		if (detach) {
+			m_flusher_stop = true;
+			m_submit_buffers.clear();
+			flusher = std::move(m_flusher);
+		}
+	}
+
+	if (flusher.joinable()) {
+		m_flush_cv.notify_all();
+		flusher.join();
+	}
+
+	// 等待定时入队线程把本轮取出的任务入队或放回，再取出所有缓冲区中的任务，之后缓冲区外不再有未入队的任务
+	// 注册表中的缓冲区都属于本线程池，所属线程已退出的缓冲区中可能还有放回的任务
+	std::vector<Task> tasks;
+	std::vector<size_t> priorities;
+	{
+		std::lock_guard<std::mutex> flushing_lock(m_flushing_mutex);
+		for (auto &buffer : buffers) {
+			std::lock_guard<std::mutex> lock(buffer->m_mutex);
+			if (detach) {
+				buffer->m_pool = nullptr;
+			}
+			tasks.insert(tasks.end(), std::make_move_iterator(buffer->m_tasks.begin()), std::make_move_iterator(buffer->m_tasks.end()));
+			priorities.insert(priorities.end(), buffer->m_priorities.begin(), buffer->m_priorities.end());
+			buffer->m_tasks.clear();
+			buffer->m_priorities.clear();
+		}
+	}
+
+	// 入队可能等待或执行拒绝策略，不持有任何缓冲区锁
+	enqueueBuffered(tasks, priorities);
+}
+
+
+/**
+ * @description: 将当前线程缓冲区中的任务全部入队
+ */
+void ThreadPool::flush() {
+	for (auto &buffer : m_local_buffers.m_buffers) {
+		if (buffer->m_pool != this) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(buffer->m_mutex);
+		if (buffer->m_pool == this) {
+			flushSubmitBuffer(*buffer, lock);
+		}
+		return;
+	}
+}
+
+
+/**
+ * @description: 定时入队线程的工作函数
+ * @description: 所有缓冲区都为空时一直休眠；否则每隔 submit_buffer_delay 检查一次，将停留过久的任务入队，并清理已被摘除且为空的缓冲区
+ * @description: 检查期间持有 m_flushing_mutex，不持有注册表锁，所属线程放入任务时不会被阻塞
+ */
+void ThreadPool::flushing() {
+	std::unique_lock<std::mutex> lock(m_buffer_mutex);
+	bool pending = true;  // 上一次检查时是否还有缓冲的任务
+	size_t generation = m_flush_generation;  // 上一次检查前的缓冲区变化次数
+
+	while (!m_flusher_stop) {
+		if (pending) {
+			m_flush_cv.wait_for(lock, m_config->m_submit_buffer_delay);
+		}
+		else {
+			m_flush_cv.wait(lock, [this, generation] { return m_flusher_stop || m_flush_generation != generation; });
+		}
+		if (m_flusher_stop) {
+			break;
+		}
+
+		// 检查期间有缓冲区由空变为非空时，下一轮不会一直休眠
+		generation = m_flush_generation;
+		std::vector<std::shared_ptr<SubmitBuffer>> buffers(m_submit_buffers);
+		lock.unlock();
+
+		pending = false;
+		std::vector<std::shared_ptr<SubmitBuffer>> detached;  // 已被摘除且为空的缓冲区
+		{
+			std::lock_guard<std::mutex> flushing_lock(m_flushing_mutex);
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			for (auto &buffer : buffers) {
+				if (flushExpiredBuffer(*buffer, now)) {
+					pending = true;
+				}
+				else if (buffer->m_pool == nullptr) {
+					detached.push_back(buffer);
+				}
+			}
+		}
+
+		lock.lock();
+		m_submit_buffers.erase(std::remove_if(m_submit_buffers.begin(), m_submit_buffers.end(),
+			[&detached](const std::shared_ptr<SubmitBuffer> &buffer) {
+				return std::find(detached.begin(), detached.end(), buffer) != detached.end();
+			}), m_submit_buffers.end());
+	}
+}
@@ -0,0 +1,281 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 11:20:43
+ * @last_edit_time: 2026-10-18 11:20:43
+ * @file_path: /Thread-Pool/src/TaskArena.cpp
+ * @description: 线程私有的分块内存池源文件
+ */
+
+#include "TaskArena.h"
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+
+static thread_local TaskArena* t_arena = nullptr;  // 当前线程的内存池，平凡类型，线程退出过程中仍可安全读取
+static thread_local bool t_exited = false;  // 当前线程的内存池已被挂起，之后的分配改用 malloc
+static std::atomic<size_t> g_large_allocations(0);  // 改用 malloc 的次数
+
+
+/**
+ * @description: 所有内存池的注册表，永不析构，保证进程退出时线程仍可以挂起内存池
+ */
+struct ArenaRegistry {
+	std::mutex m_mutex;
+	std::vector<TaskArena*> m_arenas;  // 所有内存池
+	std::vector<TaskArena*> m_orphans;  // 线程已退出、等待接管的内存池
+};
+
+static ArenaRegistry &registry() {
+	static ArenaRegistry* registry = new ArenaRegistry();
+	return *registry;
+}
+
+
+/**
+ * @description: 线程退出时挂起内存池，交给之后新建的线程接管
+ */
+struct TaskArena::Holder {
+	~Holder() {
+		if (t_arena) {
+			ArenaRegistry &arenas = registry();
+			std::lock_guard<std::mutex> lock(arenas.m_mutex);
+			arenas.m_orphans.push_back(t_arena);
+		}
+		t_arena = nullptr;
+		t_exited = true;
+	}
+};
+
+
+/**
+ * @description: 构造函数，第一次分配时才申请大块
+ */
+TaskArena::TaskArena()
+	: m_remote(nullptr)
+	, m_cursor(nullptr)
+	, m_end(nullptr)
+	, m_allocations(0)
+	, m_bytes(0)
+	, m_remote_frees(0)
+	, m_reserved(0)
+{
+	for (size_t i = 0; i < CLASSES; ++i) {
+		m_free[i] = nullptr;
+	}
+}
+
+
+/**
+ * @description: 当前线程的内存池，第一次调用时优先接管已退出线程的内存池
+ * @return {TaskArena*} 内存池，线程已进入退出流程时返回 nullptr
+ */
+TaskArena* TaskArena::local() {
+	if (t_arena) {
+		return t_arena;
+	}
+	if (t_exited) {
+		return nullptr;
+	}
+
+	static thread_local Holder holder;
+	(void)holder;
+
+	ArenaRegistry &arenas = registry();
+	std::lock_guard<std::mutex> lock(arenas.m_mutex);
+	if (!arenas.m_orphans.empty()) {
+		t_arena = arenas.m_orphans.back();
+		arenas.m_orphans.pop_back();
+	}
+	else {
+		t_arena = new TaskArena();
+		arenas.m_arenas.push_back(t_arena);
+	}
+
+	return t_arena;
+}
+
+
+/**
+ * @description: 字节数对应的分级，块大小依次为 32、64 ... 1024 字节 (含 16 字节块头)
+ * @param {size_t} size: 用户请求的字节数
+ * @return {size_t} 分级下标，超过最大分级返回 CLASSES
+ */
+size_t TaskArena::classOf(size_t size) {
+	size_t total = size + sizeof(Header);
+	size_t block = MIN_BLOCK;
+	size_t index = 0;
+
+	while (block < total && index < CLASSES) {
+		block <<= 1;
+		++index;
+	}
+
+	return index;
+}
+
+
+/**
+ * @description: 分级对应的块大小
+ * @param {size_t} index: 分级下标
+ * @return {size_t} 块大小，含块头
+ */
+size_t TaskArena::blockSize(size_t index) {
+	return MIN_BLOCK << index;
+}
+
+
+/**
+ * @description: 分配内存：不超过最大分级时从当前线程的内存池分配，否则使用 malloc
+ * @param {size_t} size: 字节数
+ * @return {void*} 按 max_align_t 对齐的内存，失败时抛出 std::bad_alloc
+ */
+void* TaskArena::allocate(size_t size) {
+	size_t index = classOf(size);
+	TaskArena* arena = index < CLASSES ? local() : nullptr;
+
+	if (arena) {
+		return arena->allocateBlock(index);
+	}
+
+	Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+	if (!header) {
+		throw std::bad_alloc();
+	}
+	header->m_arena = nullptr;
+	header->m_class = CLASSES;
+	g_large_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return header + 1;
+}
+
+
+/**
+ * @description: 释放内存，所属线程直接放回空闲链表，其他线程放入所属内存池的跨线程空闲链表
+ * @param {void*} p: allocate 返回的内存，可以为 nullptr
+ */
+void TaskArena::deallocate(void* p) noexcept {
+	if (!p) {
+		return;
+	}
+
+	Header* header = static_cast<Header*>(p) - 1;
+	if (!header->m_arena) {
+		std::free(header);
+	}
+	else if (header->m_arena == t_arena) {
+		header->m_arena->freeLocal(header);
+	}
+	else {
+		header->m_arena->freeRemote(header);
+	}
+}
+
+
+/**
+ * @description: 从本级空闲链表分配；为空时先取回其他线程归还的块，仍为空再从当前大块切分
+ * @param {size_t} index: 分级下标
+ * @return {void*} 用户区
+ */
+void* TaskArena::allocateBlock(size_t index) {
+	if (!m_free[index]) {
+		collectRemote();
+	}
+
+	Header* header = nullptr;
+	if (m_free[index]) {
+		FreeBlock* block = m_free[index];
+		m_free[index] = block->m_next;
+		header = reinterpret_cast<Header*>(block) - 1;
+	}
+	else {
+		size_t size = blockSize(index);
+		if (m_cursor == nullptr || static_cast<size_t>(m_end - m_cursor) < size) {
+			// 当前大块剩余的部分不再使用
+			char* slab = static_cast<char*>(std::malloc(SLAB_SIZE));
+			if (!slab) {
+				throw std::bad_alloc();
+			}
+			m_cursor = slab;
+			m_end = slab + SLAB_SIZE;
+			m_reserved.store(m_reserved.load(std::memory_order_relaxed) + SLAB_SIZE, std::memory_order_relaxed);
+		}
+		header = reinterpret_cast<Header*>(m_cursor);
+		m_cursor += size;
+	}
+
+	header->m_arena = this;
+	header->m_class = index;
+
+	m_allocations.store(m_allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	m_bytes.store(m_bytes.load(std::memory_order_relaxed) + blockSize(index), std::memory_order_relaxed);
+
+	return header + 1;
+}
+
+
+/**
+ * @description: 一次取回跨线程空闲链表中的所有块，按分级放回各自的空闲链表
+ */
+void TaskArena::collectRemote() {
+	FreeBlock* block = m_remote.exchange(nullptr, std::memory_order_acquire);
+
+	while (block) {
+		FreeBlock* next = block->m_next;
+		size_t index = (reinterpret_cast<Header*>(block) - 1)->m_class;
+		block->m_next = m_free[index];
+		m_free[index] = block;
+		block = next;
+	}
+}
+
+
+/**
+ * @description: 所属线程释放，放回本级空闲链表
+ * @param {Header*} header: 块头
+ */
+void TaskArena::freeLocal(Header* header) {
+	FreeBlock* block = reinterpret_cast<FreeBlock*>(header + 1);
+	block->m_next = m_free[header->m_class];
+	m_free[header->m_class] = block;
+}
+
+
+/**
+ * @description: 其他线程释放，压入跨线程空闲链表；所属线程只会一次取走整个链表，不存在 ABA 问题
+ * @param {Header*} header: 块头
+ */
+void TaskArena::freeRemote(Header* header) {
+	FreeBlock* block = reinterpret_cast<FreeBlock*>(header + 1);
+	FreeBlock* head = m_remote.load(std::memory_order_relaxed);
+
+	do {
+		block->m_next = head;
+	} while (!m_remote.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+
+	m_remote_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/**
+ * @description: 所有线程的内存池统计，m_tasks 由线程池填写
+ * @return {ArenaStatistics} 统计
+ */
+ArenaStatistics TaskArena::statistics() {
+	ArenaStatistics statistics = ArenaStatistics();
+	ArenaRegistry &arenas = registry();
+	std::lock_guard<std::mutex> lock(arenas.m_mutex);
+
+	for (TaskArena* arena : arenas.m_arenas) {
+		statistics.m_allocations += arena->m_allocations.load(std::memory_order_relaxed);
+		statistics.m_bytes += arena->m_bytes.load(std::memory_order_relaxed);
+		statistics.m_remote_frees += arena->m_remote_frees.load(std::memory_order_relaxed);
+		statistics.m_reserved_bytes += arena->m_reserved.load(std::memory_order_relaxed);
+	}
+	statistics.m_arenas = arenas.m_arenas.size();
+	statistics.m_large_allocations = g_large_allocations.load(std::memory_order_relaxed);
+
+	return statistics;
+}
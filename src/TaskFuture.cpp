@@ -0,0 +1,214 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 12:06:52
+ * @last_edit_time: 2026-10-19 16:05:44
+ * @file_path: /Thread-Pool/src/TaskFuture.cpp
+ * @description: 线程池专用的 future / promise 源文件
+ */
+
+
+#include "ThreadPool.h"
+#include <cstdint>
+#include <new>
+
+
+static const size_t WAITER_SLOTS = 32;  // 等待者分组数量
+
+
+/**
+ * @description: 一组阻塞等待的线程，共享状态按地址映射到其中一组，代替每个状态各自的互斥锁与条件变量
+ */
+struct WaiterSlot {
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+};
+
+
+/**
+ * @description: 全部等待者分组
+ * @return {WaiterSlot*} WAITER_SLOTS 个分组
+ */
+static WaiterSlot* waiterSlots() {
+	static WaiterSlot slots[WAITER_SLOTS];
+	return slots;
+}
+
+
+/**
+ * @description: 共享状态对应的等待者分组
+ * @param {const void*} state: 共享状态地址
+ * @return {WaiterSlot&} 等待者分组
+ */
+static WaiterSlot &waiterSlot(const void* state) {
+	return waiterSlots()[(reinterpret_cast<uintptr_t>(state) >> 6) % WAITER_SLOTS];
+}
+
+
+/**
+ * @description: 构造函数，引用计数为 1，由 promise 持有
+ * @param {ThreadPool*} pool: 后续任务提交到的线程池
+ * @param {size_t} priority: 后续任务的优先级
+ */
+FutureCore::FutureCore(ThreadPool* pool, size_t priority)
+	: m_flags(0)
+	, m_references(1)
+	, m_pool(pool)
+	, m_priority(priority)
+	, m_policy(ContinuationPolicy::POOL)
+{ }
+
+
+/**
+ * @description: 减少引用，最后一个引用释放时析构并归还内存
+ */
+void FutureCore::release() noexcept {
+	if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		destroy();
+	}
+}
+
+
+/**
+ * @description: 写入方在结果 (或异常) 写入后调用：置 READY，唤醒阻塞的读取方；已设置后续任务时由这里执行
+ */
+void FutureCore::complete() noexcept {
+	unsigned previous = m_flags.fetch_or(READY, std::memory_order_acq_rel);
+
+	if (previous & WAITING) {
+		notifyWaiters();
+	}
+	if (previous & CONTINUATION) {
+		runContinuation();
+	}
+}
+
+
+/**
+ * @description: 保存异常并完成
+ * @param {std::exception_ptr} exception: 异常
+ */
+void FutureCore::fail(std::exception_ptr exception) noexcept {
+	m_exception = exception;
+	complete();
+}
+
+
+/**
+ * @description: 读取方设置后续任务后置 CONTINUATION；置位前结果已就绪时，由读取方立即执行
+ * @param {Task&} continuation: 后续任务，被移走
+ * @param {ContinuationPolicy} policy: 执行方式
+ */
+void FutureCore::setContinuation(Task &continuation, ContinuationPolicy policy) {
+	m_continuation = std::move(continuation);
+	m_policy = policy;
+
+	unsigned previous = m_flags.fetch_or(CONTINUATION, std::memory_order_acq_rel);
+	if (previous & READY) {
+		runContinuation();
+	}
+}
+
+
+/**
+ * @description: 执行或提交后续任务
+ * @description: 后续任务持有本状态的引用，执行完毕可能释放本状态，因此先把需要的成员取到局部变量，之后不再访问 this
+ */
+void FutureCore::runContinuation() {
+	Task continuation = std::move(m_continuation);
+	ThreadPool* pool = m_pool;
+	size_t priority = m_priority;
+
+	if (pool && m_policy == ContinuationPolicy::POOL && pool->m_start) {
+		try {
+			// 不等待，任务队列已满时直接执行，避免工作线程因提交后续任务而阻塞
+			if (pool->enqueueUntil(continuation, priority, std::chrono::steady_clock::time_point::min())) {
+				return;
+			}
+		}
+		catch (const std::runtime_error &) {
+			// 线程池恰好关闭，直接执行
+		}
+		catch (const std::bad_alloc &) {
+			// 入队时内存不足，直接执行；complete 不能抛出异常
+		}
+	}
+
+	try {
+		continuation();
+	}
+	catch (...) {
+		// then 的后续任务把异常写入自己的 future，只有 onComplete 的回调会走到这里
+		if (!pool) {
+			std::terminate();
+		}
+		pool->handleException(std::current_exception());
+	}
+}
+
+
+/**
+ * @description: 唤醒本状态所在分组中阻塞等待的线程；先获取分组锁，保证读取方已经进入等待
+ */
+void FutureCore::notifyWaiters() {
+	WaiterSlot &slot = waiterSlot(this);
+	{
+		std::unique_lock<std::mutex> lock(slot.m_mutex);
+	}
+	slot.m_cv.notify_all();
+}
+
+
+/**
+ * @description: 唤醒所有分组中阻塞等待的线程，线程池有新任务入队且有工作线程在等待结果时调用，让其醒来帮助执行
+ * @description: 先获取分组锁，保证登记后再次检查任务队列的工作线程已经进入等待
+ */
+void FutureCore::notifyHelpers() {
+	WaiterSlot* slots = waiterSlots();
+	for (size_t i = 0; i < WAITER_SLOTS; ++i) {
+		{
+			std::unique_lock<std::mutex> lock(slots[i].m_mutex);
+		}
+		slots[i].m_cv.notify_all();
+	}
+}
+
+
+/**
+ * @description: 等待结果就绪
+ * @description: 在所属线程池的工作线程中等待时，先帮助执行任务队列 (及双端队列) 中的任务，没有任务时才阻塞，避免所有工作线程都在等待时死锁
+ * @description: 阻塞的工作线程计入 m_blocked_helpers 后再次检查任务队列，与提交者的 wakeWorker 配对，有新任务入队时被唤醒，不轮询
+ * @description: 其他线程加分组锁后置 WAITING，结果未就绪则阻塞，与 complete 配对不会丢失唤醒
+ */
+void FutureCore::wait() {
+	if (ready()) {
+		return;
+	}
+
+	ThreadPool* pool = m_pool;
+	bool helping = pool != nullptr && ThreadPool::m_local_pool == pool;
+	WaiterSlot &slot = waiterSlot(this);
+
+	while (!ready()) {
+		if (helping && pool->runPendingTask()) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(slot.m_mutex);
+		if (m_flags.fetch_or(WAITING, std::memory_order_acq_rel) & READY) {
+			break;
+		}
+		if (helping) {
+			pool->m_blocked_helpers++;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!pool->hasPendingTask() || pool->m_stop_now) {
+				slot.m_cv.wait(lock);
+			}
+			pool->m_blocked_helpers--;
+		}
+		else {
+			slot.m_cv.wait(lock, [this]() { return ready(); });
+		}
+	}
+}
@@ -0,0 +1,331 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 13:02:17
+ * @last_edit_time: 2026-10-20 11:03:52
+ * @file_path: /Thread-Pool/src/TaskGraph.cpp
+ * @description: 任务依赖图 (DAG) 源文件
+ */
+
+
+#include "TaskGraph.h"
+#include <algorithm>
+#include <new>
+
+
+static const size_t NO_NODE = static_cast<size_t>(-1);  // 没有就绪的后继
+
+
+/**
+ * @description: 构造函数
+ */
+TaskGraph::TaskGraph()
+	: m_remaining(0)
+	, m_running(false)
+	, m_failed(false)
+{ }
+
+
+/**
+ * @description: 析构函数，正在执行时阻塞等待本次执行结束，节点任务不会访问已析构的图
+ */
+TaskGraph::~TaskGraph() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_finished.wait(lock, [this]() { return !m_running.load(std::memory_order_acquire); });
+}
+
+
+/**
+ * @description: 正在执行时不允许修改图
+ */
+void TaskGraph::checkIdle() const {
+	if (m_running.load(std::memory_order_acquire)) {
+		throw std::runtime_error("TaskGraph cannot be modified while running");
+	}
+}
+
+
+/**
+ * @description: 添加依赖，重复的依赖按多条计算，不影响结果
+ * @param {size_t} from: 前驱节点
+ * @param {size_t} to: 后继节点，在 from 完成后才执行
+ */
+void TaskGraph::addEdge(size_t from, size_t to) {
+	checkIdle();
+	if (from >= m_nodes.size() || to >= m_nodes.size()) {
+		throw std::out_of_range("TaskGraph node does not exist");
+	}
+	if (from == to) {
+		throw std::runtime_error("TaskGraph contains a cycle");
+	}
+
+	m_nodes[from].m_successors.push_back(to);
+	m_nodes[to].m_predecessors++;
+	m_prepared = false;
+}
+
+
+/**
+ * @description: 最长的关键路径长度
+ * @return {size_t} 关键路径上节点代价之和，空图为 0
+ */
+size_t TaskGraph::criticalPath() {
+	checkIdle();
+	prepare();
+	return m_max_rank;
+}
+
+
+/**
+ * @description: 按拓扑顺序 (Kahn 算法) 检查是否有环，再逆序计算每个节点到终点的关键路径长度
+ * @description: 图没有被修改时直接返回，多次执行只检查一次
+ */
+void TaskGraph::prepare() {
+	if (m_prepared) {
+		return;
+	}
+
+	size_t amount = m_nodes.size();
+	std::vector<size_t> order;
+	std::vector<size_t> in_degree(amount);
+	order.reserve(amount);
+	m_roots.clear();
+
+	for (size_t i = 0; i < amount; ++i) {
+		in_degree[i] = m_nodes[i].m_predecessors;
+		if (in_degree[i] == 0) {
+			order.push_back(i);
+			m_roots.push_back(i);
+		}
+	}
+	for (size_t i = 0; i < order.size(); ++i) {
+		for (size_t successor : m_nodes[order[i]].m_successors) {
+			if (--in_degree[successor] == 0) {
+				order.push_back(successor);
+			}
+		}
+	}
+	if (order.size() != amount) {
+		throw std::runtime_error("TaskGraph contains a cycle");
+	}
+
+	// 逆拓扑顺序，后继的关键路径都已算好
+	m_max_rank = 0;
+	for (size_t i = amount; i-- > 0; ) {
+		Node &node = m_nodes[order[i]];
+		size_t longest = 0;
+		for (size_t successor : node.m_successors) {
+			longest = std::max(longest, m_nodes[successor].m_rank);
+		}
+		node.m_rank = node.m_cost + longest;
+		m_max_rank = std::max(m_max_rank, node.m_rank);
+	}
+
+	m_pending.reset(new std::atomic<size_t>[amount]);
+	m_prepared = true;
+}
+
+
+/**
+ * @description: 节点提交时使用的优先级：关键路径最长的节点为 m_priority，越短的节点数值越大 (优先级越低)
+ * @description: 只映射到 m_priority 之后剩余的优先级上，不超过最后一级，避免被任务队列截断到同一级
+ * @param {size_t} node: 节点编号
+ * @return {size_t} 优先级
+ */
+size_t TaskGraph::priorityOf(size_t node) const {
+	size_t remaining = m_levels - 1 - std::min(m_priority, m_levels - 1);  // m_priority 之后还有的优先级数量
+	if (remaining == 0 || m_max_rank == 0) {
+		return m_priority;
+	}
+	double slack = static_cast<double>(m_max_rank - m_nodes[node].m_rank) / m_max_rank;
+	return m_priority + static_cast<size_t>(slack * remaining + 0.5);
+}
+
+
+/**
+ * @description: 以线程池默认优先级开始执行
+ * @param {ThreadPool&} pool: 执行节点的线程池
+ * @return {TaskFuture<void>} 所有节点完成时就绪，节点抛出异常时得到第一个异常
+ */
+TaskFuture<void> TaskGraph::runAsync(ThreadPool &pool) {
+	return runAsync(pool, pool.getTaskPriority());
+}
+
+
+/**
+ * @description: 开始执行：重置每个节点的剩余依赖数量，提交所有根节点
+ * @description: 使用的优先级数量与线程池的 priority_buckets 相同，关键路径最长的节点使用 priority
+ * @param {ThreadPool&} pool: 执行节点的线程池
+ * @param {size_t} priority: 最高的优先级
+ * @return {TaskFuture<void>} 所有节点完成时就绪，节点抛出异常时得到第一个异常
+ */
+TaskFuture<void> TaskGraph::runAsync(ThreadPool &pool, size_t priority) {
+	bool expected = false;
+	if (!m_running.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+		throw std::runtime_error("TaskGraph is already running");
+	}
+
+	TaskFuture<void> future;
+	try {
+		prepare();
+		m_promise = TaskPromise<void>(&pool, priority);
+		future = m_promise.getFuture();
+	}
+	catch (...) {
+		m_running.store(false, std::memory_order_release);
+		throw;
+	}
+
+	if (m_nodes.empty()) {
+		m_running.store(false, std::memory_order_release);
+		m_promise.setValue();
+		return future;
+	}
+
+	m_pool = &pool;
+	m_priority = priority;
+	m_levels = pool.m_config->m_priority_buckets;
+	m_failed.store(false, std::memory_order_relaxed);
+	m_exception = nullptr;
+	for (size_t i = 0; i < m_nodes.size(); ++i) {
+		m_pending[i].store(m_nodes[i].m_predecessors, std::memory_order_relaxed);
+	}
+	m_remaining.store(m_nodes.size(), std::memory_order_release);
+
+	// 最后一个根节点提交之后本次执行可能随时结束，之后不再访问图；未能提交的根节点尚未执行，本次执行不会提前结束
+	std::vector<size_t> inline_nodes;
+	size_t roots = m_roots.size();
+	for (size_t i = 0; i < roots; ++i) {
+		schedule(m_roots[i], inline_nodes);
+	}
+	for (size_t node : inline_nodes) {
+		execute(node);
+	}
+
+	return future;
+}
+
+
+/**
+ * @description: 以线程池默认优先级执行并等待完成
+ * @param {ThreadPool&} pool: 执行节点的线程池
+ */
+void TaskGraph::run(ThreadPool &pool) {
+	runAsync(pool).get();
+}
+
+
+/**
+ * @description: 执行并等待完成；在工作线程中调用时，等待期间帮助执行任务
+ * @param {ThreadPool&} pool: 执行节点的线程池
+ * @param {size_t} priority: 最高的优先级
+ */
+void TaskGraph::run(ThreadPool &pool, size_t priority) {
+	runAsync(pool, priority).get();
+}
+
+
+/**
+ * @description: 提交就绪节点；不等待任务队列空出位置，已满或线程池已关闭时放入待执行列表，由当前线程稍后执行，节点任务不会阻塞工作线程
+ * @description: 不在这里直接执行，避免图很大且任务队列一直满时沿着依赖链递归
+ * @param {size_t} node: 就绪节点
+ * @param {std::vector<size_t>&} inline_nodes: 当前线程的待执行列表
+ */
+void TaskGraph::schedule(size_t node, std::vector<size_t> &inline_nodes) {
+	Task task([this, node]() { execute(node); });
+
+	try {
+		if (m_pool->m_start && m_pool->enqueueUntil(task, priorityOf(node), std::chrono::steady_clock::time_point::min())) {
+			return;
+		}
+	}
+	catch (const std::runtime_error &) {
+		// 线程池恰好关闭，由当前线程执行
+	}
+	catch (const std::bad_alloc &) {
+		// 入队时内存不足，由当前线程执行；抛出会使本次执行无法结束
+	}
+
+	inline_nodes.push_back(node);
+}
+
+
+/**
+ * @description: 执行节点，然后将后继的剩余依赖数量减一
+ * @description: 就绪的后继中关键路径最长的一个由当前线程接着执行，其余提交到线程池 (工作窃取模式下由工作线程提交时进入其双端队列，否则进入共享任务队列)
+ * @description: 未能提交的节点放入局部的待执行列表，没有可以接着执行的后继时依次取出执行，调用栈深度不随图的大小增长
+ * @description: 最后一个节点完成时结束本次执行，之后不再访问 this；此时所有节点都已执行，待执行列表为空
+ * @param {size_t} node: 就绪节点
+ */
+void TaskGraph::execute(size_t node) {
+	std::vector<size_t> inline_nodes;  // 未能提交、由当前线程执行的就绪节点
+
+	while (node != NO_NODE) {
+		Node &current = m_nodes[node];
+
+		if (!m_failed.load(std::memory_order_relaxed)) {
+			try {
+				current.m_func();
+			}
+			catch (...) {
+				// 只保存第一个异常，其余节点照常推进计数但不再调用节点函数
+				if (!m_failed.exchange(true, std::memory_order_relaxed)) {
+					m_exception = std::current_exception();
+				}
+			}
+		}
+
+		size_t next = NO_NODE;
+		for (size_t successor : current.m_successors) {
+			if (m_pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+				continue;
+			}
+			if (next == NO_NODE) {
+				next = successor;
+			}
+			else if (m_nodes[successor].m_rank > m_nodes[next].m_rank) {
+				schedule(next, inline_nodes);
+				next = successor;
+			}
+			else {
+				schedule(successor, inline_nodes);
+			}
+		}
+
+		// 还有就绪的后继或待执行的节点时本次执行不会结束
+		if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			finish();
+			return;
+		}
+
+		if (next == NO_NODE && !inline_nodes.empty()) {
+			next = inline_nodes.back();
+			inline_nodes.pop_back();
+		}
+		node = next;
+	}
+}
+
+
+/**
+ * @description: 结束本次执行：先取出结果，再在锁内清除执行标志并通知析构函数，最后写入结果，清除标志之后不再访问 this
+ */
+void TaskGraph::finish() {
+	TaskPromise<void> promise = std::move(m_promise);
+	std::exception_ptr exception = m_exception;
+	m_exception = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_running.store(false, std::memory_order_release);
+		m_finished.notify_all();
+	}
+
+	if (exception) {
+		promise.setException(exception);
+	}
+	else {
+		promise.setValue();
+	}
+}
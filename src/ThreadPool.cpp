@@ -3,7 +3,7 @@
  * @github: https://github.com/yuyuyuj1e
  * @csdn: https://blog.csdn.net/yuyuyuj1e
  * @date: 2023-03-13 09:58:13
- * @last_edit_time: 2023-03-31 20:55:31
+ * @last_edit_time: 2026-10-20 11:40:18
  * @file_path: /Thread-Pool/src/ThreadPool.cpp
  * @description: 线程池模块源文件
  */
@@ -11,8 +11,74 @@
 
 #include "ThreadPool.h"
 #include <fstream>
+#include <algorithm>
+#include <cstdlib>
 #include "json/json.h"
 
+
+thread_local ThreadPool* ThreadPool::m_local_pool = nullptr;
+thread_local int ThreadPool::m_local_slot = -1;
+thread_local ThreadPool::Worker* ThreadPool::m_local_worker = nullptr;
+
+
+/**
+ * @description: 提交期间计入 m_submitting，在关闭检查之前计数、入队完成 (或放弃) 之后减少
+ * @description: 与关闭线程池时 m_start 置为 false 之后读取 m_submitting 配对，二者都是顺序一致的原子操作：提交者要么看到线程池已关闭，要么关闭的线程等到其任务入队
+ */
+class ThreadPool::SubmitScope {
+private:
+	ThreadPool* m_pool;
+
+public:
+	explicit SubmitScope(ThreadPool* pool) : m_pool(pool) {
+		m_pool->m_submitting++;
+	}
+
+	~SubmitScope() {
+		if (m_pool->m_submitting.fetch_sub(1) == 1 && !m_pool->m_start) {
+			{
+				std::unique_lock<std::mutex> lock(m_pool->m_mutex);
+			}
+			m_pool->m_tasks_done.notify_all();
+		}
+	}
+};
+
+
+/**
+ * @description: 拒绝策略的名称，用于输出日志
+ * @param {RejectPolicy} policy: 拒绝策略
+ * @return {const char*} 名称
+ */
+static const char* rejectPolicyName(RejectPolicy policy) {
+	switch (policy) {
+	case RejectPolicy::BLOCK: return "BLOCK";
+	case RejectPolicy::THROW: return "THROW";
+	case RejectPolicy::DISCARD_NEWEST: return "DISCARD_NEWEST";
+	case RejectPolicy::DISCARD_OLDEST: return "DISCARD_OLDEST";
+	case RejectPolicy::DISCARD_LOWEST: return "DISCARD_LOWEST";
+	case RejectPolicy::CALLER_RUNS: return "CALLER_RUNS";
+	}
+	return "UNKNOWN";
+}
+
+
+/**
+ * @description: 绑定方式的名称，用于输出日志
+ * @param {AffinityPolicy} policy: 绑定方式
+ * @return {const char*} 名称
+ */
+static const char* affinityPolicyName(AffinityPolicy policy) {
+	switch (policy) {
+	case AffinityPolicy::NONE: return "NONE";
+	case AffinityPolicy::COMPACT: return "COMPACT";
+	case AffinityPolicy::SCATTER: return "SCATTER";
+	case AffinityPolicy::LIST: return "LIST";
+	}
+	return "UNKNOWN";
+}
+
+
 /**
  * @description: 默认构造函数，使用通过委托构造函数
  */
@@ -26,7 +92,21 @@ ThreadPool::ThreadPool() : ThreadPool("../conf/threadpool.json") {
  * @param {size_t} n_threads: 最低线程数量
  * @param {ThreadPoolWorkMode} work_mode: 线程池工作模式
  */
-ThreadPool::ThreadPool(const std::string config_path): m_thread_amount(0) {
+ThreadPool::ThreadPool(const std::string config_path)
+	: m_start(false)
+	, m_idle_threads(0)
+	, m_blocked_submitters(0)
+	, m_blocked_helpers(0)
+	, m_submitting(0)
+	, m_unfinished(0)
+	, m_idle_waiters(0)
+	, m_stop_now(false)
+	, m_spin_hits(0)
+	, m_yield_hits(0)
+	, m_parks(0)
+	, m_submitted(0)
+	, m_thread_amount(0)
+{
 	m_log->run();
 	parseConfig(config_path);
 
@@ -36,12 +116,26 @@ ThreadPool::ThreadPool(const std::string config_path): m_thread_amount(0) {
 		std::cout << "线程池工作模式: FIXED_THREAD" << std::endl;
 	else
 		std::cout << "线程池工作模式: MUTABLE_THREAD" << std::endl;
+	if (m_config->m_work_stealing)
+		std::cout << "任务调度方式: WORK_STEALING" << std::endl;
+	if (m_config->m_idle_strategy == IdleStrategy::SPIN)
+		std::cout << "空闲策略: SPIN, 自旋上限: " << m_config->m_spin_count << ", 让出次数: " << m_config->m_yield_count << std::endl;
+	if (m_config->m_queue_mode == TaskQueueMode::FIFO)
+		std::cout << "任务队列: FIFO" << std::endl;
+	else if (m_config->m_queue_mode == TaskQueueMode::BUCKET)
+		std::cout << "任务队列: BUCKET, 优先级数量: " << m_config->m_priority_buckets << std::endl;
+	else if (m_config->m_queue_mode == TaskQueueMode::DARY_HEAP)
+		std::cout << "任务队列: DARY_HEAP" << std::endl;
+	else
+		std::cout << "任务队列: HEAP" << std::endl;
 	std::cout << "线程数量: " << m_config->m_min_threshold << '\n'
 		<< "线程上限: " << m_config->m_max_threshold << '\n'
 		<< "线程下限: " << m_config->m_min_threshold << '\n'
 		<< "任务队列长度: " << m_config->m_max_task << '\n'
 		<< "任务优先级: " << m_config->m_priority_level << '\n'
-		<< "任务提交时限: 3 秒\n"
+		<< "任务提交时限: " << m_config->m_timeout.count() << " 毫秒\n"
+		<< "拒绝策略: " << rejectPolicyName(m_config->m_reject_policy) << '\n'
+		<< "CPU 绑定: " << affinityPolicyName(m_config->m_affinity) << ", NUMA 节点: " << CpuTopology::system().nodes() << '\n'
 		<< std::endl;
 #else
 	std::string task = "线程池初始配置如下 ---------> ";
@@ -50,6 +144,22 @@ ThreadPool::ThreadPool(const std::string config_path): m_thread_amount(0) {
 		task += "线程池工作模式: FIXED_THREAD";
 	else
 		task += "线程池工作模式: MUTABLE_THREAD";
+	if (m_config->m_work_stealing)
+		task += "，任务调度方式: WORK_STEALING";
+	if (m_config->m_idle_strategy == IdleStrategy::SPIN)
+		task += "，空闲策略: SPIN";
+	if (m_config->m_queue_mode == TaskQueueMode::FIFO)
+		task += "，任务队列: FIFO";
+	else if (m_config->m_queue_mode == TaskQueueMode::BUCKET)
+		task += "，任务队列: BUCKET";
+	else if (m_config->m_queue_mode == TaskQueueMode::DARY_HEAP)
+		task += "，任务队列: DARY_HEAP";
+
+	task += "，拒绝策略: ";
+	task += rejectPolicyName(m_config->m_reject_policy);
+	task += "，CPU 绑定: ";
+	task += affinityPolicyName(m_config->m_affinity);
+	task += "，NUMA 节点: " + std::to_string(CpuTopology::system().nodes());
 
 	m_log->addTask(task);
 #endif
@@ -75,6 +185,9 @@ void ThreadPool::close() {
 		return ;
 	}
 
+	// 停止定时入队线程，并将所有提交缓冲区中的任务入队
+	flushAllSubmitBuffers(true);
+
 	{
         std::unique_lock<std::mutex> lock(m_mutex);
         m_start = false;
@@ -86,14 +199,11 @@ void ThreadPool::close() {
 	m_log->addTask("线程池已准备关闭，请勿继续提交任务");
 #endif
 
+	// 正在提交的任务入队后工作线程才能退出，否则任务不会被执行
+	waitSubmitters();
 
-	// 唤醒所有被当前条件变量阻塞的线程
-	m_queue_not_empty.notify_all();
-
-	// 等待所有线程结束工作
-	for(std::unordered_map<int, std::thread>::iterator it = m_threads.begin(); it != m_threads.end(); ++it) {
-		it->second.join();
-	}
+	// 工作线程执行完所有任务后退出
+	stopThreads();
 
 #ifdef DEBUG
 	std::cout << "线程池已关闭" << std::endl;
@@ -101,22 +211,869 @@ void ThreadPool::close() {
 	m_log->addTask("线程池已关闭");
 #endif
 
+	// 日志模块是单例，只释放本线程池的引用，其他线程池仍可继续使用
 	m_log->close();
 }
 
 
+/**
+ * @description: 立即关闭线程池：工作线程执行完当前任务后退出，不再执行任务队列中剩余的任务
+ * @description: 提交缓冲区中的任务先入队，再与任务队列、工作线程双端队列中的任务一起返回
+ * @description: 返回的任务可以由调用者执行或提交给其他线程池；直接析构时，submitTask 提交的任务其 future 得到 broken_promise 异常
+ * @return {std::vector<Task>} 尚未执行的任务，按出队顺序排列；线程池已关闭时为空
+ */
+std::vector<Task> ThreadPool::shutdownNow() {
+	std::vector<Task> tasks;
+	if (!m_start) {
+		return tasks;
+	}
+
+	flushAllSubmitBuffers(true);
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_stop_now = true;
+		m_start = false;
+	}
+
+#ifdef DEBUG
+	std::cout << "线程池立即关闭，剩余任务将被返回" << std::endl;
+#else
+	m_log->addTask("线程池立即关闭，剩余任务将被返回");
+#endif
+
+	// 正在提交的任务入队后再取出剩余任务，否则任务既不会被执行也不会被返回
+	waitSubmitters();
+	stopThreads();
+
+	// 工作线程已全部退出，不会再有并发访问
+	Task task;
+	while (m_queue->taskDequeue(task)) {
+		tasks.push_back(std::move(task));
+	}
+	for (size_t i = 0; i < m_deques.size(); ++i) {
+		Task* local_task = nullptr;
+		while (m_deques[i]->steal(local_task)) {
+			tasks.push_back(std::move(*local_task));
+			deleteLocalTask(local_task);
+		}
+	}
+
+	// 返回的任务不再由线程池执行，唤醒 waitIdle 中等待的线程
+	if (!tasks.empty()) {
+		finishTasks(tasks.size());
+	}
+
+	TP_TRACE_INFO("线程池立即关闭，返回剩余任务", 0, tasks.size());
+#ifdef DEBUG
+	std::cout << "线程池已关闭，返回剩余任务数量: " << tasks.size() << std::endl;
+#else
+	m_log->addTask("线程池已关闭，返回剩余任务数量: " + std::to_string(tasks.size()));
+#endif
+
+	m_log->close();
+	return tasks;
+}
+
+
+/**
+ * @description: 关闭线程池时等待正在提交的任务入队或放弃，调用前 m_start 已置为 false，之后不会再有任务入队
+ * @description: 因任务队列已满而等待的提交者被唤醒后看到线程池已关闭，放弃入队并抛出异常
+ */
+void ThreadPool::waitSubmitters() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_queue_not_full.notify_all();
+	m_tasks_done.wait(lock, [this]() { return m_submitting.load() == 0; });
+}
+
+
+/**
+ * @description: 停止扩缩容线程，唤醒所有休眠与停放的工作线程，并等待其退出，调用前 m_start 已置为 false
+ */
+void ThreadPool::stopThreads() {
+	// 停止扩缩容线程，之后线程数量不再变化
+	m_scale_cv.notify_all();
+	if (m_scaler.joinable()) {
+		m_scaler.join();
+	}
+
+	// 唤醒所有被当前条件变量阻塞的线程，以及后备池中停放的线程
+	m_queue_not_empty.notify_all();
+	for (size_t i = 0; i < m_slots.size(); ++i) {
+		m_slots[i]->m_revive.notify_one();
+	}
+
+	// 等待所有线程结束工作
+	for (size_t i = 0; i < m_slots.size(); ++i) {
+		if (m_slots[i]->m_thread.joinable()) {
+			m_slots[i]->m_thread.join();
+		}
+	}
+}
+
+
+/**
+ * @description: 等待已提交的任务全部执行完毕，线程池保持运行，可以继续提交任务，用于分阶段处理之间的屏障
+ * @description: 基于未完成任务计数，最后一个任务完成时唤醒，不轮询任务队列；提交缓冲区中的任务先入队
+ * @description: 工作线程中调用会等待自己正在执行的任务，因此直接抛出异常
+ */
+void ThreadPool::waitIdle() {
+	if (m_local_pool == this) {
+		throw std::runtime_error("waitIdle cannot be called from a worker thread");
+	}
+
+	flushAllSubmitBuffers(false);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle_waiters++;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// 与 finishTasks 配对，二者之间都有顺序一致的内存屏障，不会丢失唤醒
+	m_tasks_done.wait(lock, [this]() { return m_unfinished.load() == 0; });
+	m_idle_waiters--;
+}
+
+
+/**
+ * @description: 任务执行完毕或被丢弃，未完成任务计数归零且有线程在 waitIdle 中等待时唤醒
+ * @param {size_t} count: 完成的任务数量
+ */
+void ThreadPool::finishTasks(size_t count) {
+	if (m_unfinished.fetch_sub(count) != count) {
+		return;
+	}
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_idle_waiters.load(std::memory_order_relaxed) > 0) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+		}
+		m_tasks_done.notify_all();
+	}
+}
+
+
+
+/**
+ * @description: 当前工作线程帮助执行一个任务，用于工作线程中等待 TaskFuture
+ * @description: 只有本线程池的工作线程可以帮助；shutdownNow 之后不再执行任务，剩余任务留给 shutdownNow 返回
+ * @return {bool} 执行了一个任务返回 true
+ */
+bool ThreadPool::runPendingTask() {
+	if (m_local_pool != this || m_local_worker == nullptr || m_stop_now) {
+		return false;
+	}
+	return m_local_worker->helpOnce();
+}
+
+
+/**
+ * @description: 并行循环的参与者数量：工作线程数量，调用线程不是本线程池的工作线程时再加上调用线程；线程池已关闭时只有调用线程
+ * @description: grain 为 0 时让每个参与者大约领取 LOOP_CHUNKS_PER_PARTICIPANT 块，块数不足时减少参与者
+ * @param {size_t} size: 迭代数量
+ * @param {size_t&} grain: 块大小，为 0 时写入自动选择的结果
+ * @return {size_t} 参与者数量，至少为 1
+ */
+size_t ThreadPool::loopParticipants(size_t size, size_t &grain) {
+	static const size_t LOOP_CHUNKS_PER_PARTICIPANT = 8;
+
+	size_t participants = 1;
+	if (m_start) {
+		size_t threads = static_cast<size_t>(std::max(m_thread_amount.load(), 1));
+		participants = m_local_pool == this ? threads : threads + 1;
+	}
+
+	if (grain == 0) {
+		grain = std::max<size_t>(size / (participants * LOOP_CHUNKS_PER_PARTICIPANT), 1);
+	}
+	return std::max<size_t>(std::min(participants, (size + grain - 1) / grain), 1);
+}
+
+
+/**
+ * @description: 读取第一个 CPU 的二级数据缓存大小，读取失败时返回 DEFAULT_L2_CACHE
+ * @return {size_t} 字节数
+ */
+static size_t levelTwoCacheSize() {
+	static const size_t DEFAULT_L2_CACHE = 256 * 1024;
+
+#ifdef __linux__
+	for (int index = 0; index < 8; ++index) {
+		std::string directory = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+		std::ifstream level_file(directory + "level");
+		std::ifstream type_file(directory + "type");
+		std::ifstream size_file(directory + "size");
+		int level = 0;
+		std::string type;
+		std::string size;
+		if (!(level_file >> level)) {
+			break;
+		}
+		if (level != 2 || !(type_file >> type) || type == "Instruction" || !(size_file >> size)) {
+			continue;
+		}
+
+		// 格式如 2048K
+		char* unit = nullptr;
+		size_t bytes = std::strtoul(size.c_str(), &unit, 10);
+		if (*unit == 'K') {
+			bytes *= 1024;
+		}
+		else if (*unit == 'M') {
+			bytes *= 1024 * 1024;
+		}
+		if (bytes != 0) {
+			return bytes;
+		}
+	}
+#endif
+	return DEFAULT_L2_CACHE;
+}
+
+
+/**
+ * @description: 前缀和每块的元素数量：块的输入与输出合计约占二级缓存的一半，第二遍扫描时块仍在缓存中
+ * @param {size_t} element_size: 元素大小
+ * @return {size_t} 块大小，至少 SCAN_MIN_CHUNK 个元素
+ */
+size_t ThreadPool::scanChunk(size_t element_size) {
+	static const size_t SCAN_MIN_CHUNK = 1024;
+	static const size_t l2_cache = levelTwoCacheSize();
+
+	return std::max<size_t>(l2_cache / (4 * std::max<size_t>(element_size, 1)), SCAN_MIN_CHUNK);
+}
+
 
 /**
  * @description: 初始化线程池
  */
 void ThreadPool::initThreadPool() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const CpuTopology &topology = CpuTopology::system();
+
+	// 创建任务队列；多个 NUMA 节点时每个节点一个子队列，由绑定到该节点的临时线程创建，利用首次访问策略将内存分配在本节点
+	if (m_config->m_numa_queues && topology.nodes() > 1) {
+		std::vector<std::unique_ptr<TaskQueue>> queues(topology.nodes());
+		for (size_t node = 0; node < topology.nodes(); ++node) {
+			std::thread([this, &topology, &queues, node]() {
+				CpuTopology::bindCurrentThread(topology.cpus(node));
+				queues[node].reset(createTaskQueue());
+			}).join();
+		}
+		m_queue.reset(new NumaSafeQueue(std::move(queues)));
+	}
+	else {
+		m_queue.reset(createTaskQueue());
+	}
+
+	// 计算每个槽位绑定的 CPU，工作线程启动时自行绑定；只有一个节点时不区分节点
+	m_slot_cpus = topology.placement(m_config->m_affinity, m_config->m_max_threshold, m_config->m_cpu_list);
+	for (size_t i = 0; i < m_slot_cpus.size(); ++i) {
+		m_slot_nodes.push_back(topology.nodes() > 1 ? topology.nodeOf(m_slot_cpus[i]) : -1);
+	}
+
+	// 每个工作线程占用一个槽位，槽位数量即线程上限
+	for (size_t i = 0; i < m_config->m_max_threshold; ++i) {
+		m_slots.emplace_back(new WorkerSlot());
+	}
+	for (int i = m_config->m_max_threshold - 1; i >= 0; --i) {
+		m_free_slots.push_back(i);
+	}
+
+	// 工作窃取模式下，每个槽位持有一个双端队列，必须在工作线程启动前创建完毕
+	if (m_config->m_work_stealing) {
+		for (size_t i = 0; i < m_config->m_max_threshold; ++i) {
+			m_deques.emplace_back(new LocalDeque());
+		}
+	}
+
 	m_start = true;
 	for (int i = 0; i < m_config->m_min_threshold; ++i) {
-		// std::thread 调用类的成员函数需要传递类的一个对象作为参数， 由于是 operator() 下面两种写法都可以，如果是类内部，传入 this 指针即可
-		// m_threads[i] = std::thread(Worker(this, i));  // 分配工作线程
-		m_threads[m_thread_id] = std::thread(&Worker::operator(), Worker(this, m_thread_id));  // 指定线程所执行的函数
-		m_thread_id++;
+		addWorker();
+	}
+
+	// 线程数量可变时，由扩缩容线程负责增删线程，提交任务的线程不会创建线程
+	if (m_config->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD && m_config->m_max_threshold > m_config->m_min_threshold) {
+		m_scaler = std::thread(&ThreadPool::scaling, this);
+	}
+}
+
+
+/**
+ * @description: 按 task_queue 创建任务队列，FIFO 模式下环形队列的容量由最大任务量决定
+ * @return {TaskQueue*} 新建的任务队列
+ */
+TaskQueue* ThreadPool::createTaskQueue() {
+	if (m_config->m_queue_mode == TaskQueueMode::FIFO) {
+		return new RingSafeQueue(m_config->m_max_task);
+	}
+	else if (m_config->m_queue_mode == TaskQueueMode::BUCKET) {
+		return new BucketSafeQueue(m_config->m_priority_buckets);
+	}
+	else if (m_config->m_queue_mode == TaskQueueMode::DARY_HEAP) {
+		return new DaryHeapSafeQueue(m_config->m_max_task);
+	}
+	return new HeapSafeQueue();
+}
+
+
+/**
+ * @description: 将当前工作线程绑定到槽位对应的 CPU，并记录所在节点，之后优先从本节点的任务队列取任务
+ * @description: 绑定失败 (例如 CPU 不在进程允许的范围内) 时不绑定，由操作系统调度
+ * @param {int} slot: 工作线程槽位
+ */
+void ThreadPool::bindWorker(int slot) {
+	int cpu = m_slot_cpus[slot];
+	if (cpu < 0) {
+		return;
+	}
+
+	if (!CpuTopology::bindCurrentThread(std::vector<int>(1, cpu))) {
+		TP_TRACE_ERROR("工作线程绑定 CPU 失败", slot, cpu);
+		return;
+	}
+
+	if (m_slot_nodes[slot] >= 0) {
+		CpuTopology::setCurrentNode(m_slot_nodes[slot]);
+	}
+	TP_TRACE_INFO("工作线程已绑定 CPU", slot, cpu);
+}
+
+
+/**
+ * @description: 添加一个工作线程，调用前需持有 m_mutex
+ * @description: 后备池中有停放的线程时直接唤醒最近停放的线程，不需要创建线程
+ * @return {bool} 成功返回 true，没有空闲槽位返回 false
+ */
+bool ThreadPool::addWorker() {
+	if (!m_reserve.empty()) {
+		int slot = m_reserve.back();
+		m_reserve.pop_back();
+
+		m_slots[slot]->m_parked = false;
+		m_slots[slot]->m_revive.notify_one();
 		m_thread_amount++;
+		m_revived++;
+
+		return true;
+	}
+
+	if (m_free_slots.empty()) {
+		return false;
+	}
+
+	int slot = m_free_slots.back();
+	m_free_slots.pop_back();
+
+	// std::thread 调用类的成员函数需要传递类的一个对象作为参数， 由于是 operator() 下面两种写法都可以，如果是类内部，传入 this 指针即可
+	// m_slots[slot]->m_thread = std::thread(Worker(this, m_thread_id, slot));  // 分配工作线程
+	m_slots[slot]->m_thread = std::thread(&Worker::operator(), Worker(this, m_thread_id, slot));  // 指定线程所执行的函数
+	m_thread_id++;
+	m_thread_amount++;
+	m_spawned++;
+
+	return true;
+}
+
+
+/**
+ * @description: 回收后备池中停放超过 reserve_timeout 的线程，调用前需持有 m_mutex
+ * @description: join 时释放 m_mutex，回收期间槽位既不在后备池也不在空闲槽位中，不会被重复使用
+ * @param {std::unique_lock<std::mutex>&} lock: m_mutex 的锁
+ */
+void ThreadPool::reapReserve(std::unique_lock<std::mutex> &lock) {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	while (!m_reserve.empty() && m_start) {
+		int slot = m_reserve.front();
+		WorkerSlot &worker_slot = *m_slots[slot];
+		if (now - worker_slot.m_parked_since < m_config->m_reserve_timeout) {
+			break;
+		}
+		m_reserve.erase(m_reserve.begin());
+
+		worker_slot.m_stop = true;
+		worker_slot.m_revive.notify_one();
+		std::thread thread = std::move(worker_slot.m_thread);
+
+		lock.unlock();
+		thread.join();
+		lock.lock();
+
+		worker_slot.m_parked = false;
+		worker_slot.m_stop = false;
+		m_free_slots.push_back(slot);
+		m_reaped++;
+		TP_TRACE_INFO("回收后备池线程，剩余后备线程", slot, m_reserve.size());
+	}
+}
+
+
+/**
+ * @description: 是否还有未执行的任务
+ * @return {bool} true/false
+ */
+bool ThreadPool::hasPendingTask() {
+	if (!m_queue->empty()) {
+		return true;
+	}
+
+	for (size_t i = 0; i < m_deques.size(); ++i) {
+		if (!m_deques[i]->empty()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @description: 线程池已经关闭时拒绝提交任务
+ */
+void ThreadPool::throwIfClosed() {
+	// 如果线程池已经决定关闭，则不可再提交任务
+	if (!m_start) {
+
+#ifdef DEBUG
+		std::cout << "线程池已被关闭，无法提交新任务";
+#else
+		m_log->addTask("线程池已被关闭，无法提交新任务");
+#endif
+
+		throw std::runtime_error("ThreadPool is already colsed");
+	}
+}
+
+
+/**
+ * @description: 不等待地入队，成功时计入已入队的任务数量并唤醒工作线程
+ * @description: 工作窃取模式下，工作线程提交的任务直接放入自己的双端队列，不受任务上限约束，避免任务嵌套提交时死锁
+ * @description: 内存不足时抛出 std::bad_alloc，任务保持不变
+ * @param {Task&} task: 任务函数，入队后被移走；未能入队时保持不变
+ * @param {size_t} priority: 任务优先级
+ * @return {bool} 成功入队返回 true，任务队列已满返回 false
+ */
+bool ThreadPool::tryEnqueue(Task &task, size_t priority) {
+	if (m_config->m_work_stealing && m_local_pool == this) {
+		Task* local_task = newLocalTask(task);
+		try {
+			m_deques[m_local_slot]->push(local_task);
+		}
+		catch (...) {
+			// 双端队列扩容时内存不足，任务放回原处
+			task = std::move(*local_task);
+			deleteLocalTask(local_task);
+			throw;
+		}
+	}
+	else if (!m_queue->taskEnqueue(task, priority, m_config->m_max_task)) {
+		return false;
+	}
+
+	m_submitted.fetch_add(1, std::memory_order_relaxed);
+	wakeWorker();
+	return true;
+}
+
+
+/**
+ * @description: 任务入队，并唤醒工作线程
+ * @description: 任务队列未满时不需要获取线程池锁；已满时才加锁，尝试添加线程并等待任务队列空出位置
+ * @param {Task&} task: 任务函数，入队后被移走
+ * @param {size_t} priority: 任务优先级
+ */
+void ThreadPool::enqueueTask(Task &task, size_t priority) {
+	SubmitScope scope(this);
+	throwIfClosed();
+	m_unfinished++;  // 入队前计数，避免任务执行完毕时计数先减为负
+
+	try {
+		if (tryEnqueue(task, priority)) {
+			return;
+		}
+	}
+	catch (...) {
+		// 入队时内存不足，任务未入队
+		finishTasks();
+		throw;
+	}
+
+	enqueueBlocking(&task, 1, priority);
+}
+
+
+/**
+ * @description: 批量任务入队，任务队列只加锁一次，并按入队数量唤醒工作线程
+ * @param {Task*} tasks: 任务函数，入队后被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ */
+void ThreadPool::enqueueBatch(Task *tasks, size_t count, size_t priority) {
+	SubmitScope scope(this);
+	throwIfClosed();
+
+	if (count == 0) {
+		return;
+	}
+	m_unfinished += count;
+
+	if (m_config->m_work_stealing && m_local_pool == this) {
+		for (size_t i = 0; i < count; ++i) {
+			m_deques[m_local_slot]->push(newLocalTask(tasks[i]));
+		}
+		m_submitted.fetch_add(count, std::memory_order_relaxed);
+		wakeWorker(count);
+		return;
+	}
+
+	size_t enqueued = m_queue->taskEnqueueBatch(tasks, count, priority, m_config->m_max_task);
+	if (enqueued) {
+		m_submitted.fetch_add(enqueued, std::memory_order_relaxed);
+		wakeWorker(enqueued);
+	}
+
+	if (enqueued < count) {
+		enqueueBlocking(tasks + enqueued, count - enqueued, priority);
+	}
+}
+
+
+/**
+ * @description: 任务队列已满时的慢速路径：加锁，通知扩缩容线程，并等待任务队列空出位置
+ * @description: BLOCK 策略下一直等待；其他策略下等待超过 timeout 后，对未入队的任务执行拒绝策略
+ * @param {Task*} tasks: 待入队的任务，入队后被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @return {size_t} 等待期间成功入队的任务数量
+ */
+size_t ThreadPool::enqueueBlocking(Task *tasks, size_t count, size_t priority) {
+	// 如果任务数已满，等待线程执行
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+#ifdef DEBUG
+	std::cout << "任务队列已满, 请等待任务完成";
+#else
+	m_log->addTask("任务队列已满, 请等待任务完成");
+#endif
+
+	// BLOCK 策略下一直等待，不会超时
+	RejectPolicy policy = m_config->m_reject_policy;
+	std::chrono::steady_clock::time_point deadline = policy == RejectPolicy::BLOCK
+		? std::chrono::steady_clock::time_point::max()
+		: std::chrono::steady_clock::now() + m_config->m_timeout;
+
+	size_t enqueued = waitEnqueue(lock, tasks, count, priority, deadline);
+
+	if (enqueued < count) {
+		if (!m_start) {
+			lock.unlock();
+			finishTasks(count - enqueued);
+			throw std::runtime_error("ThreadPool is already colsed");
+		}
+
+		// 用户提交任务，超过时长，执行拒绝策略；拒绝策略可能执行任务，不能持有线程池锁
+		TP_TRACE_ERROR("任务提交超时，执行拒绝策略", count - enqueued, static_cast<int>(policy));
+#ifdef DEBUG
+		std::cout << "任务提交超时，执行拒绝策略: " << rejectPolicyName(policy) << std::endl;
+#else
+		m_log->addTask(std::string("任务提交超时，执行拒绝策略: ") + rejectPolicyName(policy));
+#endif
+		lock.unlock();
+		rejectTasks(tasks + enqueued, count - enqueued, priority, policy);
+	}
+
+	return enqueued;
+}
+
+
+/**
+ * @description: 持有线程池锁，等待任务队列空出位置并入队，直到全部入队、超过截止时间或线程池关闭
+ * @param {std::unique_lock<std::mutex>&} lock: m_mutex 的锁
+ * @param {Task*} tasks: 待入队的任务，入队后被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @param {std::chrono::steady_clock::time_point} deadline: 截止时间，为 time_point::max() 时一直等待
+ * @return {size_t} 成功入队的任务数量
+ */
+size_t ThreadPool::waitEnqueue(std::unique_lock<std::mutex> &lock, Task *tasks, size_t count, size_t priority, std::chrono::steady_clock::time_point deadline) {
+	// 登记为等待中的提交者，工作线程取出任务后据此决定是否通知
+	m_blocked_submitters++;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// 提交者被阻塞说明线程池已过载，让扩缩容线程立即采样，线程由扩缩容线程创建
+	m_scale_cv.notify_one();
+
+	size_t enqueued = 0;
+	auto try_enqueue = [&]() {
+		if (m_start) {
+			size_t amount = m_queue->taskEnqueueBatch(tasks + enqueued, count - enqueued, priority, m_config->m_max_task);
+			if (amount) {
+				// 持有线程池锁，休眠中的线程都在等待，可以直接唤醒
+				m_submitted.fetch_add(amount, std::memory_order_relaxed);
+				m_queue_not_empty.notify_all();
+				if (m_blocked_helpers.load() > 0) {
+					FutureCore::notifyHelpers();
+				}
+			}
+			enqueued += amount;
+		}
+		return enqueued == count || !m_start;
+	};
+
+	if (deadline == std::chrono::steady_clock::time_point::max()) {
+		m_queue_not_full.wait(lock, try_enqueue);
+	}
+	else {
+		m_queue_not_full.wait_until(lock, deadline, try_enqueue);
+	}
+
+	m_blocked_submitters--;
+	return enqueued;
+}
+
+
+/**
+ * @description: 任务入队，任务队列已满时最多等待到截止时间，超时不执行拒绝策略
+ * @param {Task&} task: 任务函数，入队后被移走；未能入队时保持不变
+ * @param {size_t} priority: 任务优先级
+ * @param {std::chrono::steady_clock::time_point} deadline: 截止时间，早于当前时间时不等待
+ * @return {bool} 成功入队返回 true
+ */
+bool ThreadPool::enqueueUntil(Task &task, size_t priority, std::chrono::steady_clock::time_point deadline) {
+	SubmitScope scope(this);
+	throwIfClosed();
+	m_unfinished++;
+
+	try {
+		if (tryEnqueue(task, priority)) {
+			return true;
+		}
+	}
+	catch (...) {
+		// 入队时内存不足，任务未入队
+		finishTasks();
+		throw;
+	}
+
+	if (std::chrono::steady_clock::now() >= deadline) {
+		finishTasks();
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	size_t enqueued = waitEnqueue(lock, &task, 1, priority, deadline);
+	lock.unlock();
+
+	if (enqueued == 0) {
+		finishTasks();
+		if (!m_start) {
+			throw std::runtime_error("ThreadPool is already colsed");
+		}
+	}
+
+	return enqueued == 1;
+}
+
+
+/**
+ * @description: 对超时未入队的任务执行拒绝策略，调用时不持有线程池锁
+ * @description: 优先级队列不记录提交顺序，队首是优先级最高的任务，DISCARD_OLDEST 只在 FIFO 任务队列中丢弃最早提交的任务，其他任务队列按 DISCARD_LOWEST 处理
+ * @description: 批量提交时之前的任务可能已经入队，THROW 策略只丢弃未入队的任务，已入队的任务仍会执行
+ * @param {Task*} tasks: 未入队的任务，执行、丢弃或入队后被移走
+ * @param {size_t} count: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @param {RejectPolicy} policy: 拒绝策略
+ */
+void ThreadPool::rejectTasks(Task *tasks, size_t count, size_t priority, RejectPolicy policy) {
+	if (policy == RejectPolicy::THROW) {
+		finishTasks(count);
+		throw std::runtime_error("Task rejected: task queue is full");
+	}
+
+	if (policy == RejectPolicy::DISCARD_OLDEST && m_config->m_queue_mode != TaskQueueMode::FIFO) {
+		policy = RejectPolicy::DISCARD_LOWEST;
+	}
+
+	size_t enqueued = 0;
+	for (size_t i = 0; i < count; ++i) {
+		Task victim;
+
+		switch (policy) {
+		case RejectPolicy::CALLER_RUNS:
+			// 由提交者执行，submitTask 提交的任务异常保存在 future 中
+			try {
+				tasks[i]();
+			}
+			catch (...) {
+				handleException(std::current_exception());
+			}
+			break;
+
+		case RejectPolicy::DISCARD_OLDEST:
+			// FIFO 队首即最早提交的任务，丢弃后重新入队，其他提交者抢先占用空位时继续丢弃
+			while (!m_queue->taskEnqueue(tasks[i], priority, m_config->m_max_task)) {
+				if (!m_queue->taskDequeue(victim)) {
+					break;
+				}
+				victim = nullptr;
+				finishTasks();
+			}
+			enqueued += tasks[i] ? 0 : 1;
+			break;
+
+		case RejectPolicy::DISCARD_LOWEST:
+			enqueued += m_queue->taskReplaceLowest(tasks[i], priority, victim) ? 1 : 0;
+			break;
+
+		default:
+			break;
+		}
+
+		// 未能入队、执行的任务以及被替换出的任务在这里被丢弃
+		size_t finished = (tasks[i] ? 1 : 0) + (victim ? 1 : 0);
+		tasks[i] = nullptr;
+		if (finished) {
+			finishTasks(finished);
+		}
+	}
+
+	// 入队的任务与普通提交一样计数并唤醒工作线程
+	if (enqueued) {
+		m_submitted.fetch_add(enqueued, std::memory_order_relaxed);
+		wakeWorker(enqueued);
+	}
+}
+
+
+/**
+ * @description: 有线程休眠时唤醒线程；有工作线程阻塞等待 TaskFuture 时一并唤醒，让其帮助执行
+ * @description: 与工作线程休眠前的再次检查配对，二者之间都有顺序一致的内存屏障，不会丢失唤醒
+ * @param {size_t} count: 新增的任务数量，最多唤醒 min(count, 休眠线程数量) 个线程
+ */
+void ThreadPool::wakeWorker(size_t count) {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	int idle_threads = m_idle_threads.load(std::memory_order_relaxed);
+	if (idle_threads > 0) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+		}
+
+		if (count >= static_cast<size_t>(idle_threads)) {
+			m_queue_not_empty.notify_all();
+		}
+		else {
+			// 唤醒等待中的线程
+			for (size_t i = 0; i < count; ++i) {
+				m_queue_not_empty.notify_one();
+			}
+		}
+	}
+
+	// 等待 TaskFuture 的工作线程也可以执行新任务
+	if (m_blocked_helpers.load(std::memory_order_relaxed) > 0) {
+		FutureCore::notifyHelpers();
+	}
+}
+
+
+/**
+ * @description: 处理任务抛出的未处理异常，没有设置回调时写入日志
+ * @param {std::exception_ptr} exception: 任务抛出的异常
+ */
+void ThreadPool::handleException(std::exception_ptr exception) {
+	std::function<void(std::exception_ptr)> handler;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		handler = m_exception_handler;
+	}
+
+	if (handler) {
+		handler(exception);
+		return;
+	}
+
+	std::string task = "任务抛出未处理的异常: ";
+	try {
+		std::rethrow_exception(exception);
+	}
+	catch (const std::exception &e) {
+		task += e.what();
+	}
+	catch (...) {
+		task += "未知异常";
+	}
+
+#ifdef DEBUG
+	std::cout << task << std::endl;
+#else
+	m_log->addTask(task);
+#endif
+}
+
+
+/**
+ * @description: 设置任务抛出未处理异常时的回调，回调在执行任务的工作线程中调用
+ * @param {std::function<void(std::exception_ptr)>} handler: 回调函数，为空时恢复默认的写入日志
+ */
+void ThreadPool::setExceptionHandler(std::function<void(std::exception_ptr)> handler) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_exception_handler = std::move(handler);
+}
+
+
+/**
+ * @description: 获取工作线程空闲统计，SPIN 策略下自旋和让出 CPU 阶段取到的任务都避免了一次休眠和唤醒
+ * @return {IdleStatistics} 空闲统计
+ */
+IdleStatistics ThreadPool::getIdleStatistics() {
+	IdleStatistics statistics;
+	statistics.m_spin_hits = m_spin_hits.load(std::memory_order_relaxed);
+	statistics.m_yield_hits = m_yield_hits.load(std::memory_order_relaxed);
+	statistics.m_parks = m_parks.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+
+/**
+ * @description: 获取扩缩容线程最近一次采样的结果，FIXED_THREAD 模式下全部为 0
+ * @return {ScalingStatistics} 采样结果
+ */
+ScalingStatistics ThreadPool::getScalingStatistics() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	ScalingStatistics statistics = m_scaling_statistics;
+	statistics.m_reserved = m_reserve.size();
+	statistics.m_spawned = m_spawned;
+	statistics.m_revived = m_revived;
+	statistics.m_reaped = m_reaped;
+	return statistics;
+}
+
+
+/**
+ * @description: 获取内存池统计，内存池属于线程，统计包含本进程所有线程池与直接使用 TaskAllocator 的分配
+ * @description: 平均每个任务的分配次数与字节数按本线程池已入队的任务数量计算，提交失败的任务不计入
+ * @return {ArenaStatistics} 内存池统计
+ */
+ArenaStatistics ThreadPool::getArenaStatistics() {
+	ArenaStatistics statistics = TaskArena::statistics();
+	statistics.m_tasks = m_submitted.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+
+/**
+ * @description: 有提交者因任务队列已满而等待时，通知其可以继续提交任务
+ */
+void ThreadPool::notifySubmitters() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_blocked_submitters.load(std::memory_order_relaxed) > 0) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+		}
+		m_queue_not_full.notify_all();
 	}
 }
 
@@ -161,9 +1118,93 @@ bool ThreadPool::parseConfig(std::string config_path) {
         m_config->m_min_threshold = min < hardware_size ? min : hardware_size;
     }
     m_config->m_timeout = std::chrono::milliseconds(root["timeout"].asInt());
+
+    // 未配置时使用 CALLER_RUNS；配置了无法识别的值时记录日志，避免拼写错误悄悄改变过载时的行为
+    std::string reject_policy = root.isMember("reject_policy") ? root["reject_policy"].asString() : "CALLER_RUNS";
+    if (reject_policy == "BLOCK") {
+        m_config->m_reject_policy = RejectPolicy::BLOCK;
+    }
+    else if (reject_policy == "THROW") {
+        m_config->m_reject_policy = RejectPolicy::THROW;
+    }
+    else if (reject_policy == "DISCARD_NEWEST") {
+        m_config->m_reject_policy = RejectPolicy::DISCARD_NEWEST;
+    }
+    else if (reject_policy == "DISCARD_OLDEST") {
+        m_config->m_reject_policy = RejectPolicy::DISCARD_OLDEST;
+    }
+    else if (reject_policy == "DISCARD_LOWEST") {
+        m_config->m_reject_policy = RejectPolicy::DISCARD_LOWEST;
+    }
+    else {
+        m_config->m_reject_policy = RejectPolicy::CALLER_RUNS;
+        if (reject_policy != "CALLER_RUNS") {
+#ifdef DEBUG
+            std::cout << "无法识别的拒绝策略: " << reject_policy << "，使用 CALLER_RUNS" << std::endl;
+#else
+            m_log->addTask("无法识别的拒绝策略: " + reject_policy + "，使用 CALLER_RUNS");
+#endif
+        }
+    }
     m_config->m_priority_level = root["priority_level"].asInt();
+    m_config->m_priority_buckets = root["priority_buckets"].asInt() > 0 ? root["priority_buckets"].asInt() : 8;
+    m_config->m_submit_buffer_size = root["submit_buffer_size"].asInt() > 0 ? root["submit_buffer_size"].asInt() : 64;
+    m_config->m_submit_buffer_delay = std::chrono::microseconds(root["submit_buffer_delay"].asInt() > 0 ? root["submit_buffer_delay"].asInt() : 1000);
 
     m_config->m_max_task = root["max_task"].asInt();
+    m_config->m_work_stealing = root["WORK_STEALING"].asBool();
+
+    m_config->m_idle_strategy = root["idle_strategy"].asString() == "SPIN" ? IdleStrategy::SPIN : IdleStrategy::PARK;
+    m_config->m_spin_count = root["spin_count"].asInt() > 0 ? root["spin_count"].asInt() : 4096;
+    m_config->m_yield_count = root["yield_count"].asInt() > 0 ? root["yield_count"].asInt() : 16;
+
+    m_config->m_scale_interval = std::chrono::milliseconds(root["scale_interval"].asInt() > 0 ? root["scale_interval"].asInt() : 100);
+    m_config->m_grow_timeout = std::chrono::milliseconds(root["grow_timeout"].isInt() ? root["grow_timeout"].asInt() : 200);
+    m_config->m_shrink_timeout = std::chrono::milliseconds(root["shrink_timeout"].isInt() ? root["shrink_timeout"].asInt() : 5000);
+    m_config->m_grow_utilization = root["grow_utilization"].isNumeric() ? root["grow_utilization"].asDouble() : 0.9;
+    m_config->m_shrink_utilization = root["shrink_utilization"].isNumeric() ? root["shrink_utilization"].asDouble() : 0.3;
+    m_config->m_target_queue_wait = std::chrono::milliseconds(root["target_queue_wait"].isInt() ? root["target_queue_wait"].asInt() : 10);
+    m_config->m_reserve_timeout = std::chrono::milliseconds(root["reserve_timeout"].isInt() ? root["reserve_timeout"].asInt() : 30000);
+
+    std::string affinity = root["affinity"].asString();
+    if (affinity == "COMPACT") {
+        m_config->m_affinity = AffinityPolicy::COMPACT;
+    }
+    else if (affinity == "SCATTER") {
+        m_config->m_affinity = AffinityPolicy::SCATTER;
+    }
+    else if (affinity == "LIST") {
+        m_config->m_affinity = AffinityPolicy::LIST;
+    }
+    else {
+        m_config->m_affinity = AffinityPolicy::NONE;
+    }
+    m_config->m_cpu_list = CpuTopology::parseCpuList(root["cpu_list"].asString());
+    m_config->m_numa_queues = root["numa_queues"].asBool();
+
+    // 追踪模式是全局的，只在配置文件中出现时设置
+    if (root["trace"].asString() == "BUFFER") {
+        Trace::setMode(TraceMode::BUFFER);
+    }
+    else if (root["trace"].asString() == "CONSOLE") {
+        Trace::setMode(TraceMode::CONSOLE);
+    }
+    else if (root["trace"].asString() == "OFF") {
+        Trace::setMode(TraceMode::OFF);
+    }
+
+    if (root["task_queue"].asString() == "FIFO") {
+        m_config->m_queue_mode = TaskQueueMode::FIFO;
+    }
+    else if (root["task_queue"].asString() == "BUCKET") {
+        m_config->m_queue_mode = TaskQueueMode::BUCKET;
+    }
+    else if (root["task_queue"].asString() == "DARY_HEAP") {
+        m_config->m_queue_mode = TaskQueueMode::DARY_HEAP;
+    }
+    else {
+        m_config->m_queue_mode = TaskQueueMode::HEAP;
+    }
 
     return true;
 }
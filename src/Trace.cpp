@@ -0,0 +1,158 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 16:40:12
+ * @last_edit_time: 2026-10-17 16:40:12
+ * @file_path: /Thread-Pool/src/Trace.cpp
+ * @description: 线程池追踪模块源文件
+ */
+
+#include "Trace.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <algorithm>
+
+
+/**
+ * @description: 线程缓冲区，由注册表持有，线程退出后记录仍然保留
+ */
+struct Trace::Buffer {
+    std::vector<TraceRecord> m_records;  // 环形缓冲区
+    size_t m_next = 0;  // 下一次写入的位置（累计写入次数）
+    size_t m_thread;  // 线程编号，按注册顺序分配
+
+    explicit Buffer(size_t thread) : m_records(BUFFER_SIZE), m_thread(thread) { }
+};
+
+
+const size_t Trace::BUFFER_SIZE;
+std::atomic<int> Trace::m_mode(static_cast<int>(TraceMode::OFF));
+
+
+/**
+ * @description: 缓冲区注册表
+ */
+struct Trace::Registry {
+    std::mutex m_mutex;  // 只在注册缓冲区、输出、清空时加锁
+    std::vector<std::unique_ptr<Buffer>> m_buffers;  // 所有线程的缓冲区
+};
+
+
+/**
+ * @description: 获取缓冲区注册表，使用函数内静态变量，避免静态初始化顺序问题
+ * @return {Registry&} 缓冲区注册表
+ */
+Trace::Registry &Trace::registry() {
+    static Registry registry;
+    return registry;
+}
+
+
+/**
+ * @description: 获取当前线程的缓冲区，第一次调用时注册
+ * @return {Buffer*} 当前线程的缓冲区
+ */
+Trace::Buffer* Trace::localBuffer() {
+    static thread_local Buffer* buffer = nullptr;
+
+    if (buffer == nullptr) {
+        Registry &buffers = registry();
+        std::unique_lock<std::mutex> lock(buffers.m_mutex);
+        buffers.m_buffers.emplace_back(new Buffer(buffers.m_buffers.size()));
+        buffer = buffers.m_buffers.back().get();
+    }
+
+    return buffer;
+}
+
+
+/**
+ * @description: 设置运行时追踪模式
+ * @param {TraceMode} mode: 追踪模式
+ */
+void Trace::setMode(TraceMode mode) {
+    m_mode.store(static_cast<int>(mode), std::memory_order_relaxed);
+}
+
+
+/**
+ * @description: 获取运行时追踪模式
+ * @return {TraceMode} 追踪模式
+ */
+TraceMode Trace::getMode() {
+    return static_cast<TraceMode>(m_mode.load(std::memory_order_relaxed));
+}
+
+
+/**
+ * @description: 记录一个事件，BUFFER 模式下只写入当前线程的缓冲区
+ * @param {int} level: 追踪等级
+ * @param {const char*} event: 事件描述，必须是字符串字面量
+ * @param {int64_t} first: 第一个参数
+ * @param {int64_t} second: 第二个参数
+ */
+void Trace::record(int level, const char* event, int64_t first, int64_t second) {
+    uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    if (getMode() == TraceMode::CONSOLE) {
+        std::cout << "tid: " << std::this_thread::get_id() << " " << event << " (" << first << ", " << second << ")" << std::endl;
+        return;
+    }
+
+    Buffer* buffer = localBuffer();
+    TraceRecord &record = buffer->m_records[buffer->m_next % BUFFER_SIZE];
+    record.m_time = now;
+    record.m_event = event;
+    record.m_first = first;
+    record.m_second = second;
+    record.m_level = level;
+    buffer->m_next++;
+}
+
+
+/**
+ * @description: 按时间顺序输出所有线程缓冲区中的记录
+ * @param {ostream} &os: 输出流
+ */
+void Trace::dump(std::ostream &os) {
+    std::vector<std::pair<TraceRecord, size_t>> records;
+
+    {
+        Registry &buffers = registry();
+        std::unique_lock<std::mutex> lock(buffers.m_mutex);
+        for (const std::unique_ptr<Buffer> &buffer : buffers.m_buffers) {
+            size_t amount = std::min(buffer->m_next, BUFFER_SIZE);
+            for (size_t i = buffer->m_next - amount; i < buffer->m_next; ++i) {
+                records.emplace_back(buffer->m_records[i % BUFFER_SIZE], buffer->m_thread);
+            }
+        }
+    }
+
+    std::sort(records.begin(), records.end(), [](const std::pair<TraceRecord, size_t> &a, const std::pair<TraceRecord, size_t> &b) {
+        return a.first.m_time < b.first.m_time;
+    });
+
+    for (const std::pair<TraceRecord, size_t> &record : records) {
+        os << record.first.m_time << " [" << record.second << "] " << record.first.m_event
+            << " (" << record.first.m_first << ", " << record.first.m_second << ")\n";
+    }
+    os.flush();
+}
+
+
+/**
+ * @description: 清空所有线程缓冲区
+ */
+void Trace::clear() {
+    Registry &buffers = registry();
+    std::unique_lock<std::mutex> lock(buffers.m_mutex);
+    for (const std::unique_ptr<Buffer> &buffer : buffers.m_buffers) {
+        buffer->m_next = 0;
+    }
+}
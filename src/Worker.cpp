@@ -3,77 +3,307 @@
  * @github: https://github.com/yuyuyuj1e
  * @csdn: https://blog.csdn.net/yuyuyuj1e
  * @date: 2023-03-29 19:06:23
- * @last_edit_time: 2023-04-05 15:17:07
+ * @last_edit_time: 2026-10-19 14:17:22
  * @file_path: /Thread-Pool/src/Worker.cpp
  * @description: 线程池内部工作类的源文件
  */
 
 
 #include "ThreadPool.h"
+#include <algorithm>
+
+
+/**
+ * @description: 自旋等待时提示 CPU 降低功耗、让出流水线给同核的超线程
+ */
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield" ::: "memory");
+#else
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+
+static const size_t SPIN_CHECK_INTERVAL = 16;  // 自旋时每隔多少次检查一次任务队列与自旋时长
+static const int IDLE_GAP_WEIGHT = 8;  // 空闲时长滑动平均中历史值的权重，新样本占 1/IDLE_GAP_WEIGHT
 
 /**
  * @description: 工作线程构造函数
  * @param {ThreadPool} *pool: 工作线程所属线程池
  * @param {int} id: 工作线程 ID
+ * @param {int} slot: 工作线程槽位
  */
-ThreadPool::Worker::Worker(ThreadPool *pool, const int id) 
-	: m_pool(pool)
-	, m_id(id)
+ThreadPool::Worker::Worker(ThreadPool *pool, const int id, const int slot) 
+	: m_id(id)
+	, m_slot(slot)
+	, m_seed(static_cast<unsigned>(slot) * 2654435761u + 1)
+	, m_idle_gap(0)
+	, m_spin_span(0)
+	, m_pool(pool)
 { }
 
 
+/**
+ * @description: 获取任务，工作窃取模式下依次尝试本地双端队列、全局注入队列、其他线程的双端队列
+ * @param {Task&} task: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+bool ThreadPool::Worker::fetchTask(Task &task) {
+	if (!m_pool->m_config->m_work_stealing) {
+		return m_pool->m_queue->taskDequeue(task);
+	}
+
+	// 本地队列，后进先出，缓存局部性更好
+	Task* local_task = nullptr;
+	if (m_pool->m_deques[m_slot]->pop(local_task)) {
+		task = std::move(*local_task);
+		deleteLocalTask(local_task);
+		return true;
+	}
+
+	// 全局注入队列，保留优先级语义
+	if (m_pool->m_queue->taskDequeue(task)) {
+		return true;
+	}
+
+	return stealTask(task);
+}
+
+
+/**
+ * @description: 随机选择其他工作线程，从其双端队列顶部窃取任务
+ * @description: 绑定了 CPU 时先只窃取同一 NUMA 节点上的线程，都窃取不到才跨节点
+ * @param {Task&} task: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+bool ThreadPool::Worker::stealTask(Task &task) {
+	size_t slots = m_pool->m_deques.size();
+	int node = m_pool->m_slot_nodes[m_slot];
+
+	for (size_t i = 0; i < 2 * slots; ++i) {
+		// 前一半只在本节点内窃取，未绑定时直接跳过
+		bool local_only = i < slots;
+		if (local_only && node < 0) {
+			i = slots - 1;
+			continue;
+		}
+
+		// xorshift 伪随机数
+		m_seed ^= m_seed << 13;
+		m_seed ^= m_seed >> 17;
+		m_seed ^= m_seed << 5;
+
+		size_t victim = m_seed % slots;
+		if (victim == static_cast<size_t>(m_slot) || (local_only && m_pool->m_slot_nodes[victim] != node)) {
+			continue;
+		}
+
+		Task* stolen_task = nullptr;
+		if (m_pool->m_deques[victim]->steal(stolen_task)) {
+			task = std::move(*stolen_task);
+			deleteLocalTask(stolen_task);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @description: SPIN 策略下休眠前的等待：先自旋，再让出 CPU m_yield_count 次
+ * @description: 自旋时长按测得的任务到达间隔自适应：最多自旋平均空闲时长的两倍，且不超过 spin_count 次；平均空闲时长超过自旋 spin_count 次的耗时时，自旋等不到任务，直接让出 CPU
+ * @param {Task&} task: 获取任务函数的空函数
+ * @param {std::chrono::steady_clock::time_point} idle_since: 开始空闲的时间
+ * @return {bool} true/false
+ */
+bool ThreadPool::Worker::spinForTask(Task &task, std::chrono::steady_clock::time_point idle_since) {
+	const ThreadPoolConfig* config = m_pool->m_config;
+
+	// 还没有测得空闲时长时自旋到上限，同时测出自旋上限的耗时
+	bool spin = m_spin_span.count() == 0 || m_idle_gap <= m_spin_span;
+	std::chrono::nanoseconds window = m_idle_gap.count() == 0 ? std::chrono::nanoseconds::max() : 2 * m_idle_gap;
+
+	size_t i = 1;
+	for (; spin && i <= config->m_spin_count && m_pool->m_start; ++i) {
+		cpuRelax();
+		if (i % SPIN_CHECK_INTERVAL != 0) {
+			continue;
+		}
+		if (m_pool->hasPendingTask() && fetchTask(task)) {
+			m_pool->m_spin_hits.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+		if (std::chrono::steady_clock::now() - idle_since >= window) {
+			break;
+		}
+	}
+	if (spin && i > config->m_spin_count) {
+		m_spin_span = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - idle_since);
+	}
+
+	for (size_t i = 0; i < config->m_yield_count && m_pool->m_start; ++i) {
+		std::this_thread::yield();
+		if (m_pool->hasPendingTask() && fetchTask(task)) {
+			m_pool->m_yield_hits.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @description: 记录一次空闲时长 (从取不到任务到取到下一个任务)，更新滑动平均
+ * @description: 休眠很久的样本按自旋上限耗时的两倍计，一次长时间空闲不会让平均值长期偏大而停止自旋
+ * @param {std::chrono::steady_clock::time_point} idle_since: 开始空闲的时间
+ */
+void ThreadPool::Worker::recordIdleGap(std::chrono::steady_clock::time_point idle_since) {
+	std::chrono::nanoseconds gap = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - idle_since);
+	if (m_spin_span.count() > 0) {
+		gap = std::min(gap, 2 * m_spin_span);
+	}
+
+	m_idle_gap = m_idle_gap.count() == 0 ? gap : (m_idle_gap * (IDLE_GAP_WEIGHT - 1) + gap) / IDLE_GAP_WEIGHT;
+}
+
+
+/**
+ * @description: 停放到后备池，在自己槽位的条件变量上等待，调用前需持有 m_mutex
+ * @description: 被 addWorker 唤醒时继续工作，不需要重新创建线程；线程池关闭或停放过久被回收时退出
+ * @param {std::unique_lock<std::mutex>&} lock: m_mutex 的锁
+ * @return {bool} 被唤醒继续工作返回 true，需要退出返回 false
+ */
+bool ThreadPool::Worker::park(std::unique_lock<std::mutex> &lock) {
+	WorkerSlot &slot = *m_pool->m_slots[m_slot];
+
+	slot.m_parked = true;
+	slot.m_parked_since = std::chrono::steady_clock::now();
+	m_pool->m_reserve.push_back(m_slot);
+	m_pool->m_thread_amount--;
+	TP_TRACE_INFO("工作线程停放，剩余线程", m_id, m_pool->m_thread_amount);
+
+	slot.m_revive.wait(lock, [&]() { return !slot.m_parked || slot.m_stop || !m_pool->m_start; });
+
+	if (slot.m_parked) {
+		TP_TRACE_INFO("后备线程退出", m_id, m_slot);
+		return false;
+	}
+
+	TP_TRACE_INFO("后备线程被唤醒，当前线程", m_id, m_pool->m_thread_amount);
+	return true;
+}
+
+
+/**
+ * @description: 执行任务，任务抛出的未处理异常交给线程池处理，执行完毕后计入完成数量
+ * @param {Task&} func: 任务函数，执行后置空
+ */
+void ThreadPool::Worker::execute(Task &func) {
+	// 取出一个任务进行通知 通知可以继续提交任务
+	m_pool->notifySubmitters();
+	TP_TRACE_DEBUG("已领取任务，当前任务数量", m_id, m_pool->m_queue->size());
+	try {
+		func();
+	}
+	catch (...) {
+		// submitTask 提交的任务异常保存在 future 中，只有 post 提交的任务会走到这里
+		m_pool->handleException(std::current_exception());
+	}
+	func = nullptr;  // 及时释放任务捕获的资源
+	m_pool->finishTasks();
+}
+
+
+/**
+ * @description: 取出并执行一个任务，在工作线程等待 TaskFuture 时调用，可能嵌套在另一个任务的执行过程中
+ * @return {bool} 执行了一个任务返回 true
+ */
+bool ThreadPool::Worker::helpOnce() {
+	Task func;
+	if (!fetchTask(func)) {
+		return false;
+	}
+	execute(func);
+	return true;
+}
+
+
 /**
  * @description: 重载 ()，这里是工作线程的工作函数，提交的函数会在这里执行
+ * @description: 取任务时不持有线程池锁，只有在没有任务、准备休眠时才加锁
  */
 void ThreadPool::Worker::operator()() {
-	std::function<void()> func;  // 存放真正执行的函数
-	bool dequeued = false;  // 是否取出任务
-
-	while (m_pool->m_start || !m_pool->m_queue.empty()) {
-		{
-			// 线程池加锁
-			std::unique_lock<std::mutex> lock(m_pool->m_mutex);
-
-			std::cout << "tid: " << std::this_thread::get_id() << " 正在尝试获取任务" << std::endl;
-
-			// 如果任务队列为空，阻塞当前线程
-			if (m_pool->m_queue.empty()) {
-				std::cout << "任务队列空，等待任务..." << std::endl;
-				if (m_pool->m_config->m_mode == ThreadPoolWorkMode::FIXED_THREAD) {
-					m_pool->m_queue_not_empty.wait(lock);  // 等待任务
-				}
-				else if (m_pool->m_config->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD) {
-					
-					if (std::cv_status::timeout == m_pool->m_queue_not_empty.wait_for(lock, std::chrono::milliseconds(m_pool->m_config->m_timeout))) {
-						
-						if (m_pool->m_thread_amount > m_pool->m_config->m_min_threshold) {
-							std::cout << "tid:" << std::this_thread::get_id() << " 退出! ---- ";
-							m_pool->m_threads[m_id].detach();
-							m_pool->m_threads.erase(m_id);
-							m_pool->m_thread_amount--;
-							std::cout << "剩余线程: " << m_pool->m_thread_amount << std::endl;
-							return ;
-						}
-						else {
-							m_pool->m_queue_not_empty.wait(lock);  // 等待任务
-						}
-					}
-				}
+	Task func;  // 存放真正执行的函数
+	bool spin = m_pool->m_config->m_idle_strategy == IdleStrategy::SPIN;
+	std::chrono::steady_clock::time_point idle_since;  // SPIN 策略下开始空闲的时间，不空闲时为默认值
+
+	m_local_pool = m_pool;
+	m_local_slot = m_slot;
+	m_local_worker = this;
+	m_pool->bindWorker(m_slot);
+
+	while (true) {
+		// shutdownNow 要求立即退出，剩余任务由 shutdownNow 取出返回
+		if (m_pool->m_stop_now) {
+			return ;
+		}
+
+		TP_TRACE_DEBUG("正在尝试获取任务", m_id, m_slot);
+
+		// 如果成功取出，执行工作函数；SPIN 策略下取不到任务时先自旋等待，避免休眠与唤醒的开销
+		bool fetched = fetchTask(func);
+		if (spin && !fetched) {
+			if (idle_since == std::chrono::steady_clock::time_point()) {
+				idle_since = std::chrono::steady_clock::now();
 			}
+			fetched = spinForTask(func, idle_since);
+		}
+		if (fetched) {
+			if (spin && idle_since != std::chrono::steady_clock::time_point()) {
+				recordIdleGap(idle_since);
+				idle_since = std::chrono::steady_clock::time_point();
+			}
+			execute(func);
+			continue;
+		}
 
-			// 取出任务队列中的元素
-			dequeued = m_pool->m_queue.taskDequeue(func);
+		// 线程池加锁，准备休眠
+		std::unique_lock<std::mutex> lock(m_pool->m_mutex);
+		m_pool->m_idle_threads++;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		// 休眠前再次检查，与提交者的 wakeWorker 配对，避免丢失唤醒
+		if (m_pool->hasPendingTask()) {
+			m_pool->m_idle_threads--;
+			continue;
 		}
 
-		// 如果成功取出，执行工作函数
-		if (dequeued) {
-			// 取出一个任务进行通知 通知可以继续提交任务
-			m_pool->m_queue_not_full.notify_all();
-			std::cout << "tid: " << std::this_thread::get_id() << " 已领取任务，当前任务数量为: " << m_pool->m_queue.size() << "  ----->   " << m_pool->m_threads.size() << std::endl;
-			func();
+		// 线程池已关闭且任务全部完成，退出；仍有提交者在关闭前通过检查时继续等待其任务入队，由 stopThreads 唤醒
+		if (!m_pool->m_start && m_pool->m_submitting.load() == 0) {
+			m_pool->m_idle_threads--;
+			return ;
 		}
-		else {
-			std::cout << "tid: " << std::this_thread::get_id() << " 取出任务失败" << std::endl;
+
+		// 扩缩容线程要求减少线程，由空闲线程停放到后备池
+		if (m_pool->m_retire_requests > 0) {
+			m_pool->m_retire_requests--;
+			m_pool->m_idle_threads--;
+			if (!park(lock)) {
+				return ;
+			}
+			continue;
 		}
+
+		// 如果任务队列为空，阻塞当前线程
+		TP_TRACE_DEBUG("任务队列空，等待任务", m_id, m_slot);
+		m_pool->m_parks.fetch_add(1, std::memory_order_relaxed);
+		m_pool->m_queue_not_empty.wait(lock);  // 等待任务
+
+		m_pool->m_idle_threads--;
 	}
-}
\ No newline at end of file
+}
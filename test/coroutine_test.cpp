@@ -0,0 +1,142 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 17:30:06
+ * @last_edit_time: 2026-10-19 17:10:26
+ * @file_path: /Thread-Pool/test/coroutine_test.cpp
+ * @description: C++20 协程支持测试，以 C++20 编译
+ */
+
+#include <iostream>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "CoTask.h"
+
+
+static int g_failed = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << " 检查失败: " #cond << std::endl; \
+			++g_failed; \
+		} \
+	} while (0)
+
+
+// 切换到线程池后运行在工作线程上
+CoTask<std::thread::id> switchThread(ThreadPool &pool) {
+	co_await pool.schedule();
+	co_return std::this_thread::get_id();
+}
+
+
+CoTask<int> square(ThreadPool &pool, int value) {
+	co_await pool.schedule(0);
+	co_return value * value;
+}
+
+
+// 嵌套等待 CoTask，并在协程中等待 submitAsync 的结果，不阻塞线程
+CoTask<int> sumOfSquares(ThreadPool &pool, int n) {
+	int sum = 0;
+	for (int i = 1; i <= n; ++i) {
+		sum += co_await square(pool, i);
+	}
+	sum += co_await pool.submitAsync([]() { return 1000; });
+	co_return sum;
+}
+
+
+CoTask<void> fail(ThreadPool &pool) {
+	co_await pool.schedule();
+	throw std::runtime_error("coroutine");
+}
+
+
+// schedule、嵌套 CoTask、等待 TaskFuture、异常传递
+void testCoroutine(ThreadPool &pool) {
+	CHECK(switchThread(pool).get() != std::this_thread::get_id());
+	CHECK(sumOfSquares(pool, 10).get() == 385 + 1000);
+
+	bool thrown = false;
+	try {
+		fail(pool).get();
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	// 大量协程同时挂起在线程池中，由主线程依次等待结果；协程内部等待 CoTask 与 TaskFuture 时不阻塞工作线程
+	std::vector<TaskFuture<int>> futures;
+	for (int i = 0; i < 200; ++i) {
+		futures.push_back(sumOfSquares(pool, i % 20).start(&pool));
+	}
+	int total = 0;
+	for (TaskFuture<int> &future : futures) {
+		total += future.get() - 1000;
+	}
+	int expected = 0;
+	for (int i = 0; i < 200; ++i) {
+		int n = i % 20;
+		expected += n * (n + 1) * (2 * n + 1) / 6;
+	}
+	CHECK(total == expected);
+
+	TaskFuture<int> nested = pool.submitAsync([&pool]() { return sumOfSquares(pool, 3).get(&pool); });
+	CHECK(nested.get() == 14 + 1000);
+}
+
+
+// 协程帧通过 CoFrameAllocation 从 TaskArena 分配：只创建不执行的协程分配一次，运行到结束还要分配驱动协程的帧与结果的共享状态
+void testFrameAllocation(ThreadPool &pool) {
+	size_t before = TaskArena::statistics().m_allocations;
+	{
+		CoTask<int> lazy = square(pool, 3);
+		CHECK(lazy.valid());
+	}
+	size_t created = TaskArena::statistics().m_allocations;
+	CHECK(created - before >= 1);
+
+	CHECK(square(pool, 3).get() == 9);
+	CHECK(TaskArena::statistics().m_allocations - created >= 3);
+}
+
+
+// 线程池已关闭时 schedule 抛出异常
+void testClosed() {
+	ThreadPool pool;
+	pool.close();
+
+	bool thrown = false;
+	try {
+		switchThread(pool).get();
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+
+int main() {
+	{
+		ThreadPool pool;
+		testCoroutine(pool);
+		testFrameAllocation(pool);
+	}
+
+	testClosed();
+
+	if (g_failed) {
+		std::cerr << g_failed << " 项检查失败" << std::endl;
+		return 1;
+	}
+
+	std::cerr << "全部检查通过" << std::endl;
+	return 0;
+}
@@ -0,0 +1,341 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 14:36:42
+ * @last_edit_time: 2026-10-18 16:48:30
+ * @file_path: /Thread-Pool/test/parallel_bench.cpp
+ * @description: 并行算法与顺序实现的耗时对比，在 bin 目录下运行
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <future>
+#include <numeric>
+#include <functional>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+#include "ThreadPool.h"
+#include "json/json.h"
+
+
+using Clock = std::chrono::steady_clock;
+
+static const int REPEAT = 5;  // 每项重复次数，取最短耗时
+
+
+/**
+ * @description: 重复执行 REPEAT 次，返回最短耗时
+ * @param {Func} func: 被测函数，返回结果用于防止被优化掉
+ * @param {double&} result: 最后一次的结果
+ * @return {double} 最短耗时 (毫秒)
+ */
+template <typename Func>
+static double measure(Func func, double &result) {
+	double best = 0;
+	for (int i = 0; i < REPEAT; ++i) {
+		Clock::time_point start = Clock::now();
+		result = func();
+		double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		if (i == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+
+static void report(const std::string &name, size_t size, double milliseconds, double serial, double result) {
+	std::cout << std::left << std::setw(24) << name
+		<< std::setw(12) << size
+		<< std::setw(12) << std::fixed << std::setprecision(2) << milliseconds
+		<< std::setw(10) << serial / milliseconds
+		<< std::setprecision(4) << result
+		<< std::endl;
+}
+
+
+/**
+ * @description: 求和与平方和：顺序 std::accumulate、每个分片一个任务再累加 std::future、parallelReduce / transformReduce
+ * @param {ThreadPool&} pool: 线程池
+ * @param {size_t} size: 元素数量
+ */
+static void benchReduce(ThreadPool &pool, size_t size) {
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<double> values(size);
+	for (double &value : values) {
+		value = distribution(random);
+	}
+
+	double result = 0;
+	double serial = measure([&]() { return std::accumulate(values.begin(), values.end(), 0.0); }, result);
+	report("accumulate", size, serial, serial, result);
+
+	double sharded = measure([&]() {
+		const size_t shards = 64;
+		std::vector<std::future<double>> futures;
+		for (size_t i = 0; i < shards; ++i) {
+			size_t first = size * i / shards;
+			size_t last = size * (i + 1) / shards;
+			futures.push_back(pool.submitTask([&values, first, last]() {
+				return std::accumulate(values.begin() + first, values.begin() + last, 0.0);
+			}));
+		}
+		double sum = 0;
+		for (std::future<double> &future : futures) {
+			sum += future.get();
+		}
+		return sum;
+	}, result);
+	report("submitTask per shard", size, sharded, serial, result);
+
+	double reduced = measure([&]() { return pool.parallelReduce(values.begin(), values.end(), 0.0, std::plus<double>()); }, result);
+	report("parallelReduce", size, reduced, serial, result);
+
+	auto square = [](double x) { return x * x; };
+	double squares = measure([&]() {
+		double sum = 0;
+		for (double value : values) {
+			sum += square(value);
+		}
+		return sum;
+	}, result);
+	report("serial sum of squares", size, squares, squares, result);
+
+	double transformed = measure([&]() { return pool.transformReduce(values.begin(), values.end(), 0.0, std::plus<double>(), square); }, result);
+	report("transformReduce", size, transformed, squares, result);
+}
+
+
+/**
+ * @description: 由记录长度计算偏移：顺序排除式前缀和与 parallelExclusiveScan
+ * @param {ThreadPool&} pool: 线程池
+ * @param {size_t} size: 记录数量
+ */
+static void benchScan(ThreadPool &pool, size_t size) {
+	std::mt19937 random(42);
+	std::vector<unsigned> lengths(size);
+	for (unsigned &length : lengths) {
+		length = random() % 4096;
+	}
+	std::vector<size_t> offsets(size);
+
+	double result = 0;
+	double serial = measure([&]() {
+		size_t offset = 0;
+		for (size_t i = 0; i < size; ++i) {
+			offsets[i] = offset;
+			offset += lengths[i];
+		}
+		return static_cast<double>(offsets.back());
+	}, result);
+	report("serial exclusive scan", size, serial, serial, result);
+
+	double scanned = measure([&]() {
+		pool.parallelExclusiveScan(lengths.begin(), lengths.end(), offsets.begin(), static_cast<size_t>(0));
+		return static_cast<double>(offsets.back());
+	}, result);
+	report("parallelExclusiveScan", size, scanned, serial, result);
+}
+
+
+/**
+ * @description: 按键分组求和：顺序 unordered_map、每个分块一个任务共用加锁的 unordered_map、parallelGroupBy
+ * @param {ThreadPool&} pool: 线程池
+ * @param {size_t} size: 行数
+ * @param {size_t} keys: 不同键的数量
+ */
+static void benchGroupBy(ThreadPool &pool, size_t size, size_t keys) {
+	std::mt19937 random(42);
+	std::vector<std::pair<unsigned, double>> rows(size);
+	for (std::pair<unsigned, double> &row : rows) {
+		row = std::make_pair(static_cast<unsigned>(random() % keys), static_cast<double>(random() % 100));
+	}
+
+	double result = 0;
+	double serial = measure([&]() {
+		std::unordered_map<unsigned, double> groups;
+		for (const std::pair<unsigned, double> &row : rows) {
+			groups[row.first] += row.second;
+		}
+		return static_cast<double>(groups.size());
+	}, result);
+	report("serial group by", size, serial, serial, result);
+
+	double locked = measure([&]() {
+		const size_t chunks = 64;
+		std::unordered_map<unsigned, double> groups;
+		std::mutex mutex;
+		std::vector<std::future<void>> futures;
+		for (size_t i = 0; i < chunks; ++i) {
+			size_t first = size * i / chunks;
+			size_t last = size * (i + 1) / chunks;
+			futures.push_back(pool.submitTask([&rows, &groups, &mutex, first, last]() {
+				for (size_t j = first; j < last; ++j) {
+					std::lock_guard<std::mutex> lock(mutex);
+					groups[rows[j].first] += rows[j].second;
+				}
+			}));
+		}
+		for (std::future<void> &future : futures) {
+			future.get();
+		}
+		return static_cast<double>(groups.size());
+	}, result);
+	report("locked unordered_map", size, locked, serial, result);
+
+	double grouped = measure([&]() {
+		auto groups = pool.parallelGroupBy(rows.begin(), rows.end(),
+			[](const std::pair<unsigned, double> &row) { return row.first; },
+			[](const std::pair<unsigned, double> &row) { return row.second; },
+			std::plus<double>());
+		return static_cast<double>(groups.size());
+	}, result);
+	report("parallelGroupBy", size, grouped, serial, result);
+}
+
+
+/**
+ * @description: 以默认配置为基础生成固定线程数量的配置文件，用于比较不同线程数量下的耗时
+ * @param {size_t} threads: 线程数量
+ * @return {string} 配置文件路径，使用后删除
+ */
+static std::string fixedThreadConfig(size_t threads) {
+	Json::Value root;
+	Json::Reader reader;
+	std::ifstream input("../conf/threadpool.json");
+	reader.parse(input, root);
+
+	root["FIXED_THREAD"] = true;
+	root["max_threads"] = static_cast<int>(threads);
+	root["min_threads"] = static_cast<int>(threads);
+	root["max_task"] = 1000;
+
+	std::string path = "parallel_bench.json";
+	std::ofstream output(path);
+	output << Json::StyledWriter().write(root);
+	return path;
+}
+
+
+/**
+ * @description: 生成指定分布的输入
+ * @param {string} distribution: random / sorted / reversed / few_unique / nearly_sorted
+ * @param {size_t} size: 元素数量
+ * @return {vector<int>} 输入
+ */
+static std::vector<int> sortInput(const std::string &distribution, size_t size) {
+	std::mt19937 random(42);
+	std::vector<int> values(size);
+	for (size_t i = 0; i < size; ++i) {
+		values[i] = distribution == "few_unique" ? static_cast<int>(random() % 16) : static_cast<int>(random());
+	}
+
+	if (distribution == "sorted" || distribution == "reversed" || distribution == "nearly_sorted") {
+		std::sort(values.begin(), values.end());
+	}
+	if (distribution == "reversed") {
+		std::reverse(values.begin(), values.end());
+	}
+	if (distribution == "nearly_sorted") {
+		for (size_t i = 0; i < size / 100; ++i) {
+			std::swap(values[random() % size], values[random() % size]);
+		}
+	}
+	return values;
+}
+
+
+/**
+ * @description: 每次复制输入后排序，只计排序的耗时，返回 REPEAT 次中的最短耗时
+ * @param {vector<int>&} input: 输入
+ * @param {Sort} sort: 排序函数，参数为待排序的 vector
+ * @return {double} 最短耗时 (毫秒)
+ */
+template <typename Sort>
+static double measureSort(const std::vector<int> &input, Sort sort) {
+	double best = 0;
+	for (int i = 0; i < REPEAT; ++i) {
+		std::vector<int> values(input);
+		Clock::time_point start = Clock::now();
+		sort(values);
+		double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		if (!std::is_sorted(values.begin(), values.end())) {
+			std::cout << "unsorted result" << std::endl;
+		}
+		if (i == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+
+/**
+ * @description: 不同输入分布与线程数量下 parallelSort / parallelStableSort 相对 std::sort / std::stable_sort 的加速比
+ * @param {size_t} size: 元素数量
+ */
+static void benchSort(size_t size) {
+	const char* distributions[] = { "random", "sorted", "reversed", "few_unique", "nearly_sorted" };
+	// 1, 2, 4 ... 直到硬件线程数量 (线程池的线程数量不超过硬件线程数量)
+	std::vector<size_t> thread_counts;
+	size_t hardware = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+	for (size_t threads = 1; threads < hardware; threads *= 2) {
+		thread_counts.push_back(threads);
+	}
+	thread_counts.push_back(hardware);
+
+	std::cout << std::endl << std::left << std::setw(16) << "distribution" << std::setw(10) << "threads"
+		<< std::setw(14) << "sort(ms)" << std::setw(10) << "speedup"
+		<< std::setw(14) << "stable(ms)" << "speedup" << std::endl;
+
+	for (const char* distribution : distributions) {
+		std::vector<int> input = sortInput(distribution, size);
+		double serial = measureSort(input, [](std::vector<int> &values) { std::sort(values.begin(), values.end()); });
+		double serial_stable = measureSort(input, [](std::vector<int> &values) { std::stable_sort(values.begin(), values.end()); });
+		std::cout << std::left << std::setw(16) << distribution << std::setw(10) << "serial"
+			<< std::setw(14) << std::fixed << std::setprecision(2) << serial << std::setw(10) << 1.0
+			<< std::setw(14) << serial_stable << 1.0 << std::endl;
+
+		for (size_t threads : thread_counts) {
+			std::string config = fixedThreadConfig(threads);
+			ThreadPool pool(config);
+			std::remove(config.c_str());
+
+			double sorted = measureSort(input, [&pool](std::vector<int> &values) { pool.parallelSort(values.begin(), values.end()); });
+			double stable = measureSort(input, [&pool](std::vector<int> &values) { pool.parallelStableSort(values.begin(), values.end()); });
+			std::cout << std::left << std::setw(16) << distribution << std::setw(10) << pool.getThreadsAmount()
+				<< std::setw(14) << sorted << std::setw(10) << serial / sorted
+				<< std::setw(14) << stable << serial_stable / stable << std::endl;
+			pool.close();
+		}
+	}
+}
+
+
+int main() {
+	const size_t sizes[] = { 1000000, 10000000 };
+
+	{
+		ThreadPool pool;
+		std::cout << std::left << std::setw(24) << "algorithm" << std::setw(12) << "size"
+			<< std::setw(12) << "time(ms)" << std::setw(10) << "speedup" << "result" << std::endl;
+
+		for (size_t size : sizes) {
+			benchReduce(pool, size);
+			benchScan(pool, size);
+		}
+		benchGroupBy(pool, 4000000, 100000);
+		pool.close();
+	}
+
+	benchSort(2000000);
+	return 0;
+}
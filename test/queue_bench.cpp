@@ -0,0 +1,94 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 19:10:05
+ * @last_edit_time: 2026-10-17 19:10:05
+ * @file_path: /Thread-Pool/test/queue_bench.cpp
+ * @description: 优先级队列入队、出队开销对比
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "HeapSafeQueue.h"
+#include "DaryHeapSafeQueue.h"
+#include "BucketSafeQueue.h"
+
+
+using Clock = std::chrono::steady_clock;
+
+static double nanosecondsPerOperation(Clock::time_point start, Clock::time_point end, size_t operations) {
+	return std::chrono::duration<double, std::nano>(end - start).count() / operations;
+}
+
+
+/**
+ * @description: 先填充 queued 个任务，再在保持队列大小不变的情况下执行 rounds 次 出队 + 入队
+ * @param {string} name: 队列名称
+ * @param {TaskQueue&} queue: 被测队列
+ * @param {size_t} queued: 队列中的任务数量
+ * @param {size_t} rounds: 出队 + 入队的次数
+ * @param {size_t} priorities: 优先级范围
+ */
+void bench(const std::string &name, TaskQueue &queue, size_t queued, size_t rounds, size_t priorities) {
+	std::mt19937 random(42);
+	std::uniform_int_distribution<size_t> priority(0, priorities - 1);
+	size_t executed = 0;
+
+	Clock::time_point start = Clock::now();
+	for (size_t i = 0; i < queued; ++i) {
+		Task task([&executed]() { ++executed; });
+		queue.taskEnqueue(task, priority(random), queued);
+	}
+	Clock::time_point filled = Clock::now();
+
+	Task task;
+	for (size_t i = 0; i < rounds; ++i) {
+		queue.taskDequeue(task);
+		task();
+		Task next([&executed]() { ++executed; });
+		queue.taskEnqueue(next, priority(random), queued);
+	}
+	Clock::time_point end = Clock::now();
+
+	while (queue.taskDequeue(task)) {
+		task();
+	}
+
+	std::cout << std::left << std::setw(20) << name
+		<< std::setw(10) << queued
+		<< std::setw(16) << std::fixed << std::setprecision(1) << nanosecondsPerOperation(start, filled, queued)
+		<< std::setw(16) << nanosecondsPerOperation(filled, end, rounds)
+		<< std::endl;
+}
+
+
+int main() {
+	const size_t rounds = 1000000;
+	const size_t sizes[] = { 1000, 100000 };
+
+	std::cout << std::left << std::setw(20) << "queue" << std::setw(10) << "queued"
+		<< std::setw(16) << "enqueue(ns)" << std::setw(16) << "deq+enq(ns)" << std::endl;
+
+	for (size_t queued : sizes) {
+		{
+			HeapSafeQueue queue;
+			bench("HeapSafeQueue", queue, queued, rounds, 1000);
+		}
+		{
+			DaryHeapSafeQueue queue(queued);
+			bench("DaryHeapSafeQueue", queue, queued, rounds, 1000);
+		}
+		{
+			BucketSafeQueue queue(64);
+			bench("BucketSafeQueue", queue, queued, rounds, 64);
+		}
+	}
+
+	return 0;
+}
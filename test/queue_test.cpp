@@ -0,0 +1,253 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 18:06:52
+ * @last_edit_time: 2026-10-19 15:02:40
+ * @file_path: /Thread-Pool/test/queue_test.cpp
+ * @description: 任务队列出队顺序与 NUMA 拓扑测试
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "HeapSafeQueue.h"
+#include "RingSafeQueue.h"
+#include "BucketSafeQueue.h"
+#include "DaryHeapSafeQueue.h"
+#include "NumaSafeQueue.h"
+#include "Affinity.h"
+
+
+static int g_failed = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << " 检查失败: " #cond << std::endl; \
+			++g_failed; \
+		} \
+	} while (0)
+
+
+// 按 (优先级, 编号) 入队，再全部出队执行，返回执行顺序中的编号
+std::vector<int> drain(TaskQueue &queue, const std::vector<std::pair<size_t, int>> &items) {
+	std::vector<int> order;
+
+	for (size_t i = 0; i < items.size(); ++i) {
+		int id = items[i].second;
+		Task task([&order, id]() { order.push_back(id); });
+		CHECK(queue.taskEnqueue(task, items[i].first, 1024));
+	}
+	CHECK(queue.size() == items.size());
+
+	Task task;
+	while (queue.taskDequeue(task)) {
+		task();
+	}
+	CHECK(queue.empty());
+
+	return order;
+}
+
+
+// 优先级数值越小越先执行，分桶队列同一优先级内按提交顺序执行
+void testBucket() {
+	BucketSafeQueue queue(4);
+	std::vector<int> order = drain(queue, { {3, 0}, {1, 1}, {2, 2}, {1, 3}, {0, 4}, {9, 5}, {1, 6} });
+	std::vector<int> expected = { 4, 1, 3, 6, 2, 0, 5 };
+	CHECK(order == expected);
+
+	// 超过 64 个桶时位图跨多个字
+	BucketSafeQueue wide(200);
+	order = drain(wide, { {150, 0}, {70, 1}, {199, 2}, {64, 3} });
+	expected = { 3, 1, 0, 2 };
+	CHECK(order == expected);
+}
+
+
+// 堆结构只保证优先级顺序
+void testHeap() {
+	HeapSafeQueue queue;
+	std::vector<int> order = drain(queue, { {3, 0}, {1, 1}, {2, 2}, {0, 3} });
+	std::vector<int> expected = { 3, 1, 2, 0 };
+	CHECK(order == expected);
+}
+
+
+// 间接 4 叉堆：相同优先级按槽位下标出队，槽位不足时自动扩容
+void testDaryHeap() {
+	DaryHeapSafeQueue queue(2);
+	std::vector<int> order = drain(queue, { {30, 0}, {10, 1}, {20, 2}, {0, 3}, {100000, 4}, {5, 5}, {10, 6}, {7, 7} });
+	std::vector<int> expected = { 3, 5, 7, 1, 6, 2, 0, 4 };
+	CHECK(order == expected);
+}
+
+
+// 环形队列忽略优先级，容量满时入队失败
+void testRing() {
+	RingSafeQueue queue(4);
+	std::vector<int> order = drain(queue, { {3, 0}, {1, 1}, {2, 2} });
+	std::vector<int> expected = { 0, 1, 2 };
+	CHECK(order == expected);
+
+	for (size_t i = 0; i < queue.capacity(); ++i) {
+		Task task([]() { });
+		CHECK(queue.taskEnqueue(task, 0, 1024));
+	}
+	Task task([]() { });
+	CHECK(!queue.taskEnqueue(task, 0, 1024));
+	CHECK(task);
+}
+
+
+// 队列上限
+void testLimit() {
+	BucketSafeQueue queue(2);
+	std::vector<Task> tasks;
+	for (int i = 0; i < 5; ++i) {
+		tasks.emplace_back([]() { });
+	}
+	CHECK(queue.taskEnqueueBatch(tasks.data(), tasks.size(), 0, 3) == 3);
+	CHECK(!tasks[2]);
+	CHECK(tasks[3]);
+	CHECK(!queue.taskEnqueue(tasks[3], 0, 3));
+}
+
+
+// 替换优先级最低的任务：被替换出的任务不再执行，新任务按自己的优先级出队
+void checkReplaceLowest(TaskQueue &queue) {
+	std::vector<int> order;
+	for (int id = 0; id < 4; ++id) {
+		Task task([&order, id]() { order.push_back(id); });
+		CHECK(queue.taskEnqueue(task, static_cast<size_t>(id) * 2, 4));
+	}
+
+	Task task([&order]() { order.push_back(9); });
+	Task victim;
+	CHECK(!queue.taskReplaceLowest(task, 6, victim));
+	CHECK(queue.taskReplaceLowest(task, 3, victim));
+	CHECK(!task);
+	CHECK(victim);
+	CHECK(queue.size() == 4);
+
+	victim();
+	while (queue.taskDequeue(task)) {
+		task();
+	}
+	std::vector<int> expected = { 3, 0, 1, 9, 2 };
+	CHECK(order == expected);
+}
+
+
+void testReplaceLowest() {
+	HeapSafeQueue heap;
+	checkReplaceLowest(heap);
+
+	DaryHeapSafeQueue dary_heap(4);
+	checkReplaceLowest(dary_heap);
+
+	BucketSafeQueue bucket(8);
+	checkReplaceLowest(bucket);
+
+	// 环形队列没有优先级，不支持替换
+	RingSafeQueue ring(4);
+	Task task([]() { });
+	Task victim;
+	CHECK(!ring.taskReplaceLowest(task, 0, victim));
+	CHECK(task);
+}
+
+
+// 伪造两个节点的 /sys/devices/system/node，检查拓扑解析与 CPU 分配
+void testTopology() {
+	std::vector<int> parsed = CpuTopology::parseCpuList("0-2,5,x,7-6");
+	std::vector<int> expected = { 0, 1, 2, 5 };
+	CHECK(parsed == expected);
+
+	std::string root = "/tmp/queue_test_nodes_" + std::to_string(getpid());
+	mkdir(root.c_str(), 0755);
+	mkdir((root + "/node0").c_str(), 0755);
+	mkdir((root + "/node1").c_str(), 0755);
+	std::ofstream(root + "/node0/cpulist") << "0-1,4-5\n";
+	std::ofstream(root + "/node1/cpulist") << "2-3,6-7\n";
+
+	CpuTopology topology(root);
+	CHECK(topology.nodes() == 2);
+	CHECK(topology.nodeOf(4) == 0);
+	CHECK(topology.nodeOf(6) == 1);
+	CHECK(topology.nodeOf(9) == -1);
+
+	std::vector<int> compact = { 0, 1, 4, 5, 2 };
+	CHECK(topology.placement(AffinityPolicy::COMPACT, 5, std::vector<int>()) == compact);
+	std::vector<int> scatter = { 0, 2, 1, 3, 4 };
+	CHECK(topology.placement(AffinityPolicy::SCATTER, 5, std::vector<int>()) == scatter);
+	std::vector<int> list = { 3, 1, 3 };
+	CHECK(topology.placement(AffinityPolicy::LIST, 3, std::vector<int>({ 3, 1 })) == list);
+	CHECK(topology.placement(AffinityPolicy::NONE, 2, std::vector<int>()) == std::vector<int>(2, -1));
+
+	std::remove((root + "/node0/cpulist").c_str());
+	std::remove((root + "/node1/cpulist").c_str());
+	rmdir((root + "/node0").c_str());
+	rmdir((root + "/node1").c_str());
+	rmdir(root.c_str());
+}
+
+
+// 按节点划分的队列：放入当前节点的子队列，先取本节点任务，本节点为空时跨节点获取，上限对任务总数生效
+void testNuma() {
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	queues.emplace_back(new HeapSafeQueue());
+	queues.emplace_back(new HeapSafeQueue());
+	NumaSafeQueue queue(std::move(queues));
+	std::vector<int> order;
+
+	CpuTopology::setCurrentNode(1);
+	for (int id = 0; id < 3; ++id) {
+		Task task([&order, id]() { order.push_back(id); });
+		CHECK(queue.taskEnqueue(task, static_cast<size_t>(id), 4));
+	}
+	CHECK(queue.size(0) == 0);
+	CHECK(queue.size(1) == 3);
+
+	CpuTopology::setCurrentNode(0);
+	Task local([&order]() { order.push_back(9); });
+	CHECK(queue.taskEnqueue(local, 1, 4));
+	Task rejected([]() { });
+	CHECK(!queue.taskEnqueue(rejected, 0, 4));
+	CHECK(rejected);
+	CHECK(queue.size() == 4);
+
+	Task task;
+	while (queue.taskDequeue(task)) {
+		task();
+	}
+	std::vector<int> expected = { 9, 0, 1, 2 };
+	CHECK(order == expected);
+	CHECK(queue.empty());
+
+	CpuTopology::setCurrentNode(-1);
+}
+
+
+int main() {
+	testBucket();
+	testHeap();
+	testDaryHeap();
+	testRing();
+	testLimit();
+	testReplaceLowest();
+	testTopology();
+	testNuma();
+
+	if (g_failed) {
+		std::cerr << g_failed << " 项检查失败" << std::endl;
+		return 1;
+	}
+
+	std::cerr << "全部检查通过" << std::endl;
+	return 0;
+}
@@ -0,0 +1,1421 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 14:02:33
+ * @last_edit_time: 2026-10-20 11:40:18
+ * @file_path: /Thread-Pool/test/task_test.cpp
+ * @description: Task 类型与任务提交的内存分配次数测试
+ */
+
+#include <iostream>
+#include <memory>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <stdexcept>
+#include <numeric>
+#include <limits>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include "ThreadPool.h"
+#include "TaskGraph.h"
+#include "json/json.h"
+
+
+// 当前线程的堆内存分配次数，只统计提交任务的线程
+static thread_local size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+	++g_allocations;
+	void* p = std::malloc(size ? size : 1);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+
+static int g_failed = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << " 检查失败: " #cond << std::endl; \
+			++g_failed; \
+		} \
+	} while (0)
+
+
+/**
+ * @description: 以默认配置为基础，覆盖其中的部分配置项，生成测试用的配置文件
+ * @param {string} name: 配置文件名
+ * @param {Json::Value} overrides: 覆盖的配置项
+ * @return {string} 配置文件路径，创建线程池后删除
+ */
+static std::string testConfig(const std::string &name, const Json::Value &overrides) {
+	Json::Value root;
+	Json::Reader reader;
+	std::ifstream input("../conf/threadpool.json");
+	reader.parse(input, root);
+
+	for (const std::string &key : overrides.getMemberNames()) {
+		root[key] = overrides[key];
+	}
+
+	std::string path = name + ".json";
+	std::ofstream output(path);
+	output << Json::StyledWriter().write(root);
+	return path;
+}
+
+
+/**
+ * @description: 只有一个工作线程、线程数量固定的线程池配置，任务执行顺序即出队顺序
+ * @param {string} name: 配置文件名
+ * @param {Json::Value} overrides: 其他覆盖的配置项
+ * @return {string} 配置文件路径
+ */
+static std::string singleThreadConfig(const std::string &name, Json::Value overrides) {
+	overrides["FIXED_THREAD"] = true;
+	overrides["max_threads"] = 1;
+	overrides["min_threads"] = 1;
+	return testConfig(name, overrides);
+}
+
+
+/**
+ * @description: 阻塞线程池的所有工作线程，直到 open 被调用
+ */
+class WorkerGate {
+private:
+	std::promise<void> m_gate;
+	std::shared_future<void> m_opened;
+	std::atomic<size_t> m_started;
+	std::vector<std::future<void>> m_blockers;
+
+public:
+	explicit WorkerGate(ThreadPool &pool) : m_opened(m_gate.get_future().share()), m_started(0) {
+		size_t threads = pool.getThreadsAmount();
+		for (size_t i = 0; i < threads; ++i) {
+			std::shared_future<void> opened = m_opened;
+			std::atomic<size_t> &started = m_started;
+			m_blockers.push_back(pool.submitTask([opened, &started]() { started++; opened.wait(); }));
+		}
+		while (m_started.load() < threads) {
+			std::this_thread::yield();
+		}
+	}
+
+	~WorkerGate() {
+		open();
+	}
+
+	void open() {
+		if (m_opened.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			m_gate.set_value();
+		}
+		for (auto &blocker : m_blockers) {
+			if (blocker.valid()) {
+				blocker.get();
+			}
+		}
+	}
+};
+
+
+/**
+ * @description: 轮询等待条件成立
+ * @param {Predicate} pred: 条件
+ * @param {std::chrono::milliseconds} timeout: 最长等待时间
+ * @return {bool} 超时前条件成立返回 true
+ */
+template <typename Predicate>
+static bool waitUntil(Predicate pred, std::chrono::milliseconds timeout) {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+	while (!pred()) {
+		if (std::chrono::steady_clock::now() >= deadline) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+
+/**
+ * @description: 线程数量在 1 到 2 之间伸缩、采样间隔很短的线程池配置；线程上限不超过硬件线程数量，单核机器上无法伸缩
+ * @param {string} name: 配置文件名
+ * @param {int} reserve_timeout: 后备池线程的停放时限 (毫秒)
+ * @return {string} 配置文件路径
+ */
+static std::string scalingConfig(const std::string &name, int reserve_timeout) {
+	Json::Value overrides;
+	overrides["FIXED_THREAD"] = false;
+	overrides["min_threads"] = 1;
+	overrides["max_threads"] = 2;
+	overrides["max_task"] = 1000;
+	overrides["scale_interval"] = 10;
+	overrides["grow_timeout"] = 20;
+	overrides["shrink_timeout"] = 50;
+	overrides["target_queue_wait"] = 1;
+	overrides["reserve_timeout"] = reserve_timeout;
+	return testConfig(name, overrides);
+}
+
+
+/**
+ * @description: 提交一批耗时任务形成持续积压，等待线程数量增加到 threads
+ * @param {ThreadPool&} pool: 线程池
+ * @param {size_t} threads: 期望的线程数量
+ * @return {bool} 超时前达到期望的线程数量返回 true
+ */
+static bool growUnderBacklog(ThreadPool &pool, size_t threads) {
+	std::atomic<bool> grown(false);
+	for (int i = 0; i < 400; ++i) {
+		pool.post([&grown]() {
+			if (!grown.load()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+		});
+	}
+	bool reached = waitUntil([&pool, threads]() { return pool.getThreadsAmount() == threads; }, std::chrono::seconds(5));
+	grown = true;
+	pool.waitIdle();
+	return reached;
+}
+
+
+/**
+ * @description: 任务是否被丢弃：被丢弃的任务其 future 得到 broken_promise 异常
+ * @param {std::future<T>&} future: 任务的 future
+ * @return {bool} 被丢弃返回 true
+ */
+template <typename T>
+static bool discarded(std::future<T> &future) {
+	try {
+		future.get();
+	}
+	catch (const std::future_error &error) {
+		return error.code() == std::future_errc::broken_promise;
+	}
+	return false;
+}
+
+
+struct Counter {
+	int m_value = 0;
+	int add(int delta) { return m_value += delta; }
+};
+
+
+int consume(std::unique_ptr<int> buffer, int extra) {
+	return *buffer + extra;
+}
+
+
+// Task 本身：小对象不分配内存，大对象从 TaskArena 分配 (不经过 operator new)，只可移动
+void testTask() {
+	int value = 0;
+
+	size_t before = g_allocations;
+	Task small([&value]() { value += 1; });
+	CHECK(g_allocations == before);
+	CHECK(small.storedInline());
+
+	Task moved(std::move(small));
+	CHECK(!small);
+	CHECK(moved);
+	moved();
+	CHECK(value == 1);
+
+	struct Big { char m_data[Task::INLINE_SIZE * 2]; int* m_value; void operator()() { *m_value += 10; } };
+	Big big;
+	big.m_value = &value;
+	// 第一次使用时创建当前线程的内存池
+	TaskArena::deallocate(TaskArena::allocate(1));
+	before = g_allocations;
+	size_t arena_before = TaskArena::statistics().m_allocations;
+	Task large(big);
+	CHECK(g_allocations == before);
+	CHECK(TaskArena::statistics().m_allocations == arena_before + 1);
+	CHECK(!large.storedInline());
+	large();
+	CHECK(value == 11);
+
+	std::unique_ptr<int> owned(new int(5));
+	Task move_only(BoundTask<int (*)(std::unique_ptr<int>, int), std::unique_ptr<int>, int>(consume, std::move(owned), 1));
+	CHECK(move_only.storedInline());
+	move_only();
+
+	moved = nullptr;
+	CHECK(!moved);
+}
+
+
+// 通过线程池提交：只可移动的参数、成员函数、引用参数
+void testSubmit(ThreadPool &pool) {
+	std::unique_ptr<int> buffer(new int(40));
+	auto f1 = pool.submitTask(consume, std::move(buffer), 2);
+	CHECK(f1.get() == 42);
+
+	Counter counter;
+	auto f2 = pool.submitTask(&Counter::add, &counter, 3);
+	CHECK(f2.get() == 3);
+	auto f3 = pool.submitTask(&Counter::add, std::ref(counter), 4);
+	CHECK(f3.get() == 7);
+
+	auto f4 = pool.submitTask(2, [](int a, int b) { return a * b; }, 6, 7);
+	CHECK(f4.get() == 42);
+}
+
+
+// 每次提交在提交线程上的内存分配次数：promise 的共享状态与结果都从 TaskArena 分配，不经过 operator new
+void testAllocations(ThreadPool &pool) {
+	const size_t rounds = 200;
+
+	// 预热，让任务队列的 vector 完成扩容
+	for (size_t i = 0; i < rounds; ++i) {
+		pool.submitTask([](int x) { return x; }, 1).get();
+	}
+
+	size_t total = 0;
+	ArenaStatistics arena_before = pool.getArenaStatistics();
+	for (size_t i = 0; i < rounds; ++i) {
+		size_t before = g_allocations;
+		auto future = pool.submitTask([](int x) { return x; }, static_cast<int>(i));
+		total += g_allocations - before;
+		CHECK(future.get() == static_cast<int>(i));
+	}
+
+	double per_submit = static_cast<double>(total) / rounds;
+	std::cerr << "每次提交的内存分配次数: " << per_submit << std::endl;
+
+	// 任务与 promise 都从内存池分配，平均每次提交不到一次全局分配；具体次数取决于标准库的实现
+	CHECK(per_submit < 1);
+
+	// 每个 promise 至少从内存池分配一次共享状态
+	ArenaStatistics arena_after = pool.getArenaStatistics();
+	CHECK(arena_after.m_allocations - arena_before.m_allocations >= rounds);
+	CHECK(arena_after.m_tasks - arena_before.m_tasks == rounds);
+	std::cerr << "内存池平均每个任务分配次数: " << arena_after.allocationsPerTask() << ", 字节数: " << arena_after.bytesPerTask() << std::endl;
+}
+
+
+// 批量提交：结果与下标一一对应；批量任务多于任务上限时分多次入队，不会丢失任务
+void testBatch(ThreadPool &pool) {
+	size_t amount = pool.getTaskMaxAmount() * 10;
+	auto squares = pool.submitBulk(amount, [](size_t i) { return i * i; });
+	CHECK(squares.size() == amount);
+	for (size_t i = 0; i < squares.size(); ++i) {
+		CHECK(squares[i].get() == i * i);
+	}
+
+	std::vector<std::function<int()>> funcs;
+	for (int i = 0; i < 30; ++i) {
+		funcs.push_back([i]() { return -i; });
+	}
+	auto negated = pool.submitBatch(2, funcs.begin(), funcs.end());
+	CHECK(negated.size() == funcs.size());
+	for (size_t i = 0; i < negated.size(); ++i) {
+		CHECK(negated[i].get() == -static_cast<int>(i));
+	}
+
+	CHECK(pool.submitBulk(0, [](size_t i) { return i; }).empty());
+}
+
+
+// 批量入队后按优先级出队 (数值越小越先执行)：追加多于已有任务时整体建堆，少于已有任务时逐个向上调整
+void testBatchOrder() {
+	Json::Value overrides;
+	overrides["max_task"] = 100;
+	std::string config = singleThreadConfig("task_test_batch", overrides);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+
+	std::vector<size_t> order;
+	auto record = [&order](size_t priority) { order.push_back(priority); };
+	{
+		WorkerGate gate(pool);
+		std::vector<std::future<void>> futures;
+		for (int i = 0; i < 3; ++i) {
+			futures.push_back(pool.submitTask(5, record, 5));
+		}
+		auto heapified = pool.submitBulk(1, 8, [&record](size_t) { record(1); });
+		auto sifted = pool.submitBulk(3, 2, [&record](size_t) { record(3); });
+		gate.open();
+
+		for (auto &future : futures) {
+			future.get();
+		}
+		for (auto &future : heapified) {
+			future.get();
+		}
+		for (auto &future : sifted) {
+			future.get();
+		}
+	}
+	std::vector<size_t> expected(8, 1);
+	expected.insert(expected.end(), 2, 3);
+	expected.insert(expected.end(), 3, 5);
+	CHECK(order == expected);
+
+	// 工作线程被阻塞时提交多于任务上限的批量任务：先入队一部分，等待工作线程取出后继续入队，全部由工作线程执行
+	pool.setTaskMaxAmount(4);
+	pool.setTaskTimeoutBySeconds(std::chrono::seconds(10));
+	std::thread::id caller = std::this_thread::get_id();
+	std::vector<std::future<bool>> overflow;
+	{
+		WorkerGate gate(pool);
+		std::thread opener([&gate]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			gate.open();
+		});
+		overflow = pool.submitBulk(20, [caller](size_t) { return std::this_thread::get_id() != caller; });
+		opener.join();
+	}
+	CHECK(overflow.size() == 20);
+	for (auto &future : overflow) {
+		CHECK(future.get());
+	}
+}
+
+
+// post 提交：不创建 future，提交线程上没有内存分配；异常交给回调
+void testPost(ThreadPool &pool) {
+	const int rounds = 200;
+	std::atomic<int> done(0);
+
+	// 预热，让任务队列的 vector 完成扩容
+	for (int i = 0; i < rounds; ++i) {
+		pool.post([&done]() { done++; });
+	}
+	while (done.load() < rounds) {
+		std::this_thread::yield();
+	}
+
+	size_t total = 0;
+	for (int i = 0; i < rounds; ++i) {
+		size_t before = g_allocations;
+		pool.post(1, [&done](int delta) { done += delta; }, 1);
+		total += g_allocations - before;
+		while (done.load() < rounds + i + 1) {
+			std::this_thread::yield();
+		}
+	}
+	std::cerr << "每次 post 的内存分配次数: " << static_cast<double>(total) / rounds << std::endl;
+	CHECK(total == 0);
+
+	std::atomic<int> caught(0);
+	pool.setExceptionHandler([&caught](std::exception_ptr exception) {
+		try {
+			std::rethrow_exception(exception);
+		}
+		catch (const std::runtime_error &) {
+			caught++;
+		}
+	});
+	pool.post([]() { throw std::runtime_error("post"); });
+	while (caught.load() == 0) {
+		std::this_thread::yield();
+	}
+	CHECK(caught.load() == 1);
+	pool.setExceptionHandler(nullptr);
+}
+
+
+// 缓冲提交：超时、显式 flush、提交线程退出时都会入队
+void testBuffered(ThreadPool &pool) {
+	auto delayed = pool.submitBuffered([]() { return 7; });
+	CHECK(delayed.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+	CHECK(delayed.get() == 7);
+
+	std::atomic<int> done(0);
+	for (int i = 0; i < 10; ++i) {
+		pool.postBuffered(i % 3, [&done]() { done++; });
+	}
+	pool.flush();
+
+	std::thread submitter([&pool, &done]() {
+		for (int i = 0; i < 10; ++i) {
+			pool.postBuffered([&done]() { done++; });
+		}
+	});
+	submitter.join();
+
+	for (int i = 0; i < 5000 && done.load() < 20; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK(done.load() == 20);
+}
+
+
+// 配置文件中的拒绝策略：按名称解析，未配置时为 CALLER_RUNS
+void testRejectPolicyConfig() {
+	Json::Value overrides;
+	overrides["reject_policy"] = "DISCARD_OLDEST";
+	std::string config = testConfig("task_test_policy", overrides);
+	{
+		ThreadPool pool(config);
+		CHECK(pool.getRejectPolicy() == RejectPolicy::DISCARD_OLDEST);
+	}
+
+	Json::Value root;
+	Json::Reader reader;
+	std::ifstream input(config);
+	reader.parse(input, root);
+	input.close();
+	root.removeMember("reject_policy");
+	std::ofstream(config) << Json::StyledWriter().write(root);
+	{
+		ThreadPool pool(config);
+		CHECK(pool.getRejectPolicy() == RejectPolicy::CALLER_RUNS);
+	}
+	std::remove(config.c_str());
+}
+
+
+// 缓冲提交遇到拒绝策略：入队时不持有缓冲区锁，CALLER_RUNS 执行的任务可以再次缓冲提交；定时入队线程不执行 THROW 策略，任务放回缓冲区，队列空出后再入队
+void testBufferedReject() {
+	Json::Value overrides;
+	overrides["max_task"] = 1;
+	overrides["timeout"] = 20;
+	overrides["reject_policy"] = "CALLER_RUNS";
+	overrides["submit_buffer_size"] = 1;
+	std::string config = singleThreadConfig("task_test_buffered", overrides);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+
+	std::atomic<int> done(0);
+	{
+		WorkerGate gate(pool);
+		pool.post([]() { });
+
+		// 任务队列已满，外层任务在当前线程执行，其中再次缓冲提交的任务同样在当前线程执行
+		std::thread::id caller = std::this_thread::get_id();
+		std::atomic<int> inline_runs(0);
+		pool.postBuffered([&pool, &done, &inline_runs, caller]() {
+			if (std::this_thread::get_id() == caller) {
+				inline_runs++;
+			}
+			pool.postBuffered([&done, &inline_runs, caller]() {
+				if (std::this_thread::get_id() == caller) {
+					inline_runs++;
+				}
+				done++;
+			});
+			done++;
+		});
+		CHECK(done.load() == 2 && inline_runs.load() == 2);
+	}
+
+
+	overrides["reject_policy"] = "THROW";
+	overrides["submit_buffer_size"] = 64;
+	overrides["submit_buffer_delay"] = 1000;
+	config = singleThreadConfig("task_test_buffered", overrides);
+	ThreadPool throwing(config);
+	std::remove(config.c_str());
+	{
+		WorkerGate gate(throwing);
+		throwing.post([]() { });
+
+		// 缓冲区未满，只能由定时入队线程入队；任务队列已满时不抛出异常，也不丢弃
+		auto delayed = throwing.submitBuffered([]() { return 5; });
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		CHECK(delayed.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+
+		gate.open();
+		CHECK(delayed.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+		CHECK(delayed.get() == 5);
+	}
+}
+
+
+// 不阻塞提交与限时提交：任务队列已满时返回空 future
+void testTrySubmit(ThreadPool &pool) {
+	size_t threads = pool.getThreadsAmount();
+	std::promise<void> gate;
+	std::shared_future<void> opened = gate.get_future().share();
+	std::atomic<size_t> started(0);
+
+	// 占满所有工作线程
+	std::vector<std::future<void>> blockers;
+	for (size_t i = 0; i < threads; ++i) {
+		blockers.push_back(pool.submitTask([opened, &started]() { started++; opened.wait(); }));
+	}
+	while (started.load() < threads) {
+		std::this_thread::yield();
+	}
+
+	// 填满任务队列
+	std::vector<std::future<int>> queued;
+	for (size_t i = 0; i <= pool.getTaskMaxAmount(); ++i) {
+		std::future<int> future = pool.trySubmit([]() { return 1; });
+		if (!future.valid()) {
+			break;
+		}
+		queued.push_back(std::move(future));
+	}
+	CHECK(queued.size() == pool.getTaskMaxAmount());
+	CHECK(!pool.trySubmit([]() { return 1; }).valid());
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	CHECK(!pool.submitFor(std::chrono::milliseconds(20), []() { return 1; }).valid());
+	CHECK(std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(20));
+	CHECK(!pool.submitUntil(std::chrono::system_clock::now(), []() { return 1; }).valid());
+
+	// 提交失败的任务不计入已入队的任务数量 (到达速率与内存池统计的分母)
+	size_t tasks_before = pool.getArenaStatistics().m_tasks;
+	CHECK(!pool.trySubmit([]() { return 1; }).valid());
+	CHECK(!pool.submitFor(std::chrono::milliseconds(1), []() { return 1; }).valid());
+	CHECK(pool.getArenaStatistics().m_tasks == tasks_before);
+
+	// 等待时长超出 steady_clock 的表示范围时一直等待，而不是溢出成过去的时间
+	std::thread opener([&gate]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		gate.set_value();
+	});
+	std::future<int> later = pool.submitFor(std::chrono::hours::max(), [](int x) { return x; }, 2);
+	opener.join();
+	CHECK(later.valid());
+	CHECK(later.get() == 2);
+	CHECK(pool.getArenaStatistics().m_tasks == tasks_before + 1);
+	CHECK(pool.submitUntil(std::chrono::system_clock::time_point::max(), []() { return 3; }).get() == 3);
+
+	for (auto &blocker : blockers) {
+		blocker.get();
+	}
+	for (auto &future : queued) {
+		CHECK(future.get() == 1);
+	}
+}
+
+
+// 静止等待：waitIdle 返回时已提交的任务 (包括缓冲区中的任务) 都已执行完毕，线程池可以继续使用
+void testWaitIdle(ThreadPool &pool) {
+	std::atomic<int> done(0);
+	for (int phase = 1; phase <= 3; ++phase) {
+		for (int i = 0; i < 100; ++i) {
+			pool.post([&done]() {
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+				done++;
+			});
+		}
+		pool.postBuffered([&done]() { done++; });
+		pool.waitIdle();
+		CHECK(done.load() == phase * 101);
+	}
+
+	// 没有任务时立即返回
+	pool.waitIdle();
+}
+
+
+// TaskFuture：后续任务链、异常传递、onComplete，以及工作线程中 get 时帮助执行任务
+void testTaskFuture(ThreadPool &pool) {
+	TaskFuture<int> chained = pool.submitAsync([]() { return 20; })
+		.then([](int x) { return x + 1; })
+		.then(ContinuationPolicy::INLINE, [](int x) { return x * 2; });
+	CHECK(chained.get() == 42);
+	CHECK(!chained.valid());
+
+	// 前置任务失败时跳过后续任务，异常传给最后的 future
+	std::atomic<int> skipped(0);
+	TaskFuture<void> failed = pool.submitAsync([]() -> int { throw std::runtime_error("stage"); })
+		.then([&skipped](int) { skipped++; });
+	bool thrown = false;
+	try {
+		failed.get();
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown && skipped.load() == 0);
+
+	std::promise<int> seen;
+	std::future<int> seen_future = seen.get_future();
+	pool.submitAsync([]() { return 7; }).onComplete([&seen](TaskFuture<int> ready) {
+		CHECK(ready.isReady());
+		seen.set_value(ready.get());
+	});
+	CHECK(seen_future.get() == 7);
+
+	// 不属于线程池的 promise：后续任务由写入结果的线程执行
+	TaskPromise<std::unique_ptr<int>> promise;
+	TaskFuture<int> moved = promise.getFuture().then([](std::unique_ptr<int> p) { return *p; });
+	CHECK(!moved.isReady());
+	promise.setValue(std::unique_ptr<int>(new int(5)));
+	CHECK(moved.isReady() && moved.get() == 5);
+
+	// 每个外层任务都在工作线程中等待内层任务；外层任务数量等于线程数量，内层任务只能由等待中的工作线程帮助执行
+	size_t threads = pool.getThreadsAmount();
+	std::vector<TaskFuture<size_t>> outers;
+	for (size_t i = 0; i < threads; ++i) {
+		outers.push_back(pool.submitAsync([&pool](size_t x) {
+			return pool.submitAsync([](size_t y) { return y * y; }, x).get();
+		}, i));
+	}
+	for (size_t i = 0; i < outers.size(); ++i) {
+		CHECK(outers[i].get() == i * i);
+	}
+
+	TaskFuture<int> broken;
+	{
+		TaskPromise<int> abandoned;
+		broken = abandoned.getFuture();
+	}
+	thrown = false;
+	try {
+		broken.get();
+	}
+	catch (const std::future_error &error) {
+		thrown = error.code() == std::future_errc::broken_promise;
+	}
+	CHECK(thrown);
+}
+
+
+// 任务依赖图：反复执行时每个节点都在所有前驱之后执行一次；异常传给结果，有环时拒绝执行
+void testTaskGraph(ThreadPool &pool) {
+	const size_t width = 16;
+	TaskGraph graph;
+	std::atomic<size_t> clock(0);
+	std::vector<size_t> finished(width + 2);
+
+	// 源点 -> width 个并行节点 (其中一条是长链) -> 汇点
+	size_t source = graph.addNode([&]() { finished[0] = ++clock; });
+	size_t sink = graph.addNode([&]() { finished[1] = ++clock; });
+	std::vector<size_t> middle;
+	for (size_t i = 0; i < width; ++i) {
+		middle.push_back(graph.addNode([&, i]() { finished[i + 2] = ++clock; }, i == 0 ? 10 : 1));
+		graph.addEdge(source, middle.back());
+		graph.addEdge(middle.back(), sink);
+	}
+	CHECK(graph.criticalPath() == 12);
+
+	for (int round = 0; round < 3; ++round) {
+		clock = 0;
+		graph.run(pool);
+		CHECK(clock.load() == width + 2);
+		for (size_t i = 0; i < width; ++i) {
+			CHECK(finished[0] < finished[i + 2] && finished[i + 2] < finished[1]);
+		}
+	}
+
+	TaskGraph failing;
+	std::atomic<int> after(0);
+	size_t thrower = failing.addNode([]() { throw std::runtime_error("node"); });
+	failing.addEdge(thrower, failing.addNode([&after]() { after++; }));
+	bool thrown = false;
+	try {
+		failing.run(pool);
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown && after.load() == 0);
+
+	TaskGraph cyclic;
+	size_t a = cyclic.addNode([]() { });
+	size_t b = cyclic.addNode([]() { });
+	cyclic.addEdge(a, b);
+	cyclic.addEdge(b, a);
+	thrown = false;
+	try {
+		cyclic.run(pool);
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+
+// 任务队列一直满时所有节点由调用线程执行：长链上每个节点都有一个代价更大的叶子后继被接着执行，链上的下一个节点无法提交，不会沿链递归
+// 未等待执行结束就析构图时，析构函数阻塞到最后一个节点完成
+void testTaskGraphInline() {
+	Json::Value overrides;
+	overrides["max_task"] = 1;
+	std::string config = singleThreadConfig("task_test_graph", overrides);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+
+	const size_t length = 100000;
+	std::atomic<size_t> executed(0);
+	{
+		WorkerGate gate(pool);
+		pool.post([]() { });
+
+		TaskGraph graph;
+		size_t previous = graph.addNode([&executed]() { executed++; });
+		for (size_t i = 1; i < length; ++i) {
+			// 叶子的关键路径比链的剩余部分更长
+			size_t side = graph.addNode([&executed]() { executed++; }, (length - i) * 2 + 2);
+			size_t next = graph.addNode([&executed]() { executed++; });
+			graph.addEdge(previous, side);
+			graph.addEdge(previous, next);
+			previous = next;
+		}
+		graph.run(pool);
+		CHECK(executed.load() == length * 2 - 1);
+	}
+
+	TaskFuture<void> future;
+	std::atomic<bool> finished(false);
+	{
+		TaskGraph graph;
+		graph.addNode([&finished]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			finished = true;
+		});
+		future = graph.runAsync(pool);
+	}
+	CHECK(finished.load());
+	future.get();
+}
+
+
+// 起始优先级不为 0 时，关键路径不同的节点仍映射到不同的桶，不会都被截断到最后一级：关键路径更长的后继先执行
+void testTaskGraphPriority() {
+	Json::Value overrides;
+	overrides["task_queue"] = "BUCKET";
+	overrides["priority_buckets"] = 8;
+	std::string config = singleThreadConfig("task_test_graph_priority", overrides);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+
+	std::vector<char> order;
+	TaskGraph graph;
+	size_t root = graph.addNode([]() { });
+	size_t longest = graph.addNode([&order]() { order.push_back('a'); }, 100);
+	size_t shortest = graph.addNode([&order]() { order.push_back('b'); }, 1);
+	size_t middle = graph.addNode([&order]() { order.push_back('c'); }, 50);
+	graph.addEdge(root, longest);
+	graph.addEdge(root, shortest);
+	graph.addEdge(root, middle);
+	graph.run(pool, 4);
+
+	std::vector<char> expected = { 'a', 'c', 'b' };
+	CHECK(order == expected);
+}
+
+
+// 并行循环：三种分块方式下每个下标恰好执行一次，异常传给调用者，工作线程中嵌套调用不会死锁
+void testParallelFor(ThreadPool &pool) {
+	const int size = 100000;
+	std::vector<std::atomic<int>> hits(size);
+	LoopSchedule schedules[] = { LoopSchedule::STATIC, LoopSchedule::DYNAMIC, LoopSchedule::GUIDED };
+
+	for (LoopSchedule schedule : schedules) {
+		for (auto &hit : hits) {
+			hit = 0;
+		}
+		pool.parallelFor(-size / 2, size / 2, [&hits](int i) { hits[i + size / 2]++; }, schedule);
+		pool.parallelFor(0, size, 1000, [&hits](int i) { hits[i]++; }, schedule);
+		bool exact = true;
+		for (auto &hit : hits) {
+			exact = exact && hit.load() == 2;
+		}
+		CHECK(exact);
+	}
+
+	size_t untouched = 0;
+	pool.parallelFor(size_t(5), size_t(5), [&untouched](size_t) { untouched++; });
+	CHECK(untouched == 0);
+
+	bool thrown = false;
+	try {
+		pool.parallelFor(0, size, 10, [](int i) {
+			if (i == size / 3) {
+				throw std::runtime_error("loop");
+			}
+		}, LoopSchedule::DYNAMIC);
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	std::atomic<size_t> nested(0);
+	pool.submitAsync([&pool, &nested]() {
+		pool.parallelFor(size_t(0), size_t(64), 1, [&pool, &nested](size_t) {
+			pool.parallelFor(size_t(0), size_t(64), 1, [&nested](size_t) { nested++; });
+		});
+	}).get();
+	CHECK(nested.load() == 64 * 64);
+}
+
+
+// 并行归约：与顺序累加结果一致，支持自定义单位元与合并函数
+void testParallelReduce(ThreadPool &pool) {
+	std::vector<long long> values(200000);
+	for (size_t i = 0; i < values.size(); ++i) {
+		values[i] = static_cast<long long>(i % 1000) - 300;
+	}
+	long long expected = std::accumulate(values.begin(), values.end(), 0LL);
+
+	CHECK(pool.parallelReduce(values.begin(), values.end(), 0LL, std::plus<long long>()) == expected);
+	CHECK(pool.parallelReduce(values.begin(), values.end(), 0LL, std::plus<long long>(), 64) == expected);
+	CHECK(pool.parallelReduce(values.begin(), values.begin(), 7LL, std::plus<long long>()) == 7);
+
+	long long squares = 0;
+	for (long long value : values) {
+		squares += value * value;
+	}
+	CHECK(pool.transformReduce(values.begin(), values.end(), 0LL, std::plus<long long>(), [](long long x) { return x * x; }) == squares);
+
+	// 单位元不是 0 的合并函数
+	long long lowest = pool.transformReduce(values.begin(), values.end(), std::numeric_limits<long long>::max(),
+		[](long long a, long long b) { return std::min(a, b); }, [](long long x) { return x; });
+	CHECK(lowest == -300);
+}
+
+
+// 并行排序：结果与 std::sort 一致，稳定排序保持相等元素的原有顺序
+void testParallelSort(ThreadPool &pool) {
+	std::vector<int> values(300000);
+	unsigned seed = 12345;
+	for (int &value : values) {
+		seed = seed * 1103515245 + 12345;
+		value = static_cast<int>((seed >> 8) % 5000);
+	}
+
+	std::vector<int> expected(values);
+	std::sort(expected.begin(), expected.end());
+	std::vector<int> sorted(values);
+	pool.parallelSort(sorted.begin(), sorted.end());
+	CHECK(sorted == expected);
+
+	pool.parallelSort(sorted.begin(), sorted.end(), std::greater<int>());
+	CHECK(std::is_sorted(sorted.begin(), sorted.end(), std::greater<int>()));
+
+	// 按值排序，下标记录原有顺序
+	std::vector<std::pair<int, size_t>> pairs(values.size());
+	for (size_t i = 0; i < values.size(); ++i) {
+		pairs[i] = std::make_pair(values[i], i);
+	}
+	pool.parallelStableSort(pairs.begin(), pairs.end(),
+		[](const std::pair<int, size_t> &a, const std::pair<int, size_t> &b) { return a.first < b.first; });
+	CHECK(std::is_sorted(pairs.begin(), pairs.end()));
+
+	std::vector<int> small = { 3, 1, 2 };
+	pool.parallelStableSort(small.begin(), small.end());
+	CHECK(small == std::vector<int>({ 1, 2, 3 }));
+
+	bool thrown = false;
+	try {
+		pool.parallelSort(values.begin(), values.end(), [](int a, int b) -> bool {
+			if (a == 4999 || b == 4999) throw std::runtime_error("compare");
+			return a < b;
+		});
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+
+// 并行前缀和：与顺序计算一致，支持原地计算与只满足结合律的合并函数
+void testParallelScan(ThreadPool &pool) {
+	std::vector<unsigned> lengths(250000);
+	for (size_t i = 0; i < lengths.size(); ++i) {
+		lengths[i] = static_cast<unsigned>(i * 7 % 97);
+	}
+
+	std::vector<size_t> expected(lengths.size());
+	size_t offset = 100;
+	for (size_t i = 0; i < lengths.size(); ++i) {
+		expected[i] = offset;
+		offset += lengths[i];
+	}
+	std::vector<size_t> offsets(lengths.size());
+	CHECK(pool.parallelExclusiveScan(lengths.begin(), lengths.end(), offsets.begin(), static_cast<size_t>(100)) == offsets.end());
+	CHECK(offsets == expected);
+
+	// 原地计算，块大小很小时同样正确
+	std::vector<unsigned> inclusive(lengths);
+	pool.parallelInclusiveScan(inclusive.begin(), inclusive.end(), inclusive.begin(), std::plus<unsigned>(), 1000);
+	CHECK(inclusive.back() == offset - 100);
+	CHECK(inclusive[0] == lengths[0] && inclusive[1000] == expected[1001] - 100);
+
+	// 字符串拼接满足结合律但不满足交换律，块的顺序必须保持
+	std::vector<std::string> letters(3000);
+	std::string all;
+	for (size_t i = 0; i < letters.size(); ++i) {
+		letters[i] = std::string(1, static_cast<char>('a' + i % 26));
+		all += letters[i];
+	}
+	std::vector<std::string> prefixes(letters.size());
+	pool.parallelExclusiveScan(letters.begin(), letters.end(), prefixes.begin(), std::string(), std::plus<std::string>(), 64);
+	CHECK(prefixes[0].empty() && prefixes.back() == all.substr(0, all.size() - 1));
+	pool.parallelInclusiveScan(letters.begin(), letters.end(), prefixes.begin(), std::plus<std::string>(), 64);
+	CHECK(prefixes[1234] == all.substr(0, 1235) && prefixes.back() == all);
+}
+
+
+// 并行分组聚合：每组的合并结果与顺序计算一致
+void testParallelGroupBy(ThreadPool &pool) {
+	std::vector<std::pair<int, long long>> rows(200000);
+	std::map<int, long long> expected;
+	for (size_t i = 0; i < rows.size(); ++i) {
+		rows[i] = std::make_pair(static_cast<int>(i * 31 % 1009), static_cast<long long>(i));
+		expected[rows[i].first] += rows[i].second;
+	}
+
+	auto groups = pool.parallelGroupBy(rows.begin(), rows.end(),
+		[](const std::pair<int, long long> &row) { return row.first; },
+		[](const std::pair<int, long long> &row) { return row.second; },
+		std::plus<long long>());
+	std::map<int, long long> result(groups.begin(), groups.end());
+	CHECK(groups.size() == expected.size());
+	CHECK(result == expected);
+
+	// 字符串键，统计每个键的行数
+	std::vector<std::string> words = { "red", "green", "blue", "green", "red", "red" };
+	auto counts = pool.parallelGroupBy(words.begin(), words.end(),
+		[](const std::string &word) { return word; },
+		[](const std::string &) { return 1; },
+		std::plus<int>(), 1);
+	std::map<std::string, int> count_map(counts.begin(), counts.end());
+	CHECK(count_map.size() == 3 && count_map["red"] == 3 && count_map["green"] == 2 && count_map["blue"] == 1);
+
+	CHECK(pool.parallelGroupBy(words.begin(), words.begin(), [](const std::string &word) { return word; },
+		[](const std::string &) { return 1; }, std::plus<int>()).empty());
+}
+
+
+// 拒绝策略：唯一的工作线程被阻塞、任务队列只能容纳一个任务时，再提交的任务超时后按各策略处理
+void testRejectPolicies() {
+	Json::Value overrides;
+	overrides["max_task"] = 1;
+	overrides["timeout"] = 20;
+	std::string config = singleThreadConfig("task_test_reject", overrides);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+	auto value = [](int x) { return x; };
+
+	// BLOCK：一直等到工作线程取出任务
+	pool.setRejectPolicy(RejectPolicy::BLOCK);
+	{
+		WorkerGate gate(pool);
+		auto queued = pool.submitTask(value, 1);
+		std::atomic<bool> opened(false);
+		std::thread opener([&gate, &opened]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			opened = true;
+			gate.open();
+		});
+		auto blocked = pool.submitTask(value, 2);
+		CHECK(opened.load());
+		opener.join();
+		CHECK(queued.get() == 1 && blocked.get() == 2);
+	}
+
+	// THROW：抛出异常，已入队的任务不受影响；批量提交时已入队的部分仍会执行
+	pool.setRejectPolicy(RejectPolicy::THROW);
+	{
+		WorkerGate gate(pool);
+		auto queued = pool.submitTask(value, 1);
+		bool thrown = false;
+		try {
+			pool.submitTask(value, 2);
+		}
+		catch (const std::runtime_error &) {
+			thrown = true;
+		}
+		CHECK(thrown);
+		gate.open();
+		CHECK(queued.get() == 1);
+	}
+	{
+		WorkerGate gate(pool);
+		std::atomic<int> executed(0);
+		bool thrown = false;
+		try {
+			pool.submitBulk(3, [&executed](size_t) { executed++; });
+		}
+		catch (const std::runtime_error &) {
+			thrown = true;
+		}
+		CHECK(thrown);
+		gate.open();
+		pool.waitIdle();
+		CHECK(executed.load() == 1);
+	}
+
+	// DISCARD_NEWEST：丢弃新任务
+	pool.setRejectPolicy(RejectPolicy::DISCARD_NEWEST);
+	{
+		WorkerGate gate(pool);
+		auto queued = pool.submitTask(value, 1);
+		auto dropped = pool.submitTask(value, 2);
+		gate.open();
+		CHECK(queued.get() == 1);
+		CHECK(discarded(dropped));
+	}
+
+	// DISCARD_OLDEST：优先级队列中按 DISCARD_LOWEST 处理，不会丢弃优先级最高的队首任务
+	pool.setRejectPolicy(RejectPolicy::DISCARD_OLDEST);
+	{
+		WorkerGate gate(pool);
+		auto urgent = pool.submitTask(0, value, 1);
+		auto lower = pool.submitTask(5, value, 2);
+		gate.open();
+		CHECK(urgent.get() == 1);
+		CHECK(discarded(lower));
+	}
+
+	// DISCARD_LOWEST：新任务替换优先级更低的任务
+	pool.setRejectPolicy(RejectPolicy::DISCARD_LOWEST);
+	{
+		WorkerGate gate(pool);
+		auto lower = pool.submitTask(5, value, 1);
+		auto urgent = pool.submitTask(0, value, 2);
+		gate.open();
+		CHECK(discarded(lower));
+		CHECK(urgent.get() == 2);
+	}
+
+	// CALLER_RUNS：由提交者执行
+	pool.setRejectPolicy(RejectPolicy::CALLER_RUNS);
+	{
+		WorkerGate gate(pool);
+		auto queued = pool.submitTask(value, 1);
+		auto ran = pool.submitTask([]() { return std::this_thread::get_id(); });
+		CHECK(ran.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+		CHECK(ran.get() == std::this_thread::get_id());
+		gate.open();
+		CHECK(queued.get() == 1);
+	}
+
+	// 被拒绝、丢弃的任务都计入完成数量，waitIdle 不会一直等待
+	pool.waitIdle();
+}
+
+
+// FIFO 任务队列中 DISCARD_OLDEST 丢弃最早提交的任务
+void testDiscardOldest() {
+	Json::Value overrides;
+	overrides["max_task"] = 2;
+	overrides["timeout"] = 20;
+	overrides["task_queue"] = "FIFO";
+	overrides["reject_policy"] = "DISCARD_OLDEST";
+	std::string config = singleThreadConfig("task_test_oldest", overrides);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+
+	std::vector<int> order;
+	auto record = [&order](int x) { order.push_back(x); return x; };
+	{
+		WorkerGate gate(pool);
+		auto oldest = pool.submitTask(record, 1);
+		auto middle = pool.submitTask(record, 2);
+		auto newest = pool.submitTask(record, 3);
+		gate.open();
+		CHECK(discarded(oldest));
+		CHECK(middle.get() == 2 && newest.get() == 3);
+	}
+	CHECK(order == std::vector<int>({ 2, 3 }));
+	pool.waitIdle();
+}
+
+
+// 空闲统计：PARK 策略每次空闲都休眠；SPIN 策略下任务接连到达时在自旋或让出 CPU 阶段取到，避免唤醒
+void testIdleStatistics() {
+	const int rounds = 200;
+	const char* strategies[] = { "PARK", "SPIN" };
+
+	for (const char* strategy : strategies) {
+		Json::Value overrides;
+		overrides["idle_strategy"] = strategy;
+		std::string config = singleThreadConfig("task_test_idle", overrides);
+		ThreadPool pool(config);
+		std::remove(config.c_str());
+
+		// 第一个任务完成后工作线程才会空闲
+		std::atomic<int> done(0);
+		for (int i = 0; i < rounds; ++i) {
+			pool.post([&done]() { done++; });
+			while (done.load() < i + 1) {
+				std::this_thread::yield();
+			}
+		}
+
+		// 长时间没有任务，SPIN 策略下也会休眠
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		pool.post([&done]() { done++; });
+		pool.waitIdle();
+
+		IdleStatistics statistics = pool.getIdleStatistics();
+		std::cerr << strategy << " 自旋命中: " << statistics.m_spin_hits << ", 让出命中: " << statistics.m_yield_hits
+			<< ", 休眠: " << statistics.m_parks << std::endl;
+		CHECK(done.load() == rounds + 1);
+		CHECK(statistics.m_parks > 0);
+		if (std::string(strategy) == "PARK") {
+			CHECK(statistics.avoidedWakeups() == 0);
+		}
+		else {
+			CHECK(statistics.avoidedWakeups() > 0);
+			CHECK(statistics.avoidedWakeups() + statistics.m_parks <= static_cast<size_t>(rounds) + 2);
+		}
+	}
+}
+
+
+// 扩缩容：持续积压时增加线程，之后持续空闲时减少线程，始终在线程上下限之间
+void testScaling() {
+	if (std::thread::hardware_concurrency() < 2) {
+		std::cerr << "硬件线程数量少于 2，跳过扩缩容测试" << std::endl;
+		return;
+	}
+
+	std::string config = scalingConfig("task_test_scaling", 30000);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+	CHECK(pool.getThreadsAmount() == 1);
+
+	// 积压期间线程数量不超过上限，采样结果反映积压
+	std::atomic<bool> stop(false);
+	std::atomic<size_t> lowest(1), highest(1), most_pending(0);
+	std::atomic<double> busiest(0);
+	std::thread sampler([&]() {
+		while (!stop.load()) {
+			size_t threads = pool.getThreadsAmount();
+			ScalingStatistics statistics = pool.getScalingStatistics();
+			lowest = std::min(lowest.load(), threads);
+			highest = std::max(highest.load(), threads);
+			most_pending = std::max(most_pending.load(), statistics.m_pending);
+			busiest = std::max(busiest.load(), statistics.m_busy_ratio);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+
+	CHECK(growUnderBacklog(pool, 2));
+	ScalingStatistics grown = pool.getScalingStatistics();
+	CHECK(grown.m_arrival_rate > 0);
+
+	// 空闲超过 shrink_timeout 后减少到下限
+	CHECK(waitUntil([&pool]() { return pool.getThreadsAmount() == 1; }, std::chrono::seconds(5)));
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	stop = true;
+	sampler.join();
+
+	ScalingStatistics shrunk = pool.getScalingStatistics();
+	CHECK(lowest.load() == 1 && highest.load() == 2);
+	CHECK(most_pending.load() > 0 && busiest.load() > 0.5);
+	CHECK(shrunk.m_threads == 1 && shrunk.m_pending == 0 && shrunk.m_busy_ratio < 0.5);
+	CHECK(shrunk.m_reserved == 1);
+}
+
+
+// 后备池：缩容时线程停放而不退出，再次扩容时唤醒停放的线程而不是创建新线程，停放超过 reserve_timeout 后被回收
+void testReserve() {
+	if (std::thread::hardware_concurrency() < 2) {
+		std::cerr << "硬件线程数量少于 2，跳过后备池测试" << std::endl;
+		return;
+	}
+
+	std::string config = scalingConfig("task_test_reserve", 300);
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+	auto reserved = [&pool]() { return pool.getScalingStatistics().m_reserved; };
+
+	CHECK(growUnderBacklog(pool, 2));
+	CHECK(waitUntil([&]() { return pool.getThreadsAmount() == 1 && reserved() == 1; }, std::chrono::seconds(5)));
+	ScalingStatistics parked = pool.getScalingStatistics();
+	CHECK(parked.m_spawned == 2 && parked.m_revived == 0 && parked.m_reaped == 0);
+
+	CHECK(growUnderBacklog(pool, 2));
+	ScalingStatistics revived = pool.getScalingStatistics();
+	CHECK(revived.m_spawned == 2 && revived.m_revived == 1 && revived.m_reaped == 0);
+
+	CHECK(waitUntil([&]() { return pool.getThreadsAmount() == 1 && reserved() == 1; }, std::chrono::seconds(5)));
+	CHECK(waitUntil([&]() { return pool.getScalingStatistics().m_reaped == 1; }, std::chrono::seconds(5)));
+	ScalingStatistics reaped = pool.getScalingStatistics();
+	CHECK(reaped.m_reserved == 0 && reaped.m_spawned == 2 && reaped.m_revived == 1);
+	CHECK(pool.getThreadsAmount() == 1);
+
+	// 槽位回收后可以再次创建线程
+	CHECK(growUnderBacklog(pool, 2));
+	CHECK(pool.getScalingStatistics().m_spawned == 3);
+}
+
+
+// 唯一的工作线程在任务中等待 TaskFuture 时阻塞，之后提交的任务唤醒它帮助执行，结果才能就绪
+void testHelpWake() {
+	std::string config = singleThreadConfig("task_test_help", Json::Value(Json::objectValue));
+	ThreadPool pool(config);
+	std::remove(config.c_str());
+
+	TaskPromise<int> promise(&pool, pool.getTaskPriority());
+	TaskFuture<int> result = promise.getFuture();
+	std::atomic<bool> waiting(false);
+	TaskFuture<int> outer = pool.submitAsync([&result, &waiting]() {
+		waiting = true;
+		return result.get() + 1;
+	});
+
+	while (!waiting.load()) {
+		std::this_thread::yield();
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	pool.post([&promise]() { promise.setValue(6); });
+
+	CHECK(outer.get() == 7);
+}
+
+
+// 立即关闭：正在执行的任务执行完毕，任务队列中的任务原样返回
+void testShutdownNow() {
+	ThreadPool pool;
+	size_t threads = pool.getThreadsAmount();
+	std::promise<void> gate;
+	std::shared_future<void> opened = gate.get_future().share();
+	std::atomic<size_t> started(0);
+
+	std::vector<std::future<void>> blockers;
+	for (size_t i = 0; i < threads; ++i) {
+		blockers.push_back(pool.submitTask([opened, &started]() { started++; opened.wait(); }));
+	}
+	while (started.load() < threads) {
+		std::this_thread::yield();
+	}
+
+	std::vector<std::future<int>> queued;
+	for (size_t i = 0; i < pool.getTaskMaxAmount(); ++i) {
+		queued.push_back(pool.trySubmit([](size_t x) { return static_cast<int>(x); }, i));
+	}
+
+	std::vector<Task> remaining;
+	std::thread stopper([&pool, &remaining]() { remaining = pool.shutdownNow(); });
+
+	// 线程池不再接受任务后才放行，保证剩余任务不会被工作线程取走
+	bool closed = false;
+	while (!closed) {
+		try {
+			pool.trySubmit([]() { return 0; });
+			std::this_thread::yield();
+		}
+		catch (const std::runtime_error &) {
+			closed = true;
+		}
+	}
+	gate.set_value();
+	stopper.join();
+
+	for (auto &blocker : blockers) {
+		blocker.get();
+	}
+	CHECK(remaining.size() == queued.size());
+	for (auto &task : remaining) {
+		task();
+	}
+	for (size_t i = 0; i < queued.size(); ++i) {
+		CHECK(queued[i].get() == static_cast<int>(i));
+	}
+
+	pool.waitIdle();
+	CHECK(pool.shutdownNow().empty());
+}
+
+
+// 关闭与提交并发：提交成功的任务要么被执行，要么由 shutdownNow 返回，不会丢失，waitIdle 不会一直等待
+void testConcurrentShutdown() {
+	for (int round = 0; round < 20; ++round) {
+		ThreadPool pool;
+		std::atomic<size_t> accepted(0), executed(0);
+		std::atomic<bool> ready(false);
+
+		std::vector<std::thread> submitters;
+		for (int i = 0; i < 4; ++i) {
+			submitters.emplace_back([&pool, &accepted, &executed, &ready, i]() {
+				while (true) {
+					try {
+						if (i % 2 == 0) {
+							pool.post([&executed]() { executed++; });
+						}
+						else if (!pool.trySubmit([&executed]() { executed++; }).valid()) {
+							continue;
+						}
+					}
+					catch (const std::runtime_error &) {
+						return;
+					}
+					accepted++;
+					ready = true;
+				}
+			});
+		}
+
+		while (!ready.load()) {
+			std::this_thread::yield();
+		}
+		std::vector<Task> remaining = round % 2 == 0 ? pool.shutdownNow() : std::vector<Task>();
+		if (round % 2 != 0) {
+			pool.close();
+		}
+		for (std::thread &submitter : submitters) {
+			submitter.join();
+		}
+
+		for (Task &task : remaining) {
+			task();
+		}
+		CHECK(executed.load() == accepted.load());
+		pool.waitIdle();
+	}
+}
+
+
+int main() {
+	testTask();
+
+	{
+		ThreadPool pool;
+		testSubmit(pool);
+		testAllocations(pool);
+		testBatch(pool);
+		testPost(pool);
+		testBuffered(pool);
+		testTrySubmit(pool);
+		testWaitIdle(pool);
+		testTaskFuture(pool);
+		testTaskGraph(pool);
+		testParallelFor(pool);
+		testParallelReduce(pool);
+		testParallelSort(pool);
+		testParallelScan(pool);
+		testParallelGroupBy(pool);
+	}
+
+	testBatchOrder();
+	testBufferedReject();
+	testTaskGraphInline();
+	testTaskGraphPriority();
+	testRejectPolicies();
+	testRejectPolicyConfig();
+	testDiscardOldest();
+	testIdleStatistics();
+	testScaling();
+	testReserve();
+	testHelpWake();
+	testShutdownNow();
+	testConcurrentShutdown();
+
+	if (g_failed) {
+		std::cerr << g_failed << " 项检查失败" << std::endl;
+		return 1;
+	}
+
+	std::cerr << "全部检查通过" << std::endl;
+	return 0;
+}